@@ -7,6 +7,16 @@
  */
 #include "aes.h"
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define AES_HAVE_AESNI 1
+#include <cpuid.h>
+#include <wmmintrin.h>
+#endif
+#ifdef __GNUC__
+#define AES_HAVE_BITSLICE 1
+#endif
 
 static const uint8_t sbox[256] = {
   0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
@@ -46,12 +56,324 @@ static const uint8_t isbox[256] = {
 
 static const uint8_t Rcon[11] = {0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
 
-static const uint8_t M[16] = {2, 3, 1, 1, 1, 2, 3, 1, 1, 1, 2, 3, 3, 1, 1, 2};
+/*
+열 하나(32비트 워드, r행이 8*r번째 비트부터)에 대한 MixColumns와 InvMixColumns이다.
+MixColumn은 네 바이트의 XTIME을 한 번에 계산해서 b_r = 2*(a_r ^ a_(r+1)) ^ a_(r+1) ^ a_(r+2) ^ a_(r+3) 를 계산한다.
+InvMixColumns 행렬 {0e, 0b, 0d, 09}는 MixColumns 행렬과 {05, 00, 04, 00} 순환 행렬의 곱이므로
+InvMixColumn은 u_r = a_r ^ 4*(a_r ^ a_(r+2)) 를 만든 다음 MixColumn을 적용한다.
+둘 다 곱셈 테이블을 조회하지 않으므로 라운드 키 값에 따라 메모리 접근이 달라지지 않는다.
+*/
+#define ROTR32(w, n) (((w) >> (n)) | ((w) << (32 - (n))))
+
+static inline uint32_t Xtime32(uint32_t w)
+{
+	return ((w & 0x7f7f7f7fu) << 1) ^ (((w >> 7) & 0x01010101u) * 0x1b);
+}
+
+static inline uint32_t MixColumn(uint32_t w)
+{
+	uint32_t r1 = ROTR32(w, 8);
+
+	return Xtime32(w ^ r1) ^ r1 ^ ROTR32(w, 16) ^ ROTR32(w, 24);
+}
 
-static const uint8_t IM[16] = {0x0e, 0x0b, 0x0d, 0x09, 0x09, 0x0e, 0x0b, 0x0d, 0x0d, 0x09, 0x0e, 0x0b, 0x0b, 0x0d, 0x09, 0x0e};
+static inline uint32_t InvMixColumn(uint32_t w)
+{
+	return MixColumn(w ^ Xtime32(Xtime32(w ^ ROTR32(w, 16))));
+}
 
-// 복호화 전용 roundKey
-static uint32_t droundKey[RNDKEYLEN];
+// KeyExpansion()/Cipher() 인터페이스가 사용하는 문맥 (복호화 전용 roundKey를 여기에 둔다)
+static aes_ctx legacy_ctx;
+static const uint32_t *legacy_rk;   // legacy_ctx의 라운드 키를 받아 간 KeyExpansion()의 roundKey
+
+/*
+T-table 엔진에서 사용하는 32비트 조회 테이블이다.
+Te0..Te3은 SubBytes, ShiftRows, MixColumns를, Td0..Td3은 InvSubBytes, InvShiftRows,
+InvMixColumns를 열(32비트 워드) 단위로 합쳐 놓은 것이다. roundKey와 같은 리틀 엔디안
+워드 배치를 사용하므로 Ter[x]의 k번째 바이트는 r행의 바이트 x가 같은 열의 k행에 더해지는 값이다.
+즉 Te0[x] = (2*S[x], S[x], S[x], 3*S[x]), Td0[x] = (14*IS[x], 9*IS[x], 13*IS[x], 11*IS[x]) 이고
+나머지는 이를 8비트씩 회전한 값이다.
+*/
+static const uint32_t Te0[256] = {
+  0xa56363c6, 0x847c7cf8, 0x997777ee, 0x8d7b7bf6, 0x0df2f2ff, 0xbd6b6bd6, 0xb16f6fde, 0x54c5c591,
+  0x50303060, 0x03010102, 0xa96767ce, 0x7d2b2b56, 0x19fefee7, 0x62d7d7b5, 0xe6abab4d, 0x9a7676ec,
+  0x45caca8f, 0x9d82821f, 0x40c9c989, 0x877d7dfa, 0x15fafaef, 0xeb5959b2, 0xc947478e, 0x0bf0f0fb,
+  0xecadad41, 0x67d4d4b3, 0xfda2a25f, 0xeaafaf45, 0xbf9c9c23, 0xf7a4a453, 0x967272e4, 0x5bc0c09b,
+  0xc2b7b775, 0x1cfdfde1, 0xae93933d, 0x6a26264c, 0x5a36366c, 0x413f3f7e, 0x02f7f7f5, 0x4fcccc83,
+  0x5c343468, 0xf4a5a551, 0x34e5e5d1, 0x08f1f1f9, 0x937171e2, 0x73d8d8ab, 0x53313162, 0x3f15152a,
+  0x0c040408, 0x52c7c795, 0x65232346, 0x5ec3c39d, 0x28181830, 0xa1969637, 0x0f05050a, 0xb59a9a2f,
+  0x0907070e, 0x36121224, 0x9b80801b, 0x3de2e2df, 0x26ebebcd, 0x6927274e, 0xcdb2b27f, 0x9f7575ea,
+  0x1b090912, 0x9e83831d, 0x742c2c58, 0x2e1a1a34, 0x2d1b1b36, 0xb26e6edc, 0xee5a5ab4, 0xfba0a05b,
+  0xf65252a4, 0x4d3b3b76, 0x61d6d6b7, 0xceb3b37d, 0x7b292952, 0x3ee3e3dd, 0x712f2f5e, 0x97848413,
+  0xf55353a6, 0x68d1d1b9, 0x00000000, 0x2cededc1, 0x60202040, 0x1ffcfce3, 0xc8b1b179, 0xed5b5bb6,
+  0xbe6a6ad4, 0x46cbcb8d, 0xd9bebe67, 0x4b393972, 0xde4a4a94, 0xd44c4c98, 0xe85858b0, 0x4acfcf85,
+  0x6bd0d0bb, 0x2aefefc5, 0xe5aaaa4f, 0x16fbfbed, 0xc5434386, 0xd74d4d9a, 0x55333366, 0x94858511,
+  0xcf45458a, 0x10f9f9e9, 0x06020204, 0x817f7ffe, 0xf05050a0, 0x443c3c78, 0xba9f9f25, 0xe3a8a84b,
+  0xf35151a2, 0xfea3a35d, 0xc0404080, 0x8a8f8f05, 0xad92923f, 0xbc9d9d21, 0x48383870, 0x04f5f5f1,
+  0xdfbcbc63, 0xc1b6b677, 0x75dadaaf, 0x63212142, 0x30101020, 0x1affffe5, 0x0ef3f3fd, 0x6dd2d2bf,
+  0x4ccdcd81, 0x140c0c18, 0x35131326, 0x2fececc3, 0xe15f5fbe, 0xa2979735, 0xcc444488, 0x3917172e,
+  0x57c4c493, 0xf2a7a755, 0x827e7efc, 0x473d3d7a, 0xac6464c8, 0xe75d5dba, 0x2b191932, 0x957373e6,
+  0xa06060c0, 0x98818119, 0xd14f4f9e, 0x7fdcdca3, 0x66222244, 0x7e2a2a54, 0xab90903b, 0x8388880b,
+  0xca46468c, 0x29eeeec7, 0xd3b8b86b, 0x3c141428, 0x79dedea7, 0xe25e5ebc, 0x1d0b0b16, 0x76dbdbad,
+  0x3be0e0db, 0x56323264, 0x4e3a3a74, 0x1e0a0a14, 0xdb494992, 0x0a06060c, 0x6c242448, 0xe45c5cb8,
+  0x5dc2c29f, 0x6ed3d3bd, 0xefacac43, 0xa66262c4, 0xa8919139, 0xa4959531, 0x37e4e4d3, 0x8b7979f2,
+  0x32e7e7d5, 0x43c8c88b, 0x5937376e, 0xb76d6dda, 0x8c8d8d01, 0x64d5d5b1, 0xd24e4e9c, 0xe0a9a949,
+  0xb46c6cd8, 0xfa5656ac, 0x07f4f4f3, 0x25eaeacf, 0xaf6565ca, 0x8e7a7af4, 0xe9aeae47, 0x18080810,
+  0xd5baba6f, 0x887878f0, 0x6f25254a, 0x722e2e5c, 0x241c1c38, 0xf1a6a657, 0xc7b4b473, 0x51c6c697,
+  0x23e8e8cb, 0x7cdddda1, 0x9c7474e8, 0x211f1f3e, 0xdd4b4b96, 0xdcbdbd61, 0x868b8b0d, 0x858a8a0f,
+  0x907070e0, 0x423e3e7c, 0xc4b5b571, 0xaa6666cc, 0xd8484890, 0x05030306, 0x01f6f6f7, 0x120e0e1c,
+  0xa36161c2, 0x5f35356a, 0xf95757ae, 0xd0b9b969, 0x91868617, 0x58c1c199, 0x271d1d3a, 0xb99e9e27,
+  0x38e1e1d9, 0x13f8f8eb, 0xb398982b, 0x33111122, 0xbb6969d2, 0x70d9d9a9, 0x898e8e07, 0xa7949433,
+  0xb69b9b2d, 0x221e1e3c, 0x92878715, 0x20e9e9c9, 0x49cece87, 0xff5555aa, 0x78282850, 0x7adfdfa5,
+  0x8f8c8c03, 0xf8a1a159, 0x80898909, 0x170d0d1a, 0xdabfbf65, 0x31e6e6d7, 0xc6424284, 0xb86868d0,
+  0xc3414182, 0xb0999929, 0x772d2d5a, 0x110f0f1e, 0xcbb0b07b, 0xfc5454a8, 0xd6bbbb6d, 0x3a16162c };
+
+static const uint32_t Te1[256] = {
+  0x6363c6a5, 0x7c7cf884, 0x7777ee99, 0x7b7bf68d, 0xf2f2ff0d, 0x6b6bd6bd, 0x6f6fdeb1, 0xc5c59154,
+  0x30306050, 0x01010203, 0x6767cea9, 0x2b2b567d, 0xfefee719, 0xd7d7b562, 0xabab4de6, 0x7676ec9a,
+  0xcaca8f45, 0x82821f9d, 0xc9c98940, 0x7d7dfa87, 0xfafaef15, 0x5959b2eb, 0x47478ec9, 0xf0f0fb0b,
+  0xadad41ec, 0xd4d4b367, 0xa2a25ffd, 0xafaf45ea, 0x9c9c23bf, 0xa4a453f7, 0x7272e496, 0xc0c09b5b,
+  0xb7b775c2, 0xfdfde11c, 0x93933dae, 0x26264c6a, 0x36366c5a, 0x3f3f7e41, 0xf7f7f502, 0xcccc834f,
+  0x3434685c, 0xa5a551f4, 0xe5e5d134, 0xf1f1f908, 0x7171e293, 0xd8d8ab73, 0x31316253, 0x15152a3f,
+  0x0404080c, 0xc7c79552, 0x23234665, 0xc3c39d5e, 0x18183028, 0x969637a1, 0x05050a0f, 0x9a9a2fb5,
+  0x07070e09, 0x12122436, 0x80801b9b, 0xe2e2df3d, 0xebebcd26, 0x27274e69, 0xb2b27fcd, 0x7575ea9f,
+  0x0909121b, 0x83831d9e, 0x2c2c5874, 0x1a1a342e, 0x1b1b362d, 0x6e6edcb2, 0x5a5ab4ee, 0xa0a05bfb,
+  0x5252a4f6, 0x3b3b764d, 0xd6d6b761, 0xb3b37dce, 0x2929527b, 0xe3e3dd3e, 0x2f2f5e71, 0x84841397,
+  0x5353a6f5, 0xd1d1b968, 0x00000000, 0xededc12c, 0x20204060, 0xfcfce31f, 0xb1b179c8, 0x5b5bb6ed,
+  0x6a6ad4be, 0xcbcb8d46, 0xbebe67d9, 0x3939724b, 0x4a4a94de, 0x4c4c98d4, 0x5858b0e8, 0xcfcf854a,
+  0xd0d0bb6b, 0xefefc52a, 0xaaaa4fe5, 0xfbfbed16, 0x434386c5, 0x4d4d9ad7, 0x33336655, 0x85851194,
+  0x45458acf, 0xf9f9e910, 0x02020406, 0x7f7ffe81, 0x5050a0f0, 0x3c3c7844, 0x9f9f25ba, 0xa8a84be3,
+  0x5151a2f3, 0xa3a35dfe, 0x404080c0, 0x8f8f058a, 0x92923fad, 0x9d9d21bc, 0x38387048, 0xf5f5f104,
+  0xbcbc63df, 0xb6b677c1, 0xdadaaf75, 0x21214263, 0x10102030, 0xffffe51a, 0xf3f3fd0e, 0xd2d2bf6d,
+  0xcdcd814c, 0x0c0c1814, 0x13132635, 0xececc32f, 0x5f5fbee1, 0x979735a2, 0x444488cc, 0x17172e39,
+  0xc4c49357, 0xa7a755f2, 0x7e7efc82, 0x3d3d7a47, 0x6464c8ac, 0x5d5dbae7, 0x1919322b, 0x7373e695,
+  0x6060c0a0, 0x81811998, 0x4f4f9ed1, 0xdcdca37f, 0x22224466, 0x2a2a547e, 0x90903bab, 0x88880b83,
+  0x46468cca, 0xeeeec729, 0xb8b86bd3, 0x1414283c, 0xdedea779, 0x5e5ebce2, 0x0b0b161d, 0xdbdbad76,
+  0xe0e0db3b, 0x32326456, 0x3a3a744e, 0x0a0a141e, 0x494992db, 0x06060c0a, 0x2424486c, 0x5c5cb8e4,
+  0xc2c29f5d, 0xd3d3bd6e, 0xacac43ef, 0x6262c4a6, 0x919139a8, 0x959531a4, 0xe4e4d337, 0x7979f28b,
+  0xe7e7d532, 0xc8c88b43, 0x37376e59, 0x6d6ddab7, 0x8d8d018c, 0xd5d5b164, 0x4e4e9cd2, 0xa9a949e0,
+  0x6c6cd8b4, 0x5656acfa, 0xf4f4f307, 0xeaeacf25, 0x6565caaf, 0x7a7af48e, 0xaeae47e9, 0x08081018,
+  0xbaba6fd5, 0x7878f088, 0x25254a6f, 0x2e2e5c72, 0x1c1c3824, 0xa6a657f1, 0xb4b473c7, 0xc6c69751,
+  0xe8e8cb23, 0xdddda17c, 0x7474e89c, 0x1f1f3e21, 0x4b4b96dd, 0xbdbd61dc, 0x8b8b0d86, 0x8a8a0f85,
+  0x7070e090, 0x3e3e7c42, 0xb5b571c4, 0x6666ccaa, 0x484890d8, 0x03030605, 0xf6f6f701, 0x0e0e1c12,
+  0x6161c2a3, 0x35356a5f, 0x5757aef9, 0xb9b969d0, 0x86861791, 0xc1c19958, 0x1d1d3a27, 0x9e9e27b9,
+  0xe1e1d938, 0xf8f8eb13, 0x98982bb3, 0x11112233, 0x6969d2bb, 0xd9d9a970, 0x8e8e0789, 0x949433a7,
+  0x9b9b2db6, 0x1e1e3c22, 0x87871592, 0xe9e9c920, 0xcece8749, 0x5555aaff, 0x28285078, 0xdfdfa57a,
+  0x8c8c038f, 0xa1a159f8, 0x89890980, 0x0d0d1a17, 0xbfbf65da, 0xe6e6d731, 0x424284c6, 0x6868d0b8,
+  0x414182c3, 0x999929b0, 0x2d2d5a77, 0x0f0f1e11, 0xb0b07bcb, 0x5454a8fc, 0xbbbb6dd6, 0x16162c3a };
+
+static const uint32_t Te2[256] = {
+  0x63c6a563, 0x7cf8847c, 0x77ee9977, 0x7bf68d7b, 0xf2ff0df2, 0x6bd6bd6b, 0x6fdeb16f, 0xc59154c5,
+  0x30605030, 0x01020301, 0x67cea967, 0x2b567d2b, 0xfee719fe, 0xd7b562d7, 0xab4de6ab, 0x76ec9a76,
+  0xca8f45ca, 0x821f9d82, 0xc98940c9, 0x7dfa877d, 0xfaef15fa, 0x59b2eb59, 0x478ec947, 0xf0fb0bf0,
+  0xad41ecad, 0xd4b367d4, 0xa25ffda2, 0xaf45eaaf, 0x9c23bf9c, 0xa453f7a4, 0x72e49672, 0xc09b5bc0,
+  0xb775c2b7, 0xfde11cfd, 0x933dae93, 0x264c6a26, 0x366c5a36, 0x3f7e413f, 0xf7f502f7, 0xcc834fcc,
+  0x34685c34, 0xa551f4a5, 0xe5d134e5, 0xf1f908f1, 0x71e29371, 0xd8ab73d8, 0x31625331, 0x152a3f15,
+  0x04080c04, 0xc79552c7, 0x23466523, 0xc39d5ec3, 0x18302818, 0x9637a196, 0x050a0f05, 0x9a2fb59a,
+  0x070e0907, 0x12243612, 0x801b9b80, 0xe2df3de2, 0xebcd26eb, 0x274e6927, 0xb27fcdb2, 0x75ea9f75,
+  0x09121b09, 0x831d9e83, 0x2c58742c, 0x1a342e1a, 0x1b362d1b, 0x6edcb26e, 0x5ab4ee5a, 0xa05bfba0,
+  0x52a4f652, 0x3b764d3b, 0xd6b761d6, 0xb37dceb3, 0x29527b29, 0xe3dd3ee3, 0x2f5e712f, 0x84139784,
+  0x53a6f553, 0xd1b968d1, 0x00000000, 0xedc12ced, 0x20406020, 0xfce31ffc, 0xb179c8b1, 0x5bb6ed5b,
+  0x6ad4be6a, 0xcb8d46cb, 0xbe67d9be, 0x39724b39, 0x4a94de4a, 0x4c98d44c, 0x58b0e858, 0xcf854acf,
+  0xd0bb6bd0, 0xefc52aef, 0xaa4fe5aa, 0xfbed16fb, 0x4386c543, 0x4d9ad74d, 0x33665533, 0x85119485,
+  0x458acf45, 0xf9e910f9, 0x02040602, 0x7ffe817f, 0x50a0f050, 0x3c78443c, 0x9f25ba9f, 0xa84be3a8,
+  0x51a2f351, 0xa35dfea3, 0x4080c040, 0x8f058a8f, 0x923fad92, 0x9d21bc9d, 0x38704838, 0xf5f104f5,
+  0xbc63dfbc, 0xb677c1b6, 0xdaaf75da, 0x21426321, 0x10203010, 0xffe51aff, 0xf3fd0ef3, 0xd2bf6dd2,
+  0xcd814ccd, 0x0c18140c, 0x13263513, 0xecc32fec, 0x5fbee15f, 0x9735a297, 0x4488cc44, 0x172e3917,
+  0xc49357c4, 0xa755f2a7, 0x7efc827e, 0x3d7a473d, 0x64c8ac64, 0x5dbae75d, 0x19322b19, 0x73e69573,
+  0x60c0a060, 0x81199881, 0x4f9ed14f, 0xdca37fdc, 0x22446622, 0x2a547e2a, 0x903bab90, 0x880b8388,
+  0x468cca46, 0xeec729ee, 0xb86bd3b8, 0x14283c14, 0xdea779de, 0x5ebce25e, 0x0b161d0b, 0xdbad76db,
+  0xe0db3be0, 0x32645632, 0x3a744e3a, 0x0a141e0a, 0x4992db49, 0x060c0a06, 0x24486c24, 0x5cb8e45c,
+  0xc29f5dc2, 0xd3bd6ed3, 0xac43efac, 0x62c4a662, 0x9139a891, 0x9531a495, 0xe4d337e4, 0x79f28b79,
+  0xe7d532e7, 0xc88b43c8, 0x376e5937, 0x6ddab76d, 0x8d018c8d, 0xd5b164d5, 0x4e9cd24e, 0xa949e0a9,
+  0x6cd8b46c, 0x56acfa56, 0xf4f307f4, 0xeacf25ea, 0x65caaf65, 0x7af48e7a, 0xae47e9ae, 0x08101808,
+  0xba6fd5ba, 0x78f08878, 0x254a6f25, 0x2e5c722e, 0x1c38241c, 0xa657f1a6, 0xb473c7b4, 0xc69751c6,
+  0xe8cb23e8, 0xdda17cdd, 0x74e89c74, 0x1f3e211f, 0x4b96dd4b, 0xbd61dcbd, 0x8b0d868b, 0x8a0f858a,
+  0x70e09070, 0x3e7c423e, 0xb571c4b5, 0x66ccaa66, 0x4890d848, 0x03060503, 0xf6f701f6, 0x0e1c120e,
+  0x61c2a361, 0x356a5f35, 0x57aef957, 0xb969d0b9, 0x86179186, 0xc19958c1, 0x1d3a271d, 0x9e27b99e,
+  0xe1d938e1, 0xf8eb13f8, 0x982bb398, 0x11223311, 0x69d2bb69, 0xd9a970d9, 0x8e07898e, 0x9433a794,
+  0x9b2db69b, 0x1e3c221e, 0x87159287, 0xe9c920e9, 0xce8749ce, 0x55aaff55, 0x28507828, 0xdfa57adf,
+  0x8c038f8c, 0xa159f8a1, 0x89098089, 0x0d1a170d, 0xbf65dabf, 0xe6d731e6, 0x4284c642, 0x68d0b868,
+  0x4182c341, 0x9929b099, 0x2d5a772d, 0x0f1e110f, 0xb07bcbb0, 0x54a8fc54, 0xbb6dd6bb, 0x162c3a16 };
+
+static const uint32_t Te3[256] = {
+  0xc6a56363, 0xf8847c7c, 0xee997777, 0xf68d7b7b, 0xff0df2f2, 0xd6bd6b6b, 0xdeb16f6f, 0x9154c5c5,
+  0x60503030, 0x02030101, 0xcea96767, 0x567d2b2b, 0xe719fefe, 0xb562d7d7, 0x4de6abab, 0xec9a7676,
+  0x8f45caca, 0x1f9d8282, 0x8940c9c9, 0xfa877d7d, 0xef15fafa, 0xb2eb5959, 0x8ec94747, 0xfb0bf0f0,
+  0x41ecadad, 0xb367d4d4, 0x5ffda2a2, 0x45eaafaf, 0x23bf9c9c, 0x53f7a4a4, 0xe4967272, 0x9b5bc0c0,
+  0x75c2b7b7, 0xe11cfdfd, 0x3dae9393, 0x4c6a2626, 0x6c5a3636, 0x7e413f3f, 0xf502f7f7, 0x834fcccc,
+  0x685c3434, 0x51f4a5a5, 0xd134e5e5, 0xf908f1f1, 0xe2937171, 0xab73d8d8, 0x62533131, 0x2a3f1515,
+  0x080c0404, 0x9552c7c7, 0x46652323, 0x9d5ec3c3, 0x30281818, 0x37a19696, 0x0a0f0505, 0x2fb59a9a,
+  0x0e090707, 0x24361212, 0x1b9b8080, 0xdf3de2e2, 0xcd26ebeb, 0x4e692727, 0x7fcdb2b2, 0xea9f7575,
+  0x121b0909, 0x1d9e8383, 0x58742c2c, 0x342e1a1a, 0x362d1b1b, 0xdcb26e6e, 0xb4ee5a5a, 0x5bfba0a0,
+  0xa4f65252, 0x764d3b3b, 0xb761d6d6, 0x7dceb3b3, 0x527b2929, 0xdd3ee3e3, 0x5e712f2f, 0x13978484,
+  0xa6f55353, 0xb968d1d1, 0x00000000, 0xc12ceded, 0x40602020, 0xe31ffcfc, 0x79c8b1b1, 0xb6ed5b5b,
+  0xd4be6a6a, 0x8d46cbcb, 0x67d9bebe, 0x724b3939, 0x94de4a4a, 0x98d44c4c, 0xb0e85858, 0x854acfcf,
+  0xbb6bd0d0, 0xc52aefef, 0x4fe5aaaa, 0xed16fbfb, 0x86c54343, 0x9ad74d4d, 0x66553333, 0x11948585,
+  0x8acf4545, 0xe910f9f9, 0x04060202, 0xfe817f7f, 0xa0f05050, 0x78443c3c, 0x25ba9f9f, 0x4be3a8a8,
+  0xa2f35151, 0x5dfea3a3, 0x80c04040, 0x058a8f8f, 0x3fad9292, 0x21bc9d9d, 0x70483838, 0xf104f5f5,
+  0x63dfbcbc, 0x77c1b6b6, 0xaf75dada, 0x42632121, 0x20301010, 0xe51affff, 0xfd0ef3f3, 0xbf6dd2d2,
+  0x814ccdcd, 0x18140c0c, 0x26351313, 0xc32fecec, 0xbee15f5f, 0x35a29797, 0x88cc4444, 0x2e391717,
+  0x9357c4c4, 0x55f2a7a7, 0xfc827e7e, 0x7a473d3d, 0xc8ac6464, 0xbae75d5d, 0x322b1919, 0xe6957373,
+  0xc0a06060, 0x19988181, 0x9ed14f4f, 0xa37fdcdc, 0x44662222, 0x547e2a2a, 0x3bab9090, 0x0b838888,
+  0x8cca4646, 0xc729eeee, 0x6bd3b8b8, 0x283c1414, 0xa779dede, 0xbce25e5e, 0x161d0b0b, 0xad76dbdb,
+  0xdb3be0e0, 0x64563232, 0x744e3a3a, 0x141e0a0a, 0x92db4949, 0x0c0a0606, 0x486c2424, 0xb8e45c5c,
+  0x9f5dc2c2, 0xbd6ed3d3, 0x43efacac, 0xc4a66262, 0x39a89191, 0x31a49595, 0xd337e4e4, 0xf28b7979,
+  0xd532e7e7, 0x8b43c8c8, 0x6e593737, 0xdab76d6d, 0x018c8d8d, 0xb164d5d5, 0x9cd24e4e, 0x49e0a9a9,
+  0xd8b46c6c, 0xacfa5656, 0xf307f4f4, 0xcf25eaea, 0xcaaf6565, 0xf48e7a7a, 0x47e9aeae, 0x10180808,
+  0x6fd5baba, 0xf0887878, 0x4a6f2525, 0x5c722e2e, 0x38241c1c, 0x57f1a6a6, 0x73c7b4b4, 0x9751c6c6,
+  0xcb23e8e8, 0xa17cdddd, 0xe89c7474, 0x3e211f1f, 0x96dd4b4b, 0x61dcbdbd, 0x0d868b8b, 0x0f858a8a,
+  0xe0907070, 0x7c423e3e, 0x71c4b5b5, 0xccaa6666, 0x90d84848, 0x06050303, 0xf701f6f6, 0x1c120e0e,
+  0xc2a36161, 0x6a5f3535, 0xaef95757, 0x69d0b9b9, 0x17918686, 0x9958c1c1, 0x3a271d1d, 0x27b99e9e,
+  0xd938e1e1, 0xeb13f8f8, 0x2bb39898, 0x22331111, 0xd2bb6969, 0xa970d9d9, 0x07898e8e, 0x33a79494,
+  0x2db69b9b, 0x3c221e1e, 0x15928787, 0xc920e9e9, 0x8749cece, 0xaaff5555, 0x50782828, 0xa57adfdf,
+  0x038f8c8c, 0x59f8a1a1, 0x09808989, 0x1a170d0d, 0x65dabfbf, 0xd731e6e6, 0x84c64242, 0xd0b86868,
+  0x82c34141, 0x29b09999, 0x5a772d2d, 0x1e110f0f, 0x7bcbb0b0, 0xa8fc5454, 0x6dd6bbbb, 0x2c3a1616 };
+
+static const uint32_t Td0[256] = {
+  0x50a7f451, 0x5365417e, 0xc3a4171a, 0x965e273a, 0xcb6bab3b, 0xf1459d1f, 0xab58faac, 0x9303e34b,
+  0x55fa3020, 0xf66d76ad, 0x9176cc88, 0x254c02f5, 0xfcd7e54f, 0xd7cb2ac5, 0x80443526, 0x8fa362b5,
+  0x495ab1de, 0x671bba25, 0x980eea45, 0xe1c0fe5d, 0x02752fc3, 0x12f04c81, 0xa397468d, 0xc6f9d36b,
+  0xe75f8f03, 0x959c9215, 0xeb7a6dbf, 0xda595295, 0x2d83bed4, 0xd3217458, 0x2969e049, 0x44c8c98e,
+  0x6a89c275, 0x78798ef4, 0x6b3e5899, 0xdd71b927, 0xb64fe1be, 0x17ad88f0, 0x66ac20c9, 0xb43ace7d,
+  0x184adf63, 0x82311ae5, 0x60335197, 0x457f5362, 0xe07764b1, 0x84ae6bbb, 0x1ca081fe, 0x942b08f9,
+  0x58684870, 0x19fd458f, 0x876cde94, 0xb7f87b52, 0x23d373ab, 0xe2024b72, 0x578f1fe3, 0x2aab5566,
+  0x0728ebb2, 0x03c2b52f, 0x9a7bc586, 0xa50837d3, 0xf2872830, 0xb2a5bf23, 0xba6a0302, 0x5c8216ed,
+  0x2b1ccf8a, 0x92b479a7, 0xf0f207f3, 0xa1e2694e, 0xcdf4da65, 0xd5be0506, 0x1f6234d1, 0x8afea6c4,
+  0x9d532e34, 0xa055f3a2, 0x32e18a05, 0x75ebf6a4, 0x39ec830b, 0xaaef6040, 0x069f715e, 0x51106ebd,
+  0xf98a213e, 0x3d06dd96, 0xae053edd, 0x46bde64d, 0xb58d5491, 0x055dc471, 0x6fd40604, 0xff155060,
+  0x24fb9819, 0x97e9bdd6, 0xcc434089, 0x779ed967, 0xbd42e8b0, 0x888b8907, 0x385b19e7, 0xdbeec879,
+  0x470a7ca1, 0xe90f427c, 0xc91e84f8, 0x00000000, 0x83868009, 0x48ed2b32, 0xac70111e, 0x4e725a6c,
+  0xfbff0efd, 0x5638850f, 0x1ed5ae3d, 0x27392d36, 0x64d90f0a, 0x21a65c68, 0xd1545b9b, 0x3a2e3624,
+  0xb1670a0c, 0x0fe75793, 0xd296eeb4, 0x9e919b1b, 0x4fc5c080, 0xa220dc61, 0x694b775a, 0x161a121c,
+  0x0aba93e2, 0xe52aa0c0, 0x43e0223c, 0x1d171b12, 0x0b0d090e, 0xadc78bf2, 0xb9a8b62d, 0xc8a91e14,
+  0x8519f157, 0x4c0775af, 0xbbdd99ee, 0xfd607fa3, 0x9f2601f7, 0xbcf5725c, 0xc53b6644, 0x347efb5b,
+  0x7629438b, 0xdcc623cb, 0x68fcedb6, 0x63f1e4b8, 0xcadc31d7, 0x10856342, 0x40229713, 0x2011c684,
+  0x7d244a85, 0xf83dbbd2, 0x1132f9ae, 0x6da129c7, 0x4b2f9e1d, 0xf330b2dc, 0xec52860d, 0xd0e3c177,
+  0x6c16b32b, 0x99b970a9, 0xfa489411, 0x2264e947, 0xc48cfca8, 0x1a3ff0a0, 0xd82c7d56, 0xef903322,
+  0xc74e4987, 0xc1d138d9, 0xfea2ca8c, 0x360bd498, 0xcf81f5a6, 0x28de7aa5, 0x268eb7da, 0xa4bfad3f,
+  0xe49d3a2c, 0x0d927850, 0x9bcc5f6a, 0x62467e54, 0xc2138df6, 0xe8b8d890, 0x5ef7392e, 0xf5afc382,
+  0xbe805d9f, 0x7c93d069, 0xa92dd56f, 0xb31225cf, 0x3b99acc8, 0xa77d1810, 0x6e639ce8, 0x7bbb3bdb,
+  0x097826cd, 0xf418596e, 0x01b79aec, 0xa89a4f83, 0x656e95e6, 0x7ee6ffaa, 0x08cfbc21, 0xe6e815ef,
+  0xd99be7ba, 0xce366f4a, 0xd4099fea, 0xd67cb029, 0xafb2a431, 0x31233f2a, 0x3094a5c6, 0xc066a235,
+  0x37bc4e74, 0xa6ca82fc, 0xb0d090e0, 0x15d8a733, 0x4a9804f1, 0xf7daec41, 0x0e50cd7f, 0x2ff69117,
+  0x8dd64d76, 0x4db0ef43, 0x544daacc, 0xdf0496e4, 0xe3b5d19e, 0x1b886a4c, 0xb81f2cc1, 0x7f516546,
+  0x04ea5e9d, 0x5d358c01, 0x737487fa, 0x2e410bfb, 0x5a1d67b3, 0x52d2db92, 0x335610e9, 0x1347d66d,
+  0x8c61d79a, 0x7a0ca137, 0x8e14f859, 0x893c13eb, 0xee27a9ce, 0x35c961b7, 0xede51ce1, 0x3cb1477a,
+  0x59dfd29c, 0x3f73f255, 0x79ce1418, 0xbf37c773, 0xeacdf753, 0x5baafd5f, 0x146f3ddf, 0x86db4478,
+  0x81f3afca, 0x3ec468b9, 0x2c342438, 0x5f40a3c2, 0x72c31d16, 0x0c25e2bc, 0x8b493c28, 0x41950dff,
+  0x7101a839, 0xdeb30c08, 0x9ce4b4d8, 0x90c15664, 0x6184cb7b, 0x70b632d5, 0x745c6c48, 0x4257b8d0 };
+
+static const uint32_t Td1[256] = {
+  0xa7f45150, 0x65417e53, 0xa4171ac3, 0x5e273a96, 0x6bab3bcb, 0x459d1ff1, 0x58faacab, 0x03e34b93,
+  0xfa302055, 0x6d76adf6, 0x76cc8891, 0x4c02f525, 0xd7e54ffc, 0xcb2ac5d7, 0x44352680, 0xa362b58f,
+  0x5ab1de49, 0x1bba2567, 0x0eea4598, 0xc0fe5de1, 0x752fc302, 0xf04c8112, 0x97468da3, 0xf9d36bc6,
+  0x5f8f03e7, 0x9c921595, 0x7a6dbfeb, 0x595295da, 0x83bed42d, 0x217458d3, 0x69e04929, 0xc8c98e44,
+  0x89c2756a, 0x798ef478, 0x3e58996b, 0x71b927dd, 0x4fe1beb6, 0xad88f017, 0xac20c966, 0x3ace7db4,
+  0x4adf6318, 0x311ae582, 0x33519760, 0x7f536245, 0x7764b1e0, 0xae6bbb84, 0xa081fe1c, 0x2b08f994,
+  0x68487058, 0xfd458f19, 0x6cde9487, 0xf87b52b7, 0xd373ab23, 0x024b72e2, 0x8f1fe357, 0xab55662a,
+  0x28ebb207, 0xc2b52f03, 0x7bc5869a, 0x0837d3a5, 0x872830f2, 0xa5bf23b2, 0x6a0302ba, 0x8216ed5c,
+  0x1ccf8a2b, 0xb479a792, 0xf207f3f0, 0xe2694ea1, 0xf4da65cd, 0xbe0506d5, 0x6234d11f, 0xfea6c48a,
+  0x532e349d, 0x55f3a2a0, 0xe18a0532, 0xebf6a475, 0xec830b39, 0xef6040aa, 0x9f715e06, 0x106ebd51,
+  0x8a213ef9, 0x06dd963d, 0x053eddae, 0xbde64d46, 0x8d5491b5, 0x5dc47105, 0xd406046f, 0x155060ff,
+  0xfb981924, 0xe9bdd697, 0x434089cc, 0x9ed96777, 0x42e8b0bd, 0x8b890788, 0x5b19e738, 0xeec879db,
+  0x0a7ca147, 0x0f427ce9, 0x1e84f8c9, 0x00000000, 0x86800983, 0xed2b3248, 0x70111eac, 0x725a6c4e,
+  0xff0efdfb, 0x38850f56, 0xd5ae3d1e, 0x392d3627, 0xd90f0a64, 0xa65c6821, 0x545b9bd1, 0x2e36243a,
+  0x670a0cb1, 0xe757930f, 0x96eeb4d2, 0x919b1b9e, 0xc5c0804f, 0x20dc61a2, 0x4b775a69, 0x1a121c16,
+  0xba93e20a, 0x2aa0c0e5, 0xe0223c43, 0x171b121d, 0x0d090e0b, 0xc78bf2ad, 0xa8b62db9, 0xa91e14c8,
+  0x19f15785, 0x0775af4c, 0xdd99eebb, 0x607fa3fd, 0x2601f79f, 0xf5725cbc, 0x3b6644c5, 0x7efb5b34,
+  0x29438b76, 0xc623cbdc, 0xfcedb668, 0xf1e4b863, 0xdc31d7ca, 0x85634210, 0x22971340, 0x11c68420,
+  0x244a857d, 0x3dbbd2f8, 0x32f9ae11, 0xa129c76d, 0x2f9e1d4b, 0x30b2dcf3, 0x52860dec, 0xe3c177d0,
+  0x16b32b6c, 0xb970a999, 0x489411fa, 0x64e94722, 0x8cfca8c4, 0x3ff0a01a, 0x2c7d56d8, 0x903322ef,
+  0x4e4987c7, 0xd138d9c1, 0xa2ca8cfe, 0x0bd49836, 0x81f5a6cf, 0xde7aa528, 0x8eb7da26, 0xbfad3fa4,
+  0x9d3a2ce4, 0x9278500d, 0xcc5f6a9b, 0x467e5462, 0x138df6c2, 0xb8d890e8, 0xf7392e5e, 0xafc382f5,
+  0x805d9fbe, 0x93d0697c, 0x2dd56fa9, 0x1225cfb3, 0x99acc83b, 0x7d1810a7, 0x639ce86e, 0xbb3bdb7b,
+  0x7826cd09, 0x18596ef4, 0xb79aec01, 0x9a4f83a8, 0x6e95e665, 0xe6ffaa7e, 0xcfbc2108, 0xe815efe6,
+  0x9be7bad9, 0x366f4ace, 0x099fead4, 0x7cb029d6, 0xb2a431af, 0x233f2a31, 0x94a5c630, 0x66a235c0,
+  0xbc4e7437, 0xca82fca6, 0xd090e0b0, 0xd8a73315, 0x9804f14a, 0xdaec41f7, 0x50cd7f0e, 0xf691172f,
+  0xd64d768d, 0xb0ef434d, 0x4daacc54, 0x0496e4df, 0xb5d19ee3, 0x886a4c1b, 0x1f2cc1b8, 0x5165467f,
+  0xea5e9d04, 0x358c015d, 0x7487fa73, 0x410bfb2e, 0x1d67b35a, 0xd2db9252, 0x5610e933, 0x47d66d13,
+  0x61d79a8c, 0x0ca1377a, 0x14f8598e, 0x3c13eb89, 0x27a9ceee, 0xc961b735, 0xe51ce1ed, 0xb1477a3c,
+  0xdfd29c59, 0x73f2553f, 0xce141879, 0x37c773bf, 0xcdf753ea, 0xaafd5f5b, 0x6f3ddf14, 0xdb447886,
+  0xf3afca81, 0xc468b93e, 0x3424382c, 0x40a3c25f, 0xc31d1672, 0x25e2bc0c, 0x493c288b, 0x950dff41,
+  0x01a83971, 0xb30c08de, 0xe4b4d89c, 0xc1566490, 0x84cb7b61, 0xb632d570, 0x5c6c4874, 0x57b8d042 };
+
+static const uint32_t Td2[256] = {
+  0xf45150a7, 0x417e5365, 0x171ac3a4, 0x273a965e, 0xab3bcb6b, 0x9d1ff145, 0xfaacab58, 0xe34b9303,
+  0x302055fa, 0x76adf66d, 0xcc889176, 0x02f5254c, 0xe54ffcd7, 0x2ac5d7cb, 0x35268044, 0x62b58fa3,
+  0xb1de495a, 0xba25671b, 0xea45980e, 0xfe5de1c0, 0x2fc30275, 0x4c8112f0, 0x468da397, 0xd36bc6f9,
+  0x8f03e75f, 0x9215959c, 0x6dbfeb7a, 0x5295da59, 0xbed42d83, 0x7458d321, 0xe0492969, 0xc98e44c8,
+  0xc2756a89, 0x8ef47879, 0x58996b3e, 0xb927dd71, 0xe1beb64f, 0x88f017ad, 0x20c966ac, 0xce7db43a,
+  0xdf63184a, 0x1ae58231, 0x51976033, 0x5362457f, 0x64b1e077, 0x6bbb84ae, 0x81fe1ca0, 0x08f9942b,
+  0x48705868, 0x458f19fd, 0xde94876c, 0x7b52b7f8, 0x73ab23d3, 0x4b72e202, 0x1fe3578f, 0x55662aab,
+  0xebb20728, 0xb52f03c2, 0xc5869a7b, 0x37d3a508, 0x2830f287, 0xbf23b2a5, 0x0302ba6a, 0x16ed5c82,
+  0xcf8a2b1c, 0x79a792b4, 0x07f3f0f2, 0x694ea1e2, 0xda65cdf4, 0x0506d5be, 0x34d11f62, 0xa6c48afe,
+  0x2e349d53, 0xf3a2a055, 0x8a0532e1, 0xf6a475eb, 0x830b39ec, 0x6040aaef, 0x715e069f, 0x6ebd5110,
+  0x213ef98a, 0xdd963d06, 0x3eddae05, 0xe64d46bd, 0x5491b58d, 0xc471055d, 0x06046fd4, 0x5060ff15,
+  0x981924fb, 0xbdd697e9, 0x4089cc43, 0xd967779e, 0xe8b0bd42, 0x8907888b, 0x19e7385b, 0xc879dbee,
+  0x7ca1470a, 0x427ce90f, 0x84f8c91e, 0x00000000, 0x80098386, 0x2b3248ed, 0x111eac70, 0x5a6c4e72,
+  0x0efdfbff, 0x850f5638, 0xae3d1ed5, 0x2d362739, 0x0f0a64d9, 0x5c6821a6, 0x5b9bd154, 0x36243a2e,
+  0x0a0cb167, 0x57930fe7, 0xeeb4d296, 0x9b1b9e91, 0xc0804fc5, 0xdc61a220, 0x775a694b, 0x121c161a,
+  0x93e20aba, 0xa0c0e52a, 0x223c43e0, 0x1b121d17, 0x090e0b0d, 0x8bf2adc7, 0xb62db9a8, 0x1e14c8a9,
+  0xf1578519, 0x75af4c07, 0x99eebbdd, 0x7fa3fd60, 0x01f79f26, 0x725cbcf5, 0x6644c53b, 0xfb5b347e,
+  0x438b7629, 0x23cbdcc6, 0xedb668fc, 0xe4b863f1, 0x31d7cadc, 0x63421085, 0x97134022, 0xc6842011,
+  0x4a857d24, 0xbbd2f83d, 0xf9ae1132, 0x29c76da1, 0x9e1d4b2f, 0xb2dcf330, 0x860dec52, 0xc177d0e3,
+  0xb32b6c16, 0x70a999b9, 0x9411fa48, 0xe9472264, 0xfca8c48c, 0xf0a01a3f, 0x7d56d82c, 0x3322ef90,
+  0x4987c74e, 0x38d9c1d1, 0xca8cfea2, 0xd498360b, 0xf5a6cf81, 0x7aa528de, 0xb7da268e, 0xad3fa4bf,
+  0x3a2ce49d, 0x78500d92, 0x5f6a9bcc, 0x7e546246, 0x8df6c213, 0xd890e8b8, 0x392e5ef7, 0xc382f5af,
+  0x5d9fbe80, 0xd0697c93, 0xd56fa92d, 0x25cfb312, 0xacc83b99, 0x1810a77d, 0x9ce86e63, 0x3bdb7bbb,
+  0x26cd0978, 0x596ef418, 0x9aec01b7, 0x4f83a89a, 0x95e6656e, 0xffaa7ee6, 0xbc2108cf, 0x15efe6e8,
+  0xe7bad99b, 0x6f4ace36, 0x9fead409, 0xb029d67c, 0xa431afb2, 0x3f2a3123, 0xa5c63094, 0xa235c066,
+  0x4e7437bc, 0x82fca6ca, 0x90e0b0d0, 0xa73315d8, 0x04f14a98, 0xec41f7da, 0xcd7f0e50, 0x91172ff6,
+  0x4d768dd6, 0xef434db0, 0xaacc544d, 0x96e4df04, 0xd19ee3b5, 0x6a4c1b88, 0x2cc1b81f, 0x65467f51,
+  0x5e9d04ea, 0x8c015d35, 0x87fa7374, 0x0bfb2e41, 0x67b35a1d, 0xdb9252d2, 0x10e93356, 0xd66d1347,
+  0xd79a8c61, 0xa1377a0c, 0xf8598e14, 0x13eb893c, 0xa9ceee27, 0x61b735c9, 0x1ce1ede5, 0x477a3cb1,
+  0xd29c59df, 0xf2553f73, 0x141879ce, 0xc773bf37, 0xf753eacd, 0xfd5f5baa, 0x3ddf146f, 0x447886db,
+  0xafca81f3, 0x68b93ec4, 0x24382c34, 0xa3c25f40, 0x1d1672c3, 0xe2bc0c25, 0x3c288b49, 0x0dff4195,
+  0xa8397101, 0x0c08deb3, 0xb4d89ce4, 0x566490c1, 0xcb7b6184, 0x32d570b6, 0x6c48745c, 0xb8d04257 };
+
+static const uint32_t Td3[256] = {
+  0x5150a7f4, 0x7e536541, 0x1ac3a417, 0x3a965e27, 0x3bcb6bab, 0x1ff1459d, 0xacab58fa, 0x4b9303e3,
+  0x2055fa30, 0xadf66d76, 0x889176cc, 0xf5254c02, 0x4ffcd7e5, 0xc5d7cb2a, 0x26804435, 0xb58fa362,
+  0xde495ab1, 0x25671bba, 0x45980eea, 0x5de1c0fe, 0xc302752f, 0x8112f04c, 0x8da39746, 0x6bc6f9d3,
+  0x03e75f8f, 0x15959c92, 0xbfeb7a6d, 0x95da5952, 0xd42d83be, 0x58d32174, 0x492969e0, 0x8e44c8c9,
+  0x756a89c2, 0xf478798e, 0x996b3e58, 0x27dd71b9, 0xbeb64fe1, 0xf017ad88, 0xc966ac20, 0x7db43ace,
+  0x63184adf, 0xe582311a, 0x97603351, 0x62457f53, 0xb1e07764, 0xbb84ae6b, 0xfe1ca081, 0xf9942b08,
+  0x70586848, 0x8f19fd45, 0x94876cde, 0x52b7f87b, 0xab23d373, 0x72e2024b, 0xe3578f1f, 0x662aab55,
+  0xb20728eb, 0x2f03c2b5, 0x869a7bc5, 0xd3a50837, 0x30f28728, 0x23b2a5bf, 0x02ba6a03, 0xed5c8216,
+  0x8a2b1ccf, 0xa792b479, 0xf3f0f207, 0x4ea1e269, 0x65cdf4da, 0x06d5be05, 0xd11f6234, 0xc48afea6,
+  0x349d532e, 0xa2a055f3, 0x0532e18a, 0xa475ebf6, 0x0b39ec83, 0x40aaef60, 0x5e069f71, 0xbd51106e,
+  0x3ef98a21, 0x963d06dd, 0xddae053e, 0x4d46bde6, 0x91b58d54, 0x71055dc4, 0x046fd406, 0x60ff1550,
+  0x1924fb98, 0xd697e9bd, 0x89cc4340, 0x67779ed9, 0xb0bd42e8, 0x07888b89, 0xe7385b19, 0x79dbeec8,
+  0xa1470a7c, 0x7ce90f42, 0xf8c91e84, 0x00000000, 0x09838680, 0x3248ed2b, 0x1eac7011, 0x6c4e725a,
+  0xfdfbff0e, 0x0f563885, 0x3d1ed5ae, 0x3627392d, 0x0a64d90f, 0x6821a65c, 0x9bd1545b, 0x243a2e36,
+  0x0cb1670a, 0x930fe757, 0xb4d296ee, 0x1b9e919b, 0x804fc5c0, 0x61a220dc, 0x5a694b77, 0x1c161a12,
+  0xe20aba93, 0xc0e52aa0, 0x3c43e022, 0x121d171b, 0x0e0b0d09, 0xf2adc78b, 0x2db9a8b6, 0x14c8a91e,
+  0x578519f1, 0xaf4c0775, 0xeebbdd99, 0xa3fd607f, 0xf79f2601, 0x5cbcf572, 0x44c53b66, 0x5b347efb,
+  0x8b762943, 0xcbdcc623, 0xb668fced, 0xb863f1e4, 0xd7cadc31, 0x42108563, 0x13402297, 0x842011c6,
+  0x857d244a, 0xd2f83dbb, 0xae1132f9, 0xc76da129, 0x1d4b2f9e, 0xdcf330b2, 0x0dec5286, 0x77d0e3c1,
+  0x2b6c16b3, 0xa999b970, 0x11fa4894, 0x472264e9, 0xa8c48cfc, 0xa01a3ff0, 0x56d82c7d, 0x22ef9033,
+  0x87c74e49, 0xd9c1d138, 0x8cfea2ca, 0x98360bd4, 0xa6cf81f5, 0xa528de7a, 0xda268eb7, 0x3fa4bfad,
+  0x2ce49d3a, 0x500d9278, 0x6a9bcc5f, 0x5462467e, 0xf6c2138d, 0x90e8b8d8, 0x2e5ef739, 0x82f5afc3,
+  0x9fbe805d, 0x697c93d0, 0x6fa92dd5, 0xcfb31225, 0xc83b99ac, 0x10a77d18, 0xe86e639c, 0xdb7bbb3b,
+  0xcd097826, 0x6ef41859, 0xec01b79a, 0x83a89a4f, 0xe6656e95, 0xaa7ee6ff, 0x2108cfbc, 0xefe6e815,
+  0xbad99be7, 0x4ace366f, 0xead4099f, 0x29d67cb0, 0x31afb2a4, 0x2a31233f, 0xc63094a5, 0x35c066a2,
+  0x7437bc4e, 0xfca6ca82, 0xe0b0d090, 0x3315d8a7, 0xf14a9804, 0x41f7daec, 0x7f0e50cd, 0x172ff691,
+  0x768dd64d, 0x434db0ef, 0xcc544daa, 0xe4df0496, 0x9ee3b5d1, 0x4c1b886a, 0xc1b81f2c, 0x467f5165,
+  0x9d04ea5e, 0x015d358c, 0xfa737487, 0xfb2e410b, 0xb35a1d67, 0x9252d2db, 0xe9335610, 0x6d1347d6,
+  0x9a8c61d7, 0x377a0ca1, 0x598e14f8, 0xeb893c13, 0xceee27a9, 0xb735c961, 0xe1ede51c, 0x7a3cb147,
+  0x9c59dfd2, 0x553f73f2, 0x1879ce14, 0x73bf37c7, 0x53eacdf7, 0x5f5baafd, 0xdf146f3d, 0x7886db44,
+  0xca81f3af, 0xb93ec468, 0x382c3424, 0xc25f40a3, 0x1672c31d, 0xbc0c25e2, 0x288b493c, 0xff41950d,
+  0x397101a8, 0x08deb30c, 0xd89ce4b4, 0x6490c156, 0x7b6184cb, 0xd570b632, 0x48745c6c, 0xd04257b8 };
+
+
+// aes_init()이 새 문맥에 넣어 줄 엔진이자 KeyExpansion()/Cipher()가 사용할 엔진이다.
+// aes_set_engine()으로 바꿀 수 있고, AES_ENGINE_AUTO는 프로그램이 시작될 때 CPU를 확인해서 정해진다.
+// 이미 만든 문맥은 ctx->engine을 쓰므로 이 값을 바꿔도 영향을 받지 않는다.
+static int aes_engine = AES_DEFAULT_ENGINE;
+
+// 큰 버퍼를 나눠 처리할 스레드 수, 0이면 온라인 CPU 수를 사용한다.
+static int aes_threads = 0;
 
 /*
 이번 과제를 진행하면서 스켈레톤 코드를 제외하고 작성한 추가 함수들의 목록입니다.
@@ -69,6 +391,30 @@ void Shift(uint8_t*, int, int, int);
 void ShiftRows(uint8_t*, int);
 uint8_t Mul(uint8_t, uint8_t);
 void MixColumns(uint8_t*, int);
+static void CipherTTable(uint8_t*, const uint32_t*, int);
+static void InvCipherTTable(uint8_t*, const uint32_t*, int);
+static void KeyExpansionRef(const uint8_t*, int, uint32_t*, uint32_t*, uint32_t (*)(uint32_t));
+static void CipherRef(uint8_t*, const uint32_t*, const uint32_t*, int, int);
+static void EncryptBlock(uint8_t*, const uint32_t*, int, int);
+static void DecryptBlock(uint8_t*, const uint32_t*, int, int);
+static void CtrBlocks(const aes_ctx*, uint64_t, uint64_t, const uint8_t*, uint8_t*, size_t);
+static void EncryptBlocks(const aes_ctx*, const uint8_t*, uint8_t*, size_t);
+static void DecryptBlocks(const aes_ctx*, const uint8_t*, uint8_t*, size_t);
+#ifdef AES_HAVE_BITSLICE
+static void BsKey(const uint32_t*, int, uint32_t*);
+static uint32_t BsSubWord(uint32_t);
+static void BsEncrypt(const uint32_t*, int, const uint8_t*, uint8_t*, size_t);
+static void BsDecrypt(const uint32_t*, int, const uint8_t*, uint8_t*, size_t);
+#endif
+#ifdef AES_HAVE_AESNI
+static int aesni_supported(void);
+static void KeyExpansionAESNI(const uint8_t*, int, uint32_t*, uint32_t*);
+static void CipherAESNI(uint8_t*, const uint32_t*, int);
+static void InvCipherAESNI(uint8_t*, const uint32_t*, int);
+static void CtrAESNI(const uint32_t*, int, uint64_t, uint64_t, const uint8_t*, uint8_t*, size_t);
+static void EncryptBlocksAESNI(const uint32_t*, int, const uint8_t*, uint8_t*, size_t);
+static void DecryptBlocksAESNI(const uint32_t*, int, const uint8_t*, uint8_t*, size_t);
+#endif
 
 /*
  * Generate an AES key schedule
@@ -107,18 +453,26 @@ memcpy로 잘라서 Inverse Mix Cols를 진행해주고, 다시 memcpy 로dround
 바꿔주는 연산이다. 이렇게 하면 droundKey의 모든 부분에 연산이 진행되어서 새로운 w가 만들
 어진다. 이제 복호화 과정에서는 roundKey대신 droundKey를 사용하고, 연산 순서를 암호화와 같
 이 해주면 된다.
+
+키 길이는 aes_init()에서 받은 nk(4, 6, 8)로 정해지고, 라운드 수는 nr = nk + 6 이다.
+AES-192, AES-256에서도 반복문은 그대로이고 w의 개수만 Nb * (nr + 1) = 52, 60개로 늘어난다.
+
+g연산의 S-box는 subword로 받는다. 보통은 sbox를 조회하는 SubWord를 넘기고, 비트 슬라이스
+엔진의 문맥은 키 확장에서도 키 값으로 테이블을 조회하지 않도록 BsSubWord를 넘긴다.
 */
 
 // w를 만드는 키 확장 알고리즘
-void KeyExpansion(const uint8_t *key, uint32_t *roundKey)
+static void KeyExpansionRef(const uint8_t *key, int nk, uint32_t *roundKey, uint32_t *droundKey,
+							uint32_t (*subword)(uint32_t))
 {
 	// 변수 선언
 	int i = 0;
+	int nr = nk + 6;
 	uint32_t temp;
 	uint8_t *p;
 
 	// w[0,3] 제작
-	while (i < Nk){
+	while (i < nk){
 		p = (uint8_t*)(roundKey+i);
 		p[0] = key[4*i+0];
 		p[1] = key[4*i+1];
@@ -127,36 +481,32 @@ void KeyExpansion(const uint8_t *key, uint32_t *roundKey)
 		i++;
 	}
 	
-	i = Nk; // 4
+	i = nk; // 4
 	// w[4,43] 제작
 	// 40번 반복
-	while (i < Nb * (Nr+1)){
+	while (i < Nb * (nr+1)){
 		// 바로 이전 w
 		temp = roundKey[i-1];
 
 		// g연산
-		if (i % Nk == 0){
-			temp = SubWord(RotWord(temp)) ^ Rcon[i/Nk];
+		if (i % nk == 0){
+			temp = subword(RotWord(temp)) ^ Rcon[i/nk];
 		}
-		else if (Nk > 6 && (i % Nk == 4))
-			temp = SubWord(temp);
+		else if (nk > 6 && (i % nk == 4))
+			temp = subword(temp);
 
 		// Nk이전 것과 temp XOR
-		roundKey[i] = roundKey[i-Nk] ^ temp;
+		roundKey[i] = roundKey[i-nk] ^ temp;
 		i++;	
 	}
 
-	// 복호화용 roundKey제작
-	for (int i = 0; i < Nb * (Nr+1); i++){
+	// 복호화용 roundKey제작: 처음과 마지막 라운드 키는 그대로, 나머지는 열마다 InvMixColumns
+	for (int i = 0; i < Nb; i++){
 		droundKey[i] = roundKey[i];
+		droundKey[nr*Nb + i] = roundKey[nr*Nb + i];
 	}
-
-	for (int i = 1; i < Nr; i++){
-		uint8_t tem[BLOCKLEN];
-		memcpy(tem, droundKey + i*Nb, sizeof(uint8_t) * BLOCKLEN);
-		MixColumns(tem, DECRYPT);
-		memcpy(droundKey + i*Nb, tem, sizeof(uint8_t) * BLOCKLEN);
-	}
+	for (int i = Nb; i < nr*Nb; i++)
+		droundKey[i] = InvMixColumn(roundKey[i]);
 }
 
 /*
@@ -215,7 +565,7 @@ roundKey의 특정 위치를 복사해준다. 첫 w[0,3]은 주소상 roundKey
 */
 
 // 암호화 알고리즘
-void Cipher(uint8_t *state, const uint32_t *roundKey, int mode)
+static void CipherRef(uint8_t *state, const uint32_t *roundKey, const uint32_t *droundKey, int nr, int mode)
 {
 	// w[x,y] 표현해줄 임시 배열
 	uint32_t temKey[Nb];
@@ -226,7 +576,7 @@ void Cipher(uint8_t *state, const uint32_t *roundKey, int mode)
 		memcpy(temKey, roundKey, sizeof(uint32_t) * Nb);
       	AddRoundKey(state, temKey);
   
-      	for (int i = 1; i < Nr; i++){
+      	for (int i = 1; i < nr; i++){
         	SubBytes(state, mode);
         	ShiftRows(state, mode);
         	MixColumns(state, mode);
@@ -240,17 +590,17 @@ void Cipher(uint8_t *state, const uint32_t *roundKey, int mode)
       	ShiftRows(state, mode);
       	
 		// w[40,43](10라운드)
-      	memcpy(temKey, roundKey + Nr*Nb, sizeof(uint32_t) * Nb);
+      	memcpy(temKey, roundKey + nr*Nb, sizeof(uint32_t) * Nb);
       	AddRoundKey(state, temKey);
 
 	}
 	// 복호화
 	else if (mode == DECRYPT){
 		// dw[40,43](10라운드)
-		memcpy(temKey, droundKey + Nr*Nb, sizeof(uint32_t) * Nb);
+		memcpy(temKey, droundKey + nr*Nb, sizeof(uint32_t) * Nb);
 		AddRoundKey(state, temKey);
 
-		for (int i = Nr - 1; i > 0; i--){
+		for (int i = nr - 1; i > 0; i--){
 			SubBytes(state, mode);	
 			ShiftRows(state, mode);
 			MixColumns(state, mode);
@@ -270,6 +620,1434 @@ void Cipher(uint8_t *state, const uint32_t *roundKey, int mode)
 	}
 }
 
+/*
+ * aes_init() - 길이가 keylen 바이트인 key로 문맥 ctx의 암호화/복호화 라운드 키를 만든다.
+ * keylen은 AES128_KEYLEN(16), AES192_KEYLEN(24), AES256_KEYLEN(32) 중 하나이어야 하고,
+ * 키 길이에 맞춰 ctx->nk, ctx->nr이 정해진다. 성공하면 0, 그렇지 않으면 -1을 넘겨준다.
+ * 지금 선택된 엔진을 ctx->engine에 기록하고, 이 문맥의 연산은 모두 그 엔진과 그 엔진에 맞는
+ * 라운드 키 형태를 사용한다. 만들어진 문맥은 읽기만 하므로 여러 스레드가 잠금 없이 같이 사용해도 되고,
+ * 다른 스레드가 aes_set_engine()으로 엔진을 바꿔도 영향을 받지 않는다.
+ */
+int aes_init(aes_ctx *ctx, const uint8_t *key, int keylen)
+{
+	if (keylen != AES128_KEYLEN && keylen != AES192_KEYLEN && keylen != AES256_KEYLEN)
+		return AES_INVALID;
+	ctx->nk = keylen / 4;
+	ctx->nr = ctx->nk + 6;
+	ctx->engine = aes_get_engine();
+#ifdef AES_HAVE_AESNI
+	// AES-NI 엔진이면 aeskeygenassist로 roundKey와 droundKey를 함께 만든다.
+	// AES-192의 라운드 키는 128비트 경계에 맞지 않으므로 워드 단위 확장을 그대로 쓴다.
+	if (ctx->engine == AES_ENGINE_AESNI && ctx->nk != 6)
+		KeyExpansionAESNI(key, ctx->nk, ctx->roundKey, ctx->droundKey);
+	else
+#endif
+#ifdef AES_HAVE_BITSLICE
+	if (ctx->engine == AES_ENGINE_BITSLICE)
+		KeyExpansionRef(key, ctx->nk, ctx->roundKey, ctx->droundKey, BsSubWord);
+	else
+#endif
+		KeyExpansionRef(key, ctx->nk, ctx->roundKey, ctx->droundKey, SubWord);
+#ifdef AES_HAVE_BITSLICE
+	// 비트 슬라이스 라운드 키는 엔진과 상관없이 항상 만들어 둔다. 그래서 블록 연산은
+	// 문맥의 라운드 키를 그대로 쓰고, 호출할 때마다 변환하는 경로가 없다.
+	BsKey(ctx->roundKey, ctx->nr, ctx->bsKey);
+	BsKey(ctx->droundKey, ctx->nr, ctx->bsDKey);
+#endif
+	return 0;
+}
+
+/*
+ * aes_encrypt_block() - 문맥 ctx로 블록 in을 암호화해서 out에 저장한다.
+ * aes_decrypt_block() - 문맥 ctx로 블록 in을 복호화해서 out에 저장한다.
+ * in과 out은 같은 버퍼여도 된다.
+ */
+void aes_encrypt_block(const aes_ctx *ctx, const uint8_t *in, uint8_t *out)
+{
+	EncryptBlocks(ctx, in, out, 1);
+}
+
+void aes_decrypt_block(const aes_ctx *ctx, const uint8_t *in, uint8_t *out)
+{
+	DecryptBlocks(ctx, in, out, 1);
+}
+
+/*
+ * aes_encrypt_blocks() - 문맥 ctx로 nblocks개의 블록을 각각 암호화한다 (ECB).
+ * aes_decrypt_blocks() - 문맥 ctx로 nblocks개의 블록을 각각 복호화한다 (ECB).
+ * 비트 슬라이스 엔진은 8블록씩 한꺼번에 처리하므로 블록을 하나씩 넘기는 것보다 훨씬 빠르다.
+ * in과 out은 같은 버퍼여도 된다.
+ */
+void aes_encrypt_blocks(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	EncryptBlocks(ctx, in, out, nblocks);
+}
+
+void aes_decrypt_blocks(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	DecryptBlocks(ctx, in, out, nblocks);
+}
+
+static void EncryptBlocks(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+#ifdef AES_HAVE_BITSLICE
+	if (ctx->engine == AES_ENGINE_BITSLICE){
+		size_t n;
+
+		for (; nblocks > 0; nblocks -= n){
+			n = nblocks < 8 ? nblocks : 8;
+			BsEncrypt(ctx->bsKey, ctx->nr, in, out, n);
+			in += n*BLOCKLEN;
+			out += n*BLOCKLEN;
+		}
+		return;
+	}
+#endif
+#ifdef AES_HAVE_AESNI
+	if (ctx->engine == AES_ENGINE_AESNI){
+		EncryptBlocksAESNI(ctx->roundKey, ctx->nr, in, out, nblocks);
+		return;
+	}
+#endif
+	if (out != in)
+		memcpy(out, in, nblocks*BLOCKLEN);
+	for (size_t i = 0; i < nblocks; i++)
+		EncryptBlock(out + i*BLOCKLEN, ctx->roundKey, ctx->nr, ctx->engine);
+}
+
+static void DecryptBlocks(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+#ifdef AES_HAVE_BITSLICE
+	if (ctx->engine == AES_ENGINE_BITSLICE){
+		size_t n;
+
+		for (; nblocks > 0; nblocks -= n){
+			n = nblocks < 8 ? nblocks : 8;
+			BsDecrypt(ctx->bsDKey, ctx->nr, in, out, n);
+			in += n*BLOCKLEN;
+			out += n*BLOCKLEN;
+		}
+		return;
+	}
+#endif
+#ifdef AES_HAVE_AESNI
+	if (ctx->engine == AES_ENGINE_AESNI){
+		DecryptBlocksAESNI(ctx->droundKey, ctx->nr, in, out, nblocks);
+		return;
+	}
+#endif
+	if (out != in)
+		memcpy(out, in, nblocks*BLOCKLEN);
+	for (size_t i = 0; i < nblocks; i++)
+		DecryptBlock(out + i*BLOCKLEN, ctx->droundKey, ctx->nr, ctx->engine);
+}
+
+// engine으로 state를 nr 라운드의 roundKey로 암호화한다.
+static void EncryptBlock(uint8_t *state, const uint32_t *roundKey, int nr, int engine)
+{
+	switch (engine){
+#ifdef AES_HAVE_AESNI
+	case AES_ENGINE_AESNI:
+		CipherAESNI(state, roundKey, nr);
+		break;
+#endif
+	case AES_ENGINE_REF:
+		CipherRef(state, roundKey, NULL, nr, ENCRYPT);
+		break;
+#ifdef AES_HAVE_BITSLICE
+	// 문맥의 라운드 키는 EncryptBlocks()가 처리하므로 여기에는 KeyExpansion()이 만들지 않은
+	// roundKey를 Cipher()에 넘긴 경우만 온다.
+	case AES_ENGINE_BITSLICE: {
+		uint32_t bk[AES_BSKEYLEN];
+		BsKey(roundKey, nr, bk);
+		BsEncrypt(bk, nr, state, state, 1);
+		break;
+	}
+#endif
+	default:
+		CipherTTable(state, roundKey, nr);
+		break;
+	}
+}
+
+// engine으로 state를 nr 라운드의 droundKey로 복호화한다.
+static void DecryptBlock(uint8_t *state, const uint32_t *droundKey, int nr, int engine)
+{
+	switch (engine){
+#ifdef AES_HAVE_AESNI
+	case AES_ENGINE_AESNI:
+		InvCipherAESNI(state, droundKey, nr);
+		break;
+#endif
+	case AES_ENGINE_REF:
+		CipherRef(state, NULL, droundKey, nr, DECRYPT);
+		break;
+	default:
+		InvCipherTTable(state, droundKey, nr);
+		break;
+	}
+}
+
+/*
+ * KeyExpansion(), Cipher() - 기존 인터페이스로 aes_init(), aes_encrypt_block(),
+ * aes_decrypt_block()을 감싼 것이다. 복호화용 roundKey는 마지막으로 KeyExpansion()에
+ * 넘긴 키의 것을 사용하므로 한 번에 하나의 키만 쓸 수 있다. 여러 키나 여러 스레드가
+ * 필요하면 aes_ctx를 사용한다. 이 인터페이스는 AES-128(Nk, Nr)만 지원한다.
+ * 엔진은 KeyExpansion()할 때 선택된 것을 쓰고, Cipher()는 전역 상태를 읽기만 한다.
+ */
+void KeyExpansion(const uint8_t *key, uint32_t *roundKey)
+{
+	aes_init(&legacy_ctx, key, KEYLEN);
+	memcpy(roundKey, legacy_ctx.roundKey, sizeof(uint32_t) * RNDKEYLEN);
+	legacy_rk = roundKey;
+}
+
+void Cipher(uint8_t *state, const uint32_t *roundKey, int mode)
+{
+	// KeyExpansion()이 채운 roundKey이면 문맥을 그대로 쓰고(비트 슬라이스 키도 들어 있다),
+	// 다른 곳에서 만든 라운드 키이면 그 키로 한 블록을 암호화한다.
+	if (mode == ENCRYPT){
+		if (roundKey == legacy_rk)
+			EncryptBlocks(&legacy_ctx, state, state, 1);
+		else
+			EncryptBlock(state, roundKey, Nr, legacy_ctx.engine);
+	}
+	else if (mode == DECRYPT)
+		DecryptBlocks(&legacy_ctx, state, state, 1);
+}
+
+/*
+ * aes_set_engine() - 이후에 aes_init()하는 문맥과 KeyExpansion(), Cipher()가 사용할 엔진을 고른다.
+ * 이미 aes_init()한 문맥은 그때 고른 엔진을 계속 사용하므로 다른 스레드가 쓰고 있는 문맥에는 영향이 없다.
+ * AES_ENGINE_AUTO를 주면 AES-NI를 지원하는 CPU에서는 AES_ENGINE_AESNI, 그 외에는
+ * AES_ENGINE_TTABLE을 고른다. 성공하면 0, 모르는 엔진이거나 CPU가 지원하지 않으면 -1을 넘겨준다.
+ * 기존 인터페이스는 KeyExpansion()을 다시 호출해야 바꾼 엔진을 사용한다.
+ */
+int aes_set_engine(int engine)
+{
+	if (engine == AES_ENGINE_AUTO){
+#ifdef AES_HAVE_AESNI
+		engine = aesni_supported() ? AES_ENGINE_AESNI : AES_ENGINE_TTABLE;
+#else
+		engine = AES_ENGINE_TTABLE;
+#endif
+	}
+	if (engine == AES_ENGINE_AESNI){
+#ifdef AES_HAVE_AESNI
+		if (!aesni_supported())
+			return -1;
+#else
+		return -1;
+#endif
+	}
+	else if (engine == AES_ENGINE_BITSLICE){
+#ifndef AES_HAVE_BITSLICE
+		return -1;
+#endif
+	}
+	else if (engine != AES_ENGINE_REF && engine != AES_ENGINE_TTABLE)
+		return -1;
+	aes_engine = engine;
+	return 0;
+}
+
+// 현재 선택된 엔진을 돌려준다.
+int aes_get_engine(void)
+{
+	return aes_engine == AES_ENGINE_AUTO ? AES_ENGINE_TTABLE : aes_engine;
+}
+
+/*
+ * aes_set_threads() - aes_ctr_update() 등이 큰 버퍼를 나눠 처리할 때 사용할 스레드 수를 정한다.
+ * n이 0 이하이면 온라인 CPU 수를 사용하고, AES_MAXTHREADS보다 크면 AES_MAXTHREADS로 줄인다.
+ */
+void aes_set_threads(int n)
+{
+	aes_threads = n < 0 ? 0 : (n > AES_MAXTHREADS ? AES_MAXTHREADS : n);
+}
+
+// 실제로 사용할 스레드 수를 돌려준다.
+static int ThreadCount(void)
+{
+	long n = aes_threads;
+
+	if (n == 0)
+		n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n < 1)
+		n = 1;
+	return n > AES_MAXTHREADS ? AES_MAXTHREADS : (int)n;
+}
+
+/*
+CTR 모드이다 (NIST SP 800-38A). 카운터 블록을 암호화한 키 스트림을 평문과 XOR 하고, 카운터
+블록 전체를 128비트 빅 엔디안 정수로 보고 블록마다 1씩 더한다. 카운터는 상위/하위 64비트
+(hi, lo)로 나누어 들고 다니다가 블록을 만들 때 바이트로 바꾼다.
+
+블록끼리 서로 의존하지 않으므로 AES_CTR_BLOCKS(8)개의 카운터 블록을 한꺼번에 만들어 암호화한다.
+AES-NI에서는 8개 블록의 aesenc를 라운드마다 번갈아 실행해서 명령어 지연 시간을 가리고,
+T-table과 기준 구현은 8개 블록을 연달아 암호화한 뒤 한 번에 XOR 해서 CPU가 서로 다른 블록의
+테이블 조회를 겹쳐 실행할 수 있게 한다.
+*/
+static inline uint64_t load64be(const uint8_t *p)
+{
+	uint64_t x = 0;
+	for (int i = 0; i < 8; i++)
+		x = (x << 8) | p[i];
+	return x;
+}
+
+static inline void store64be(uint8_t *p, uint64_t x)
+{
+	for (int i = 7; i >= 0; i--){
+		p[i] = (uint8_t)x;
+		x >>= 8;
+	}
+}
+
+// 카운터 (hi, lo)부터 nblocks개의 블록을 암호화/복호화한다.
+static void CtrBlocks(const aes_ctx *ctx, uint64_t hi, uint64_t lo, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	uint8_t ks[AES_CTR_BLOCKS*BLOCKLEN];
+	size_t n;
+
+#ifdef AES_HAVE_AESNI
+	if (ctx->engine == AES_ENGINE_AESNI){
+		CtrAESNI(ctx->roundKey, ctx->nr, hi, lo, in, out, nblocks);
+		return;
+	}
+#endif
+	while (nblocks > 0){
+		n = nblocks < AES_CTR_BLOCKS ? nblocks : AES_CTR_BLOCKS;
+		for (size_t j = 0; j < n; j++){
+			store64be(ks + j*BLOCKLEN, hi);
+			store64be(ks + j*BLOCKLEN + 8, lo);
+			if (++lo == 0)
+				++hi;
+		}
+		EncryptBlocks(ctx, ks, ks, n);
+		for (size_t i = 0; i < n*BLOCKLEN; i += 8){
+			uint64_t x, y;
+			memcpy(&x, in + i, 8);
+			memcpy(&y, ks + i, 8);
+			x ^= y;
+			memcpy(out + i, &x, 8);
+		}
+		in += n*BLOCKLEN;
+		out += n*BLOCKLEN;
+		nblocks -= n;
+	}
+}
+
+// 스레드 하나가 맡는 구간
+typedef struct {
+	const aes_ctx *ctx;
+	uint64_t hi, lo;
+	const uint8_t *in;
+	uint8_t *out;
+	size_t nblocks;
+} ctr_job;
+
+static void *CtrWorker(void *arg)
+{
+	ctr_job *job = (ctr_job *)arg;
+
+	CtrBlocks(job->ctx, job->hi, job->lo, job->in, job->out, job->nblocks);
+	return NULL;
+}
+
+/*
+AES_PARALLEL_MIN 바이트 이상이면 블록들을 스레드 수만큼 연속된 구간으로 나누고, 구간마다
+시작 카운터를 미리 계산해서 각 스레드가 따로 처리한다. 마지막 구간은 호출한 스레드가 맡고,
+스레드를 만들지 못한 구간도 호출한 스레드가 직접 처리한다.
+스레드는 호출마다 만들고 기다리는데, 이 비용은 수십 마이크로초로 1MiB를 암호화하는 시간
+(AES-NI에서 수백 마이크로초)보다 훨씬 작다. 그래서 스레드 풀을 두지 않고, 구간 하나가
+AES_THREAD_MIN 바이트보다 작아지지 않도록 스레드 수만 줄인다.
+*/
+static void CtrParallel(const aes_ctx *ctx, uint64_t hi, uint64_t lo, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	pthread_t tid[AES_MAXTHREADS];
+	ctr_job job[AES_MAXTHREADS];
+	int started[AES_MAXTHREADS];
+	size_t per, off = 0, len = nblocks * BLOCKLEN;
+	int t, nthreads;
+
+	// 작은 버퍼에서는 CPU 수를 알아내는 비용(sysconf)도 아낀다.
+	if (len < AES_PARALLEL_MIN || (nthreads = ThreadCount()) <= 1){
+		CtrBlocks(ctx, hi, lo, in, out, nblocks);
+		return;
+	}
+	if ((size_t)nthreads > len / AES_THREAD_MIN)
+		nthreads = (int)(len / AES_THREAD_MIN);
+	per = (nblocks + nthreads - 1) / nthreads;
+	for (t = 0; t < nthreads; t++){
+		job[t].ctx = ctx;
+		job[t].hi = hi + (lo + off < lo);
+		job[t].lo = lo + off;
+		job[t].in = in + off*BLOCKLEN;
+		job[t].out = out + off*BLOCKLEN;
+		job[t].nblocks = nblocks - off < per ? nblocks - off : per;
+		off += job[t].nblocks;
+		started[t] = t < nthreads - 1 && pthread_create(&tid[t], NULL, CtrWorker, &job[t]) == 0;
+		if (t < nthreads - 1 && !started[t])
+			CtrWorker(&job[t]);
+	}
+	CtrWorker(&job[nthreads - 1]);
+	for (t = 0; t < nthreads - 1; t++)
+		if (started[t])
+			pthread_join(tid[t], NULL);
+}
+
+/*
+ * aes_ctr_init() - 문맥 key와 초기 카운터 블록 iv로 CTR 스트림 ctr을 준비한다.
+ * key는 ctr을 사용하는 동안 바뀌지 않아야 한다.
+ */
+void aes_ctr_init(aes_ctr_ctx *ctr, const aes_ctx *key, const uint8_t *iv)
+{
+	ctr->key = key;
+	memcpy(ctr->counter, iv, BLOCKLEN);
+	ctr->used = BLOCKLEN;
+}
+
+/*
+ * aes_ctr_update() - 길이가 len 바이트인 in을 암호화(복호화)해서 out에 저장한다.
+ * 여러 번 나누어 호출해도 한 번에 호출한 것과 결과가 같으므로 큰 파일을 조각 단위로 흘려보낼 수 있다.
+ * in과 out은 같은 버퍼여도 된다.
+ */
+void aes_ctr_update(aes_ctr_ctx *ctr, const uint8_t *in, uint8_t *out, size_t len)
+{
+	uint64_t hi, lo;
+	size_t nblocks;
+
+	// 앞에서 쓰다 남은 키 스트림
+	while (len > 0 && ctr->used < BLOCKLEN){
+		*out++ = *in++ ^ ctr->stream[ctr->used++];
+		len--;
+	}
+	if (len == 0)
+		return;
+
+	hi = load64be(ctr->counter);
+	lo = load64be(ctr->counter + 8);
+	nblocks = len / BLOCKLEN;
+	if (nblocks > 0){
+		CtrParallel(ctr->key, hi, lo, in, out, nblocks);
+		hi += (lo + nblocks < lo);
+		lo += nblocks;
+		in += nblocks*BLOCKLEN;
+		out += nblocks*BLOCKLEN;
+		len -= nblocks*BLOCKLEN;
+	}
+
+	// 블록보다 짧은 나머지는 키 스트림 블록을 하나 만들어 앞부분만 사용한다.
+	if (len > 0){
+		store64be(ctr->stream, hi);
+		store64be(ctr->stream + 8, lo);
+		if (++lo == 0)
+			++hi;
+		EncryptBlocks(ctr->key, ctr->stream, ctr->stream, 1);
+		for (ctr->used = 0; ctr->used < (int)len; ctr->used++)
+			out[ctr->used] = in[ctr->used] ^ ctr->stream[ctr->used];
+	}
+	store64be(ctr->counter, hi);
+	store64be(ctr->counter + 8, lo);
+}
+
+// aes_ctr() - 초기 카운터 블록 iv로 in 전체를 한 번에 암호화(복호화)한다.
+void aes_ctr(const aes_ctx *key, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len)
+{
+	aes_ctr_ctx ctr;
+
+	aes_ctr_init(&ctr, key, iv);
+	aes_ctr_update(&ctr, in, out, len);
+}
+
+/*
+ECB, CBC, CFB, OFB 모드이다 (NIST SP 800-38A).
+암호화 쪽의 CBC와 CFB는 앞 블록의 암호문이 있어야 다음 블록을 암호화할 수 있고, OFB는 키 스트림이
+앞 키 스트림에 의존하므로 한 블록씩 처리할 수밖에 없다. 반면 CBC 복호화 P_i = D(C_i) ^ C_(i-1)와
+CFB 복호화 P_i = E(C_(i-1)) ^ C_i는 블록 암호 입력이 모두 암호문이므로 서로 의존하지 않는다.
+그래서 AES_PIPE_BLOCKS개의 블록을 DecryptBlocks()/EncryptBlocks()에 한꺼번에 넘겨서 여러 블록을
+동시에 처리하고(AES-NI 8블록 교차 실행, 비트 슬라이스 8블록), 앞 암호문은 나중에 XOR 한다.
+제자리 처리에서는 출력이 암호문을 덮어쓰므로 한 묶음의 암호문을 먼저 복사해 둔다.
+*/
+static inline void XorBlock(uint8_t *out, const uint8_t *a, const uint8_t *b)
+{
+	uint64_t x[2], y[2];
+
+	memcpy(x, a, BLOCKLEN);
+	memcpy(y, b, BLOCKLEN);
+	x[0] ^= y[0];
+	x[1] ^= y[1];
+	memcpy(out, x, BLOCKLEN);
+}
+
+/*
+PKCS#7 패딩을 확인해서 길이를 돌려준다. 패딩 값에 따라 분기하지 않고 블록 전체를 마스크로
+검사하므로, 오류가 어느 바이트에서 생겼는지 실행 시간으로 드러나지 않는다.
+*/
+static int Pkcs7Check(const uint8_t *last)
+{
+	unsigned int p = last[BLOCKLEN-1], bad;
+
+	bad = ((p - 1) >> 8) | ((BLOCKLEN - p) >> 8);        // p == 0 이거나 p > BLOCKLEN
+	for (unsigned int i = 0; i < BLOCKLEN; i++){
+		unsigned int inpad = (BLOCKLEN - 1 - i - p) >> 8;  // i >= BLOCKLEN - p 이면 모두 1
+		bad |= inpad & (last[i] ^ p);
+	}
+	return (bad & 0xFF) ? AES_BAD_PADDING : (int)p;
+}
+
+// 패딩 방식과 데이터 길이가 올바른지 확인한다.
+static int CheckLength(size_t len, int pad, int decrypt)
+{
+	if (pad != AES_PAD_NONE && pad != AES_PAD_PKCS7)
+		return AES_INVALID;
+	if ((pad == AES_PAD_NONE || decrypt) && len % BLOCKLEN != 0)
+		return AES_INVALID;
+	if (pad == AES_PAD_PKCS7 && decrypt && len == 0)
+		return AES_INVALID;
+	return 0;
+}
+
+// 마지막 불완전 블록(rest 바이트)에 PKCS#7 패딩을 붙인다.
+static void Pkcs7Pad(uint8_t *block, const uint8_t *in, size_t rest)
+{
+	memcpy(block, in, rest);
+	memset(block + rest, (int)(BLOCKLEN - rest), BLOCKLEN - rest);
+}
+
+/*
+ * aes_ecb_encrypt() - in의 len 바이트를 ECB로 암호화해서 out에 저장하고 길이를 *outlen에 저장한다.
+ * aes_ecb_decrypt() - in의 len 바이트를 ECB로 복호화하고 pad에 따라 패딩을 떼어낸다.
+ * 성공하면 0, 길이나 패딩 방식이 잘못되었으면 AES_INVALID, 패딩이 틀리면 AES_BAD_PADDING을 돌려준다.
+ */
+int aes_ecb_encrypt(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t len, int pad, size_t *outlen)
+{
+	uint8_t last[BLOCKLEN];
+	size_t nblocks = len / BLOCKLEN;
+
+	if (CheckLength(len, pad, 0))
+		return AES_INVALID;
+	if (pad == AES_PAD_PKCS7)
+		Pkcs7Pad(last, in + nblocks*BLOCKLEN, len % BLOCKLEN);
+	EncryptBlocks(ctx, in, out, nblocks);
+	*outlen = nblocks*BLOCKLEN;
+	if (pad == AES_PAD_PKCS7){
+		EncryptBlocks(ctx, last, out + nblocks*BLOCKLEN, 1);
+		*outlen += BLOCKLEN;
+	}
+	return 0;
+}
+
+int aes_ecb_decrypt(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t len, int pad, size_t *outlen)
+{
+	size_t nblocks = len / BLOCKLEN;
+	int p;
+
+	if (CheckLength(len, pad, 1))
+		return AES_INVALID;
+	DecryptBlocks(ctx, in, out, nblocks);
+	*outlen = len;
+	if (pad == AES_PAD_PKCS7){
+		if ((p = Pkcs7Check(out + len - BLOCKLEN)) < 0)
+			return p;
+		*outlen -= p;
+	}
+	return 0;
+}
+
+/*
+ * aes_cbc_encrypt() - 초기 벡터 iv로 in의 len 바이트를 CBC로 암호화한다.
+ * aes_cbc_decrypt() - 초기 벡터 iv로 in의 len 바이트를 CBC로 복호화하고 pad에 따라 패딩을 떼어낸다.
+ * 돌려주는 값은 aes_ecb_encrypt(), aes_ecb_decrypt()와 같다.
+ */
+int aes_cbc_encrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len,
+                    int pad, size_t *outlen)
+{
+	uint8_t last[BLOCKLEN];
+	const uint8_t *prev = iv;
+	size_t nblocks = len / BLOCKLEN;
+
+	if (CheckLength(len, pad, 0))
+		return AES_INVALID;
+	if (pad == AES_PAD_PKCS7)
+		Pkcs7Pad(last, in + nblocks*BLOCKLEN, len % BLOCKLEN);
+	for (size_t i = 0; i < nblocks; i++){
+		XorBlock(out, in, prev);
+		EncryptBlocks(ctx, out, out, 1);
+		prev = out;
+		in += BLOCKLEN;
+		out += BLOCKLEN;
+	}
+	*outlen = nblocks*BLOCKLEN;
+	if (pad == AES_PAD_PKCS7){
+		XorBlock(out, last, prev);
+		EncryptBlocks(ctx, out, out, 1);
+		*outlen += BLOCKLEN;
+	}
+	return 0;
+}
+
+int aes_cbc_decrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len,
+                    int pad, size_t *outlen)
+{
+	uint8_t c[AES_PIPE_BLOCKS*BLOCKLEN], prev[BLOCKLEN];
+	size_t nblocks = len / BLOCKLEN;
+	size_t n;
+	int p;
+
+	if (CheckLength(len, pad, 1))
+		return AES_INVALID;
+	memcpy(prev, iv, BLOCKLEN);
+	for (size_t left = nblocks; left > 0; left -= n){
+		n = left < AES_PIPE_BLOCKS ? left : AES_PIPE_BLOCKS;
+		memcpy(c, in, n*BLOCKLEN);
+		DecryptBlocks(ctx, c, out, n);
+		XorBlock(out, out, prev);
+		for (size_t j = 1; j < n; j++)
+			XorBlock(out + j*BLOCKLEN, out + j*BLOCKLEN, c + (j-1)*BLOCKLEN);
+		memcpy(prev, c + (n-1)*BLOCKLEN, BLOCKLEN);
+		in += n*BLOCKLEN;
+		out += n*BLOCKLEN;
+	}
+	*outlen = len;
+	if (pad == AES_PAD_PKCS7){
+		if ((p = Pkcs7Check(out - BLOCKLEN)) < 0)
+			return p;
+		*outlen -= p;
+	}
+	return 0;
+}
+
+/*
+ * aes_cfb_encrypt() - 초기 벡터 iv로 in의 len 바이트를 CFB(128비트 피드백)로 암호화한다.
+ * aes_cfb_decrypt() - 초기 벡터 iv로 in의 len 바이트를 CFB로 복호화한다.
+ * 마지막 블록이 짧으면 키 스트림의 앞부분만 사용한다.
+ */
+void aes_cfb_encrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len)
+{
+	uint8_t ks[BLOCKLEN];
+	size_t n;
+
+	memcpy(ks, iv, BLOCKLEN);
+	for (; len > 0; len -= n){
+		n = len < BLOCKLEN ? len : BLOCKLEN;
+		EncryptBlocks(ctx, ks, ks, 1);
+		for (size_t j = 0; j < n; j++)
+			ks[j] = out[j] = in[j] ^ ks[j];    // 암호문이 다음 블록의 입력이 된다.
+		in += n;
+		out += n;
+	}
+}
+
+void aes_cfb_decrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len)
+{
+	uint8_t ks[AES_PIPE_BLOCKS*BLOCKLEN], prev[BLOCKLEN];
+	size_t n, nblocks;
+
+	memcpy(prev, iv, BLOCKLEN);
+	while (len > 0){
+		nblocks = (len + BLOCKLEN - 1) / BLOCKLEN;
+		nblocks = nblocks < AES_PIPE_BLOCKS ? nblocks : AES_PIPE_BLOCKS;
+		n = nblocks*BLOCKLEN < len ? nblocks*BLOCKLEN : len;
+		// 키 스트림 입력: 앞 묶음의 마지막 암호문과 이번 묶음의 암호문
+		memcpy(ks, prev, BLOCKLEN);
+		memcpy(ks + BLOCKLEN, in, (nblocks-1)*BLOCKLEN);
+		if (n == nblocks*BLOCKLEN)
+			memcpy(prev, in + n - BLOCKLEN, BLOCKLEN);
+		EncryptBlocks(ctx, ks, ks, nblocks);
+		for (size_t j = 0; j < n; j++)
+			out[j] = in[j] ^ ks[j];
+		in += n;
+		out += n;
+		len -= n;
+	}
+}
+
+// aes_ofb() - 초기 벡터 iv로 in의 len 바이트를 OFB로 암호화(복호화)한다.
+void aes_ofb(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len)
+{
+	uint8_t ks[BLOCKLEN];
+	size_t n;
+
+	memcpy(ks, iv, BLOCKLEN);
+	for (; len > 0; len -= n){
+		n = len < BLOCKLEN ? len : BLOCKLEN;
+		EncryptBlocks(ctx, ks, ks, 1);
+		for (size_t j = 0; j < n; j++)
+			out[j] = in[j] ^ ks[j];
+		in += n;
+		out += n;
+	}
+}
+
+#ifdef AES_HAVE_AESNI
+/*
+AES-NI 엔진이다. CPUID(EAX=1)의 ECX 25번 비트로 aesenc/aesdec/aeskeygenassist/aesimc 명령어
+지원 여부를 확인하고, 지원하는 경우에만 이 함수들을 호출한다. 함수마다 target("aes")를
+지정했기 때문에 -maes 없이 빌드해도 되고, 지원하지 않는 CPU에서는 실행되지 않는다.
+
+roundKey 워드의 메모리 배치가 키 바이트 순서와 같으므로 __m128i로 그대로 읽고 쓸 수 있다.
+*/
+static int aesni_supported(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+	return (ecx & bit_AES) != 0;
+}
+
+// 프로그램이 시작될 때 AES_ENGINE_AUTO를 실제 엔진으로 바꿔둔다.
+__attribute__((constructor))
+static void aes_select_engine(void)
+{
+	if (aes_engine == AES_ENGINE_AUTO || (aes_engine == AES_ENGINE_AESNI && !aesni_supported()))
+		aes_set_engine(AES_ENGINE_AUTO);
+}
+
+/*
+이전 라운드 키 w[i-Nk, i-Nk+3]와 aeskeygenassist의 결과로 다음 라운드 키 w[i, i+3]를 만든다.
+assist는 네 워드가 모두 SubWord(RotWord(w[i-1])) ^ Rcon (AES-256의 홀수 번째는 SubWord(w[i-1]))
+이 되도록 퍼뜨린 값이고, w[i-Nk]부터 누적 XOR 한 값과 더하면 w[i, i+3]이 된다.
+*/
+__attribute__((target("aes")))
+static inline __m128i KeyExpandStep(__m128i key, __m128i assist)
+{
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, assist);
+}
+
+/*
+aeskeygenassist의 Rcon은 즉시값이어야 하므로 라운드마다 펼쳐 쓴다.
+aeskeygenassist의 3번째 워드는 SubWord(RotWord(X3)) ^ Rcon, 2번째 워드는 SubWord(X3)이다.
+AESNI_EXPAND는 AES-128, AESNI_EXPAND256A/B는 AES-256의 짝수/홀수 번째 라운드 키이다.
+*/
+#define AESNI_EXPAND(i, rcon) \
+	rk[i] = KeyExpandStep(rk[(i)-1], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[(i)-1], rcon), 0xFF))
+#define AESNI_EXPAND256A(i, rcon) \
+	rk[i] = KeyExpandStep(rk[(i)-2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[(i)-1], rcon), 0xFF))
+#define AESNI_EXPAND256B(i) \
+	rk[i] = KeyExpandStep(rk[(i)-2], _mm_shuffle_epi32(_mm_aeskeygenassist_si128(rk[(i)-1], 0x00), 0xAA))
+
+// AES-128(nk = 4)과 AES-256(nk = 8)의 키 확장
+__attribute__((target("aes")))
+static void KeyExpansionAESNI(const uint8_t *key, int nk, uint32_t *roundKey, uint32_t *dRoundKey)
+{
+	__m128i rk[AES_MAXNR+1];
+	int nr = nk + 6;
+
+	rk[0] = _mm_loadu_si128((const __m128i *)key);
+	if (nk == 4){
+		// w[0,3] ~ w[40,43]
+		AESNI_EXPAND(1, 0x01);
+		AESNI_EXPAND(2, 0x02);
+		AESNI_EXPAND(3, 0x04);
+		AESNI_EXPAND(4, 0x08);
+		AESNI_EXPAND(5, 0x10);
+		AESNI_EXPAND(6, 0x20);
+		AESNI_EXPAND(7, 0x40);
+		AESNI_EXPAND(8, 0x80);
+		AESNI_EXPAND(9, 0x1b);
+		AESNI_EXPAND(10, 0x36);
+	}
+	else {
+		// w[0,7] ~ w[56,59]
+		rk[1] = _mm_loadu_si128((const __m128i *)(key + 16));
+		AESNI_EXPAND256A(2, 0x01);
+		AESNI_EXPAND256B(3);
+		AESNI_EXPAND256A(4, 0x02);
+		AESNI_EXPAND256B(5);
+		AESNI_EXPAND256A(6, 0x04);
+		AESNI_EXPAND256B(7);
+		AESNI_EXPAND256A(8, 0x08);
+		AESNI_EXPAND256B(9);
+		AESNI_EXPAND256A(10, 0x10);
+		AESNI_EXPAND256B(11);
+		AESNI_EXPAND256A(12, 0x20);
+		AESNI_EXPAND256B(13);
+		AESNI_EXPAND256A(14, 0x40);
+	}
+
+	// 복호화용 roundKey는 1 ~ nr-1 라운드 키에 aesimc(InvMixColumns)를 적용한 것이다.
+	for (int i = 0; i <= nr; i++)
+		_mm_storeu_si128((__m128i *)(roundKey + i*Nb), rk[i]);
+	_mm_storeu_si128((__m128i *)dRoundKey, rk[0]);
+	for (int i = 1; i < nr; i++)
+		_mm_storeu_si128((__m128i *)(dRoundKey + i*Nb), _mm_aesimc_si128(rk[i]));
+	_mm_storeu_si128((__m128i *)(dRoundKey + nr*Nb), rk[nr]);
+}
+
+/*
+aesenc 한 번이 SubBytes -> ShiftRows -> MixColumns -> AddRoundKey 한 라운드이다.
+라운드는 모두 펼쳐 두었고, AES-128의 10라운드를 먼저 두고 AES-192, AES-256에서만
+늘어나는 라운드를 분기로 끼워 넣어 128비트 경로에는 반복문 비용이 없다.
+*/
+#define AESENC(i) m = _mm_aesenc_si128(m, _mm_loadu_si128(rk + (i)))
+#define AESDEC(i) m = _mm_aesdec_si128(m, _mm_loadu_si128(rk + (i)))
+
+__attribute__((target("aes")))
+static void CipherAESNI(uint8_t *state, const uint32_t *roundKey, int nr)
+{
+	const __m128i *rk = (const __m128i *)roundKey;
+	__m128i m;
+
+	m = _mm_xor_si128(_mm_loadu_si128((const __m128i *)state), _mm_loadu_si128(rk));
+	AESENC(1); AESENC(2); AESENC(3); AESENC(4); AESENC(5);
+	AESENC(6); AESENC(7); AESENC(8); AESENC(9);
+	if (nr > 10){
+		AESENC(10); AESENC(11);
+		if (nr > 12){
+			AESENC(12); AESENC(13);
+		}
+	}
+	m = _mm_aesenclast_si128(m, _mm_loadu_si128(rk + nr));
+	_mm_storeu_si128((__m128i *)state, m);
+}
+
+// aesdec는 동등 역암호의 한 라운드이므로 droundKey를 그대로 사용한다.
+__attribute__((target("aes")))
+static void InvCipherAESNI(uint8_t *state, const uint32_t *dRoundKey, int nr)
+{
+	const __m128i *rk = (const __m128i *)dRoundKey;
+	__m128i m;
+
+	m = _mm_xor_si128(_mm_loadu_si128((const __m128i *)state), _mm_loadu_si128(rk + nr));
+	if (nr > 12){
+		AESDEC(13); AESDEC(12);
+	}
+	if (nr > 10){
+		AESDEC(11); AESDEC(10);
+	}
+	AESDEC(9); AESDEC(8); AESDEC(7); AESDEC(6); AESDEC(5);
+	AESDEC(4); AESDEC(3); AESDEC(2); AESDEC(1);
+	m = _mm_aesdeclast_si128(m, _mm_loadu_si128(rk));
+	_mm_storeu_si128((__m128i *)state, m);
+}
+
+// 카운터 (hi, lo)를 빅 엔디안 카운터 블록으로 만든다.
+static inline __m128i CounterBlock(uint64_t hi, uint64_t lo)
+{
+	return _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)__builtin_bswap64(hi));
+}
+
+/*
+CTR 모드의 AES-NI 구현이다. 카운터 블록 AES_CTR_BLOCKS(8)개를 만든 다음 라운드 키 하나를 읽을
+때마다 8개 블록에 aesenc를 차례로 적용한다. 서로 의존하지 않는 aesenc가 이어지므로 한 블록의
+aesenc 지연 시간 동안 나머지 블록이 처리된다. 8개보다 적게 남은 블록은 하나씩 처리한다.
+*/
+__attribute__((target("aes")))
+static void CtrAESNI(const uint32_t *roundKey, int nr, uint64_t hi, uint64_t lo, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	const __m128i *rk = (const __m128i *)roundKey;
+	__m128i b[AES_CTR_BLOCKS], k;
+	int i, j;
+
+	while (nblocks >= AES_CTR_BLOCKS){
+		k = _mm_loadu_si128(rk);
+		for (j = 0; j < AES_CTR_BLOCKS; j++){
+			b[j] = _mm_xor_si128(CounterBlock(hi, lo), k);
+			if (++lo == 0)
+				++hi;
+		}
+		for (i = 1; i < nr; i++){
+			k = _mm_loadu_si128(rk + i);
+			for (j = 0; j < AES_CTR_BLOCKS; j++)
+				b[j] = _mm_aesenc_si128(b[j], k);
+		}
+		k = _mm_loadu_si128(rk + nr);
+		for (j = 0; j < AES_CTR_BLOCKS; j++){
+			b[j] = _mm_aesenclast_si128(b[j], k);
+			b[j] = _mm_xor_si128(b[j], _mm_loadu_si128((const __m128i *)(in + j*BLOCKLEN)));
+			_mm_storeu_si128((__m128i *)(out + j*BLOCKLEN), b[j]);
+		}
+		in += AES_CTR_BLOCKS*BLOCKLEN;
+		out += AES_CTR_BLOCKS*BLOCKLEN;
+		nblocks -= AES_CTR_BLOCKS;
+	}
+	while (nblocks > 0){
+		__m128i m = _mm_xor_si128(CounterBlock(hi, lo), _mm_loadu_si128(rk));
+		if (++lo == 0)
+			++hi;
+		for (i = 1; i < nr; i++)
+			m = _mm_aesenc_si128(m, _mm_loadu_si128(rk + i));
+		m = _mm_aesenclast_si128(m, _mm_loadu_si128(rk + nr));
+		m = _mm_xor_si128(m, _mm_loadu_si128((const __m128i *)in));
+		_mm_storeu_si128((__m128i *)out, m);
+		in += BLOCKLEN;
+		out += BLOCKLEN;
+		nblocks--;
+	}
+}
+
+/*
+여러 블록의 ECB 암호화/복호화이다. CTR과 같이 AES_PIPE_BLOCKS(8)개 블록의 aesenc(aesdec)를
+라운드마다 번갈아 실행한다. ECB와 CBC/CFB 복호화가 이 함수로 여러 블록을 한꺼번에 처리한다.
+*/
+__attribute__((target("aes")))
+static void EncryptBlocksAESNI(const uint32_t *roundKey, int nr, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	const __m128i *rk = (const __m128i *)roundKey;
+	__m128i b[AES_PIPE_BLOCKS], k;
+	size_t n, j;
+	int i;
+
+	for (; nblocks > 0; nblocks -= n){
+		n = nblocks < AES_PIPE_BLOCKS ? nblocks : AES_PIPE_BLOCKS;
+		k = _mm_loadu_si128(rk);
+		for (j = 0; j < n; j++)
+			b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + j*BLOCKLEN)), k);
+		for (i = 1; i < nr; i++){
+			k = _mm_loadu_si128(rk + i);
+			for (j = 0; j < n; j++)
+				b[j] = _mm_aesenc_si128(b[j], k);
+		}
+		k = _mm_loadu_si128(rk + nr);
+		for (j = 0; j < n; j++)
+			_mm_storeu_si128((__m128i *)(out + j*BLOCKLEN), _mm_aesenclast_si128(b[j], k));
+		in += n*BLOCKLEN;
+		out += n*BLOCKLEN;
+	}
+}
+
+__attribute__((target("aes")))
+static void DecryptBlocksAESNI(const uint32_t *dRoundKey, int nr, const uint8_t *in, uint8_t *out, size_t nblocks)
+{
+	const __m128i *rk = (const __m128i *)dRoundKey;
+	__m128i b[AES_PIPE_BLOCKS], k;
+	size_t n, j;
+	int i;
+
+	for (; nblocks > 0; nblocks -= n){
+		n = nblocks < AES_PIPE_BLOCKS ? nblocks : AES_PIPE_BLOCKS;
+		k = _mm_loadu_si128(rk + nr);
+		for (j = 0; j < n; j++)
+			b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + j*BLOCKLEN)), k);
+		for (i = nr - 1; i > 0; i--){
+			k = _mm_loadu_si128(rk + i);
+			for (j = 0; j < n; j++)
+				b[j] = _mm_aesdec_si128(b[j], k);
+		}
+		k = _mm_loadu_si128(rk);
+		for (j = 0; j < n; j++)
+			_mm_storeu_si128((__m128i *)(out + j*BLOCKLEN), _mm_aesdeclast_si128(b[j], k));
+		in += n*BLOCKLEN;
+		out += n*BLOCKLEN;
+	}
+}
+#endif
+
+// 리틀 엔디안 32비트 워드 읽기/쓰기 (roundKey와 같은 배치)
+static inline uint32_t load32(const uint8_t *p)
+{
+	uint32_t w;
+	memcpy(&w, p, sizeof(uint32_t));
+	return w;
+}
+
+static inline void store32(uint8_t *p, uint32_t w)
+{
+	memcpy(p, &w, sizeof(uint32_t));
+}
+
+/*
+T-table 엔진의 암호화이다. state를 4개의 열 워드 s0..s3로 읽고, 라운드마다 각 열의 출력을
+ShiftRows가 가져오는 4개의 바이트로 Te0..Te3을 조회해 XOR 한 다음 라운드 키를 더한다.
+열 j의 r행은 ShiftRows 후 열 (j+r) mod 4에서 오므로 Te_r에는 s_(j+r)의 r번째 바이트가 들어간다.
+마지막 라운드는 MixColumns가 없으므로 sbox를 직접 조회해서 바이트를 다시 모은다.
+temKey 복사 없이 roundKey를 포인터로 바로 읽는다.
+
+TE_ROUND(b, a, r)는 a0..a3에 r 라운드를 적용해서 b0..b3에 넣는다. 라운드는 s와 t를 번갈아
+쓰면서 모두 펼쳐 두었고, AES-192, AES-256에서 늘어나는 라운드만 분기로 끼워 넣는다.
+중간 라운드 수(nr-1)는 키 길이와 상관없이 홀수이므로 마지막 라운드의 입력은 항상 t이다.
+*/
+#define TE_ROUND(b, a, r) do { \
+	b##0 = Te0[a##0 & 0xFF] ^ Te1[(a##1 >> 8) & 0xFF] ^ Te2[(a##2 >> 16) & 0xFF] ^ Te3[a##3 >> 24] ^ rk[(r)*Nb+0]; \
+	b##1 = Te0[a##1 & 0xFF] ^ Te1[(a##2 >> 8) & 0xFF] ^ Te2[(a##3 >> 16) & 0xFF] ^ Te3[a##0 >> 24] ^ rk[(r)*Nb+1]; \
+	b##2 = Te0[a##2 & 0xFF] ^ Te1[(a##3 >> 8) & 0xFF] ^ Te2[(a##0 >> 16) & 0xFF] ^ Te3[a##1 >> 24] ^ rk[(r)*Nb+2]; \
+	b##3 = Te0[a##3 & 0xFF] ^ Te1[(a##0 >> 8) & 0xFF] ^ Te2[(a##1 >> 16) & 0xFF] ^ Te3[a##2 >> 24] ^ rk[(r)*Nb+3]; \
+} while (0)
+
+static void CipherTTable(uint8_t *state, const uint32_t *rk, int nr)
+{
+	uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+
+	// w[0,3]
+	s0 = load32(state +  0) ^ rk[0];
+	s1 = load32(state +  4) ^ rk[1];
+	s2 = load32(state +  8) ^ rk[2];
+	s3 = load32(state + 12) ^ rk[3];
+
+	// 1 ~ nr-1 라운드
+	TE_ROUND(t, s, 1); TE_ROUND(s, t, 2); TE_ROUND(t, s, 3);
+	TE_ROUND(s, t, 4); TE_ROUND(t, s, 5); TE_ROUND(s, t, 6);
+	TE_ROUND(t, s, 7); TE_ROUND(s, t, 8); TE_ROUND(t, s, 9);
+	if (nr > 10){
+		TE_ROUND(s, t, 10); TE_ROUND(t, s, 11);
+		if (nr > 12){
+			TE_ROUND(s, t, 12); TE_ROUND(t, s, 13);
+		}
+	}
+
+	// nr 라운드 -> SubBytes, ShiftRows, AddRoundKey
+	rk += nr*Nb;
+	s0 = ((uint32_t)sbox[t0 & 0xFF]) ^ ((uint32_t)sbox[(t1 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)sbox[(t2 >> 16) & 0xFF] << 16) ^ ((uint32_t)sbox[t3 >> 24] << 24) ^ rk[0];
+	s1 = ((uint32_t)sbox[t1 & 0xFF]) ^ ((uint32_t)sbox[(t2 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)sbox[(t3 >> 16) & 0xFF] << 16) ^ ((uint32_t)sbox[t0 >> 24] << 24) ^ rk[1];
+	s2 = ((uint32_t)sbox[t2 & 0xFF]) ^ ((uint32_t)sbox[(t3 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)sbox[(t0 >> 16) & 0xFF] << 16) ^ ((uint32_t)sbox[t1 >> 24] << 24) ^ rk[2];
+	s3 = ((uint32_t)sbox[t3 & 0xFF]) ^ ((uint32_t)sbox[(t0 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)sbox[(t1 >> 16) & 0xFF] << 16) ^ ((uint32_t)sbox[t2 >> 24] << 24) ^ rk[3];
+
+	store32(state +  0, s0);
+	store32(state +  4, s1);
+	store32(state +  8, s2);
+	store32(state + 12, s3);
+}
+
+/*
+T-table 엔진의 복호화이다. 기존 복호화와 같이 droundKey를 사용하는 동등 역암호 구조이므로
+연산 순서는 암호화와 같고, InvShiftRows 때문에 열 j의 r행은 열 (j-r) mod 4에서 가져온다.
+AES-192, AES-256에서 늘어나는 라운드는 droundKey의 뒤쪽이므로 복호화에서는 먼저 수행한다.
+*/
+#define TD_ROUND(b, a, r) do { \
+	b##0 = Td0[a##0 & 0xFF] ^ Td1[(a##3 >> 8) & 0xFF] ^ Td2[(a##2 >> 16) & 0xFF] ^ Td3[a##1 >> 24] ^ rk[(r)*Nb+0]; \
+	b##1 = Td0[a##1 & 0xFF] ^ Td1[(a##0 >> 8) & 0xFF] ^ Td2[(a##3 >> 16) & 0xFF] ^ Td3[a##2 >> 24] ^ rk[(r)*Nb+1]; \
+	b##2 = Td0[a##2 & 0xFF] ^ Td1[(a##1 >> 8) & 0xFF] ^ Td2[(a##0 >> 16) & 0xFF] ^ Td3[a##3 >> 24] ^ rk[(r)*Nb+2]; \
+	b##3 = Td0[a##3 & 0xFF] ^ Td1[(a##2 >> 8) & 0xFF] ^ Td2[(a##1 >> 16) & 0xFF] ^ Td3[a##0 >> 24] ^ rk[(r)*Nb+3]; \
+} while (0)
+
+static void InvCipherTTable(uint8_t *state, const uint32_t *rk, int nr)
+{
+	uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+
+	// dw[nr*Nb, nr*Nb+3]
+	s0 = load32(state +  0) ^ rk[nr*Nb+0];
+	s1 = load32(state +  4) ^ rk[nr*Nb+1];
+	s2 = load32(state +  8) ^ rk[nr*Nb+2];
+	s3 = load32(state + 12) ^ rk[nr*Nb+3];
+
+	// nr-1 ~ 1 라운드
+	if (nr > 12){
+		TD_ROUND(t, s, 13); TD_ROUND(s, t, 12);
+	}
+	if (nr > 10){
+		TD_ROUND(t, s, 11); TD_ROUND(s, t, 10);
+	}
+	TD_ROUND(t, s, 9); TD_ROUND(s, t, 8); TD_ROUND(t, s, 7);
+	TD_ROUND(s, t, 6); TD_ROUND(t, s, 5); TD_ROUND(s, t, 4);
+	TD_ROUND(t, s, 3); TD_ROUND(s, t, 2); TD_ROUND(t, s, 1);
+
+	// dw[0,3] -> InvSubBytes, InvShiftRows, AddRoundKey
+	s0 = ((uint32_t)isbox[t0 & 0xFF]) ^ ((uint32_t)isbox[(t3 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)isbox[(t2 >> 16) & 0xFF] << 16) ^ ((uint32_t)isbox[t1 >> 24] << 24) ^ rk[0];
+	s1 = ((uint32_t)isbox[t1 & 0xFF]) ^ ((uint32_t)isbox[(t0 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)isbox[(t3 >> 16) & 0xFF] << 16) ^ ((uint32_t)isbox[t2 >> 24] << 24) ^ rk[1];
+	s2 = ((uint32_t)isbox[t2 & 0xFF]) ^ ((uint32_t)isbox[(t1 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)isbox[(t0 >> 16) & 0xFF] << 16) ^ ((uint32_t)isbox[t3 >> 24] << 24) ^ rk[2];
+	s3 = ((uint32_t)isbox[t3 & 0xFF]) ^ ((uint32_t)isbox[(t2 >> 8) & 0xFF] << 8) ^
+	     ((uint32_t)isbox[(t1 >> 16) & 0xFF] << 16) ^ ((uint32_t)isbox[t0 >> 24] << 24) ^ rk[3];
+
+	store32(state +  0, s0);
+	store32(state +  4, s1);
+	store32(state +  8, s2);
+	store32(state + 12, s3);
+}
+
+#ifdef AES_HAVE_BITSLICE
+/*
+비트 슬라이스 엔진이다. 8개의 블록을 비트 단위로 다시 배치해서 "비트 b" 평면 8개로 만들고,
+SubBytes를 포함한 모든 라운드 연산을 평면에 대한 AND, XOR, 시프트만으로 계산한다.
+비밀 값으로 테이블을 조회하거나 분기하지 않고, 이 엔진의 문맥은 키 확장도 BsSubWord()와
+테이블 없는 InvMixColumn()으로 계산한다.
+
+평면 하나는 128비트(32비트 4개)이고, r번째 32비트에는 state의 r행이 들어간다.
+그 안에서 8*c + k번째 비트가 k번째 블록의 state[4*c + r]의 비트 b이다. 이렇게 두면
+ - ShiftRows는 r번째 32비트를 8*r비트 회전하는 것이고,
+ - MixColumns의 "한 행 아래" 는 32비트 단위의 자리 바꿈(pshufd)이다.
+GCC 벡터 확장을 사용하므로 x86-64에서는 SSE2 레지스터로, 다른 CPU에서는 그 CPU의 벡터
+레지스터나 64비트 연산으로 컴파일된다.
+
+SubBytes는 Boyar-Peralta의 113 게이트 회로로 계산하고, InvSubBytes는 앞뒤에 역아핀 변환을
+붙여 같은 회로를 재사용한다.
+*/
+typedef uint32_t bs_t __attribute__((vector_size(16)));
+
+// 8x8 비트 행렬 전치: x의 i번째 바이트의 j번째 비트 <-> j번째 바이트의 i번째 비트
+static inline uint64_t Transpose8(uint64_t x)
+{
+	uint64_t t;
+
+	t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+	x ^= t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+	x ^= t ^ (t << 14);
+	t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+	x ^= t ^ (t << 28);
+	return x;
+}
+
+// n(8 이하)개의 블록을 비트 평면 8개로 바꾼다. 모자라는 블록은 0으로 채운다.
+static void BsPack(bs_t *s, const uint8_t *in, size_t n)
+{
+	uint32_t w[8][4] = {{0}};
+	uint64_t x;
+
+	for (int pos = 0; pos < BLOCKLEN; pos++){
+		x = 0;
+		for (size_t k = 0; k < n; k++)
+			x |= (uint64_t)in[k*BLOCKLEN + pos] << (8*k);
+		x = Transpose8(x);
+		for (int b = 0; b < 8; b++)
+			w[b][pos & 3] |= (uint32_t)((x >> (8*b)) & 0xFF) << (8*(pos >> 2));
+	}
+	for (int b = 0; b < 8; b++)
+		s[b] = (bs_t){w[b][0], w[b][1], w[b][2], w[b][3]};
+}
+
+static void BsUnpack(const bs_t *s, uint8_t *out, size_t n)
+{
+	uint64_t x;
+
+	for (int pos = 0; pos < BLOCKLEN; pos++){
+		x = 0;
+		for (int b = 0; b < 8; b++)
+			x |= (uint64_t)((s[b][pos & 3] >> (8*(pos >> 2))) & 0xFF) << (8*b);
+		x = Transpose8(x);
+		for (size_t k = 0; k < n; k++)
+			out[k*BLOCKLEN + pos] = (uint8_t)(x >> (8*k));
+	}
+}
+
+/*
+라운드 키를 8개 블록 모두에 같은 값이 들어간 비트 평면으로 바꾼다. 라운드마다 평면 8개 *
+32비트 4개 = 32워드이다. 키 비트로 분기하지 않도록 마스크로 0x00 또는 0xFF를 만든다.
+*/
+static void BsKey(const uint32_t *rk, int nr, uint32_t *bk)
+{
+	const uint8_t *p;
+	uint32_t *w;
+
+	for (int i = 0; i <= nr; i++){
+		p = (const uint8_t *)(rk + i*Nb);
+		w = bk + i*32;
+		memset(w, 0, 32*sizeof(uint32_t));
+		for (int pos = 0; pos < BLOCKLEN; pos++)
+			for (int b = 0; b < 8; b++)
+				w[b*4 + (pos & 3)] |= ((0u - ((p[pos] >> b) & 1)) & 0xFF) << (8*(pos >> 2));
+	}
+}
+
+static inline void BsAddRoundKey(bs_t *s, const uint32_t *w)
+{
+	bs_t k;
+
+	for (int b = 0; b < 8; b++){
+		memcpy(&k, w + b*4, sizeof(bs_t));
+		s[b] ^= k;
+	}
+}
+
+/*
+SubBytes: Boyar-Peralta의 S-box 회로(XOR/XNOR 83개, AND 32개)를 그대로 평면에 적용한다.
+회로의 입력 x0 ~ x7은 바이트의 최상위 비트부터이므로 s[7] ~ s[0]이고, 출력 s0 ~ s7도 같다.
+*/
+static void BsSubBytes(bs_t *s)
+{
+	bs_t x0, x1, x2, x3, x4, x5, x6, x7;
+	bs_t y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+	bs_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19,
+	     t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39,
+	     t40, t41, t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59,
+	     t60, t61, t62, t63, t64, t65, t66, t67;
+	bs_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+	bs_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+	x0 = s[7]; x1 = s[6]; x2 = s[5]; x3 = s[4];
+	x4 = s[3]; x5 = s[2]; x6 = s[1]; x7 = s[0];
+
+	// 위쪽 선형 층
+	y14 = x3 ^ x5;
+	y13 = x0 ^ x6;
+	y9 = x0 ^ x3;
+	y8 = x0 ^ x5;
+	t0 = x1 ^ x2;
+	y1 = t0 ^ x7;
+	y4 = y1 ^ x3;
+	y12 = y13 ^ y14;
+	y2 = y1 ^ x0;
+	y5 = y1 ^ x6;
+	y3 = y5 ^ y8;
+	t1 = x4 ^ y12;
+	y15 = t1 ^ x5;
+	y20 = t1 ^ x1;
+	y6 = y15 ^ x7;
+	y10 = y15 ^ t0;
+	y11 = y20 ^ y9;
+	y7 = x7 ^ y11;
+	y17 = y10 ^ y11;
+	y19 = y10 ^ y8;
+	y16 = t0 ^ y11;
+	y21 = y13 ^ y16;
+	y18 = x0 ^ y16;
+
+	// 비선형 층 (GF(2^4)로 내려가서 역원을 구한다)
+	t2 = y12 & y15;
+	t3 = y3 & y6;
+	t4 = t3 ^ t2;
+	t5 = y4 & x7;
+	t6 = t5 ^ t2;
+	t7 = y13 & y16;
+	t8 = y5 & y1;
+	t9 = t8 ^ t7;
+	t10 = y2 & y7;
+	t11 = t10 ^ t7;
+	t12 = y9 & y11;
+	t13 = y14 & y17;
+	t14 = t13 ^ t12;
+	t15 = y8 & y10;
+	t16 = t15 ^ t12;
+	t17 = t4 ^ t14;
+	t18 = t6 ^ t16;
+	t19 = t9 ^ t14;
+	t20 = t11 ^ t16;
+	t21 = t17 ^ y20;
+	t22 = t18 ^ y19;
+	t23 = t19 ^ y21;
+	t24 = t20 ^ y18;
+	t25 = t21 ^ t22;
+	t26 = t21 & t23;
+	t27 = t24 ^ t26;
+	t28 = t25 & t27;
+	t29 = t28 ^ t22;
+	t30 = t23 ^ t24;
+	t31 = t22 ^ t26;
+	t32 = t31 & t30;
+	t33 = t32 ^ t24;
+	t34 = t23 ^ t33;
+	t35 = t27 ^ t33;
+	t36 = t24 & t35;
+	t37 = t36 ^ t34;
+	t38 = t27 ^ t36;
+	t39 = t29 & t38;
+	t40 = t25 ^ t39;
+	t41 = t40 ^ t37;
+	t42 = t29 ^ t33;
+	t43 = t29 ^ t40;
+	t44 = t33 ^ t37;
+	t45 = t42 ^ t41;
+	z0 = t44 & y15;
+	z1 = t37 & y6;
+	z2 = t33 & x7;
+	z3 = t43 & y16;
+	z4 = t40 & y1;
+	z5 = t29 & y7;
+	z6 = t42 & y11;
+	z7 = t45 & y17;
+	z8 = t41 & y10;
+	z9 = t44 & y12;
+	z10 = t37 & y3;
+	z11 = t33 & y4;
+	z12 = t43 & y13;
+	z13 = t40 & y5;
+	z14 = t29 & y2;
+	z15 = t42 & y9;
+	z16 = t45 & y14;
+	z17 = t41 & y8;
+
+	// 아래쪽 선형 층 (아핀 변환 포함)
+	t46 = z15 ^ z16;
+	t47 = z10 ^ z11;
+	t48 = z5 ^ z13;
+	t49 = z9 ^ z10;
+	t50 = z2 ^ z12;
+	t51 = z2 ^ z5;
+	t52 = z7 ^ z8;
+	t53 = z0 ^ z3;
+	t54 = z6 ^ z7;
+	t55 = z16 ^ z17;
+	t56 = z12 ^ t48;
+	t57 = t50 ^ t53;
+	t58 = z4 ^ t46;
+	t59 = z3 ^ t54;
+	t60 = t46 ^ t57;
+	t61 = z14 ^ t57;
+	t62 = t52 ^ t58;
+	t63 = t49 ^ t58;
+	t64 = z4 ^ t59;
+	t65 = t61 ^ t62;
+	t66 = z1 ^ t63;
+	s0 = t59 ^ t63;
+	s6 = t56 ^ ~t62;
+	s7 = t48 ^ ~t60;
+	t67 = t64 ^ t65;
+	s3 = t53 ^ t66;
+	s4 = t51 ^ t66;
+	s5 = t47 ^ t65;
+	s1 = t64 ^ ~s3;
+	s2 = t55 ^ ~t67;
+
+	s[7] = s0; s[6] = s1; s[5] = s2; s[4] = s3;
+	s[3] = s4; s[2] = s5; s[1] = s6; s[0] = s7;
+}
+
+// 역아핀 변환 a_i = b_(i+2) ^ b_(i+5) ^ b_(i+7) ^ 0x05_i
+static inline void BsInvAffine(bs_t *s)
+{
+	bs_t t[8];
+
+	for (int i = 0; i < 8; i++)
+		t[i] = s[(i+2) & 7] ^ s[(i+5) & 7] ^ s[(i+7) & 7];
+	t[0] = ~t[0];
+	t[2] = ~t[2];
+	for (int i = 0; i < 8; i++)
+		s[i] = t[i];
+}
+
+/*
+InvSubBytes: S-box가 S(x) = A(x^-1)이므로 x^-1 = A^-1(S(x)) 이다. 따라서
+InvS(y) = A^-1(y)^-1 = A^-1(S(A^-1(y))) 이고, 역원 회로를 따로 두지 않고 SubBytes 회로를 재사용한다.
+*/
+static void BsInvSubBytes(bs_t *s)
+{
+	BsInvAffine(s);
+	BsSubBytes(s);
+	BsInvAffine(s);
+}
+
+/*
+키 확장용 SubWord이다. 네 바이트를 평면의 32비트 네 칸에 한 비트씩 넣고 SubBytes 회로를 통과시킨
+다음 각 칸의 최하위 비트만 다시 모은다. 회로는 비트 단위 연산뿐이라 최하위 비트는 최하위 비트끼리만
+계산되고, XNOR이 나머지 비트를 1로 바꿔도 결과에는 영향이 없다. sbox를 조회하는 SubWord보다 느리지만 키 확장은
+aes_init()에서 한 번만 하므로 비용이 크지 않다.
+*/
+static uint32_t BsSubWord(uint32_t w)
+{
+	bs_t s[8];
+	uint32_t r = 0;
+
+	for (int b = 0; b < 8; b++)
+		s[b] = (bs_t){(w >> b) & 1, (w >> (8 + b)) & 1, (w >> (16 + b)) & 1, (w >> (24 + b)) & 1};
+	BsSubBytes(s);
+	for (int b = 0; b < 8; b++)
+		for (int j = 0; j < 4; j++)
+			r |= (s[b][j] & 1) << (8*j + b);
+	return r;
+}
+
+// r행을 왼쪽으로 r칸 -> r번째 32비트를 8*r비트 오른쪽으로 회전 (0행은 그대로)
+static inline void BsShiftRows(bs_t *s)
+{
+	const bs_t sr = {0, 8, 16, 24}, sl = {0, 24, 16, 8};
+
+	for (int b = 0; b < 8; b++)
+		s[b] = (s[b] >> sr) | (s[b] << sl);
+}
+
+static inline void BsInvShiftRows(bs_t *s)
+{
+	const bs_t sr = {0, 8, 16, 24}, sl = {0, 24, 16, 8};
+
+	for (int b = 0; b < 8; b++)
+		s[b] = (s[b] << sr) | (s[b] >> sl);
+}
+
+// 평면마다 r행에 (r+1)행, (r+2)행을 가져온다.
+#define BS_ROT1(x) __builtin_shuffle((x), (bs_t){1, 2, 3, 0})
+#define BS_ROT2(x) __builtin_shuffle((x), (bs_t){2, 3, 0, 1})
+
+// 평면 단위의 XTIME
+static inline void BsXtime(bs_t *c, const bs_t *a)
+{
+	bs_t t[8];
+
+	t[0] = a[7];
+	t[1] = a[0] ^ a[7];
+	t[2] = a[1];
+	t[3] = a[2] ^ a[7];
+	t[4] = a[3] ^ a[7];
+	t[5] = a[4];
+	t[6] = a[5];
+	t[7] = a[6];
+	for (int i = 0; i < 8; i++)
+		c[i] = t[i];
+}
+
+// b_r = 2*(a_r ^ a_(r+1)) ^ a_(r+1) ^ (a_(r+2) ^ a_(r+3))
+static void BsMixColumns(bs_t *s)
+{
+	bs_t r1[8], t[8];
+
+	for (int b = 0; b < 8; b++){
+		r1[b] = BS_ROT1(s[b]);
+		t[b] = s[b] ^ r1[b];
+	}
+	for (int b = 0; b < 8; b++)
+		s[b] = r1[b] ^ BS_ROT2(t[b]);
+	BsXtime(t, t);
+	for (int b = 0; b < 8; b++)
+		s[b] ^= t[b];
+}
+
+/*
+InvMixColumns 행렬은 MixColumns 행렬과 {05, 00, 04, 00} 순환 행렬의 곱이므로
+u_r = a_r ^ 4*(a_r ^ a_(r+2)) 를 만든 다음 MixColumns를 적용한다.
+*/
+static void BsInvMixColumns(bs_t *s)
+{
+	bs_t t[8];
+
+	for (int b = 0; b < 8; b++)
+		t[b] = s[b] ^ BS_ROT2(s[b]);
+	BsXtime(t, t);
+	BsXtime(t, t);
+	for (int b = 0; b < 8; b++)
+		s[b] ^= t[b];
+	BsMixColumns(s);
+}
+
+// n(8 이하)개의 블록을 비트 슬라이스 라운드 키 bk로 암호화한다.
+static void BsEncrypt(const uint32_t *bk, int nr, const uint8_t *in, uint8_t *out, size_t n)
+{
+	bs_t s[8];
+
+	BsPack(s, in, n);
+	BsAddRoundKey(s, bk);
+	for (int i = 1; i < nr; i++){
+		BsSubBytes(s);
+		BsShiftRows(s);
+		BsMixColumns(s);
+		BsAddRoundKey(s, bk + i*32);
+	}
+	BsSubBytes(s);
+	BsShiftRows(s);
+	BsAddRoundKey(s, bk + nr*32);
+	BsUnpack(s, out, n);
+}
+
+// droundKey를 바꾼 bk로 동등 역암호 순서로 복호화한다.
+static void BsDecrypt(const uint32_t *bk, int nr, const uint8_t *in, uint8_t *out, size_t n)
+{
+	bs_t s[8];
+
+	BsPack(s, in, n);
+	BsAddRoundKey(s, bk + nr*32);
+	for (int i = nr - 1; i > 0; i--){
+		BsInvSubBytes(s);
+		BsInvShiftRows(s);
+		BsInvMixColumns(s);
+		BsAddRoundKey(s, bk + i*32);
+	}
+	BsInvSubBytes(s);
+	BsInvShiftRows(s);
+	BsAddRoundKey(s, bk);
+	BsUnpack(s, out, n);
+}
+#endif
+
 /*
 현재 state의 열 부분과, roundKey를 XOR 연산을 해주는 함수이다. roundKey에 대한 인덱스 접근
 을 편하게 하기 위해, for문을 Nb만큼만 돌리고, state는 4줄을 써주었다. 또한 보기 좋게 작성함
@@ -381,66 +2159,18 @@ uint8_t Mul(uint8_t a, uint8_t b){
 }
 
 /*
-문서의 연산에 맞게 다항식 곱셈을 이용하면 쉽게 해결이 가능하다.
-코드는 먼저 uint8_t tem[BLOCKLEN];으로 임시 배열을 만들어주고
-memcpy(tem, state, sizeof(uint8_t)*BLOCKLEN); 로 기존 state를 복사해준다. 그리고
-아까처럼 Nb만큼 반복을 통해 state의 0,1,2,3 | 4,5,6,7 | 8,9,10,11 에 접근해서 연산을 진행해주면 된다
+처음에는 Mul()로 행렬 곱셈을 그대로 계산했지만 (열마다 Mul 16번, Mul 안에서 비트마다 분기)
+지금은 열 하나를 32비트 워드로 읽어서 MixColumn()/InvMixColumn()으로 한 번에 계산한다.
 */
 // 기약 다항식 x^8 + x^4 + x^3 + x + 1을 사용한 GF(2^8)에서 행렬 곱셈을
 // 수행한다. mode가 DECRYPT면 역행렬을 곱한다.
 void MixColumns(uint8_t *state, int mode){
-	// state대신 연산에 사용될 tem
-	uint8_t tem[BLOCKLEN];
-	// 복사
-	memcpy(tem, state, sizeof(uint8_t)*BLOCKLEN);
+	uint32_t w;
 
-	// 암호화 (행렬 M 이용)
-	if (mode == ENCRYPT){
-		for (int i = 0; i < Nb; i++){
-			state[0+i*4] = Mul(tem[0+i*4], M[0]) ^ 
-						   Mul(tem[1+i*4], M[1]) ^
-						   tem[2+i*4] ^
-						   tem[3+i*4];
-
-			state[1+i*4] = tem[0+i*4] ^
-						   Mul(tem[1+i*4], M[5]) ^
-						   Mul(tem[2+i*4], M[6]) ^
-						   tem[3+i*4];
-
-			state[2+i*4] = tem[0+i*4] ^
-						   tem[1+i*4] ^
-						   Mul(tem[2+i*4], M[10]) ^
-						   Mul(tem[3+i*4], M[11]);
-
-			state[3+i*4] = Mul(tem[0+i*4], M[12]) ^
-						   tem[1+i*4] ^
-						   tem[2+i*4] ^
-						   Mul(tem[3+i*4], M[15]);	
-		}
-	}
-	// 복호화 (역행렬 IM 이용)
-	else if (mode == DECRYPT){
-		for (int i = 0; i < Nb; i++){
-			state[0+i*4] = Mul(tem[0+i*4], IM[0]) ^
-						   Mul(tem[1+i*4], IM[1]) ^
-						   Mul(tem[2+i*4], IM[2]) ^
-						   Mul(tem[3+i*4], IM[3]);
-
-			state[1+i*4] = Mul(tem[0+i*4], IM[4]) ^
-						   Mul(tem[1+i*4], IM[5]) ^
-						   Mul(tem[2+i*4], IM[6]) ^
-						   Mul(tem[3+i*4], IM[7]);
-
-			state[2+i*4] = Mul(tem[0+i*4], IM[8]) ^
-						   Mul(tem[1+i*4], IM[9]) ^
-						   Mul(tem[2+i*4], IM[10]) ^
-						   Mul(tem[3+i*4], IM[11]);
-
-			state[3+i*4] = Mul(tem[0+i*4], IM[12]) ^
-						   Mul(tem[1+i*4], IM[13]) ^
-						   Mul(tem[2+i*4], IM[14]) ^
-						   Mul(tem[3+i*4], IM[15]);
-		}
+	for (int i = 0; i < Nb; i++){
+		memcpy(&w, state + i*4, sizeof(uint32_t));
+		w = (mode == ENCRYPT) ? MixColumn(w) : InvMixColumn(w);
+		memcpy(state + i*4, &w, sizeof(uint32_t));
 	}
 }
 
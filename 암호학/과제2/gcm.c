@@ -0,0 +1,467 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ * 2018037356 컴퓨터 학부 안동현 수정
+ */
+#include "gcm.h"
+#include <string.h>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GCM_HAVE_PCLMUL 1
+#include <cpuid.h>
+#include <wmmintrin.h>
+#include <tmmintrin.h>
+#endif
+
+/*
+GCM은 CTR 모드로 암호화하고, GF(2^128)에서의 곱셈으로 만든 GHASH로 AAD와 암호문을 인증한다.
+GHASH는 Y = (Y ^ X_i) * H 를 블록마다 반복하는 것이고, H = E_K(0^128)이다.
+GF(2^128)의 원소는 블록의 첫 바이트 최상위 비트가 x^0의 계수인 "뒤집힌" 비트 순서를 쓰고,
+기약 다항식은 x^128 + x^7 + x^2 + x + 1 이다.
+*/
+
+// GHASH 구현, aes_gcm_set_ghash()로 바꿀 수 있다.
+static int gcm_ghash = GCM_GHASH_AUTO;
+
+#ifdef GCM_HAVE_PCLMUL
+static int pclmul_supported(void);
+static void HashPowers(aes_gcm_ctx*, const uint8_t*);
+static void GhashPCLMUL(const aes_gcm_ctx*, uint8_t*, const uint8_t*, size_t);
+#endif
+
+static inline uint64_t load64be(const uint8_t *p)
+{
+	uint64_t x = 0;
+	for (int i = 0; i < 8; i++)
+		x = (x << 8) | p[i];
+	return x;
+}
+
+static inline void store64be(uint8_t *p, uint64_t x)
+{
+	for (int i = 7; i >= 0; i--){
+		p[i] = (uint8_t)x;
+		x >>= 8;
+	}
+}
+
+/*
+4비트 테이블 GHASH이다 (Shoup의 방법). HH[i], HL[i]에 4비트 값 i와 H의 곱을 미리 만들어 두고,
+Y를 뒤쪽 니블부터 하나씩 읽으면서 누적값을 x^4만큼 밀고(오른쪽으로 4비트) 테이블 값을 더한다.
+밀려서 나간 4비트는 last4에서 기약 다항식으로 줄인 값을 찾아 상위에 더해준다.
+*/
+static const uint16_t last4[16] = {
+	0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+	0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0
+};
+
+static void HashTable(aes_gcm_ctx *ctx, const uint8_t *h)
+{
+	uint64_t vh = load64be(h), vl = load64be(h + 8), t;
+
+	// 8 = x^0 이므로 H 자신이고, 4, 2, 1은 H에 x를 한 번씩 더 곱한 값이다.
+	ctx->HH[0] = ctx->HL[0] = 0;
+	ctx->HH[8] = vh;
+	ctx->HL[8] = vl;
+	for (int i = 4; i > 0; i >>= 1){
+		t = (vl & 1) * 0xe100000000000000ULL;
+		vl = (vh << 63) | (vl >> 1);
+		vh = (vh >> 1) ^ t;
+		ctx->HH[i] = vh;
+		ctx->HL[i] = vl;
+	}
+	// 나머지는 위의 값들의 XOR
+	for (int i = 2; i <= 8; i <<= 1)
+		for (int j = 1; j < i; j++){
+			ctx->HH[i+j] = ctx->HH[i] ^ ctx->HH[j];
+			ctx->HL[i+j] = ctx->HL[i] ^ ctx->HL[j];
+		}
+}
+
+// y = y * H
+static void GfMulTable(const aes_gcm_ctx *ctx, uint8_t *y)
+{
+	uint64_t zh, zl;
+	uint8_t lo, hi, rem;
+
+	lo = y[15] & 0xF;
+	zh = ctx->HH[lo];
+	zl = ctx->HL[lo];
+	for (int i = 15; i >= 0; i--){
+		lo = y[i] & 0xF;
+		hi = y[i] >> 4;
+		if (i != 15){
+			rem = zl & 0xF;
+			zl = (zh << 60) | (zl >> 4);
+			zh = (zh >> 4) ^ ((uint64_t)last4[rem] << 48);
+			zh ^= ctx->HH[lo];
+			zl ^= ctx->HL[lo];
+		}
+		rem = zl & 0xF;
+		zl = (zh << 60) | (zl >> 4);
+		zh = (zh >> 4) ^ ((uint64_t)last4[rem] << 48);
+		zh ^= ctx->HH[hi];
+		zl ^= ctx->HL[hi];
+	}
+	store64be(y, zh);
+	store64be(y + 8, zl);
+}
+
+static void GhashTable(const aes_gcm_ctx *ctx, uint8_t *y, const uint8_t *x, size_t nblocks)
+{
+	while (nblocks-- > 0){
+		for (int i = 0; i < 16; i++)
+			y[i] ^= x[i];
+		GfMulTable(ctx, y);
+		x += 16;
+	}
+}
+
+/*
+y에 길이가 len 바이트인 x를 GHASH로 누적한다. 마지막 블록이 16바이트보다 짧으면 0으로 채운다.
+*/
+static void Ghash(const aes_gcm_ctx *ctx, uint8_t *y, const uint8_t *x, size_t len)
+{
+	uint8_t last[16];
+	size_t nblocks = len / 16;
+
+#ifdef GCM_HAVE_PCLMUL
+	if (gcm_ghash == GCM_GHASH_PCLMUL){
+		GhashPCLMUL(ctx, y, x, nblocks);
+		if (len % 16){
+			memset(last, 0, 16);
+			memcpy(last, x + nblocks*16, len % 16);
+			GhashPCLMUL(ctx, y, last, 1);
+		}
+		return;
+	}
+#endif
+	GhashTable(ctx, y, x, nblocks);
+	if (len % 16){
+		memset(last, 0, 16);
+		memcpy(last, x + nblocks*16, len % 16);
+		GhashTable(ctx, y, last, 1);
+	}
+}
+
+/*
+ * aes_gcm_init() - 길이가 keylen 바이트인 key로 GCM 문맥 ctx를 만든다.
+ * 키 길이는 aes_init()과 같고, 성공하면 0, 그렇지 않으면 GCM_INVALID를 넘겨준다.
+ */
+int aes_gcm_init(aes_gcm_ctx *ctx, const uint8_t *key, int keylen)
+{
+	uint8_t h[16] = {0};
+
+	if (aes_init(&ctx->aes, key, keylen) != 0)
+		return GCM_INVALID;
+	aes_encrypt_block(&ctx->aes, h, h);
+	HashTable(ctx, h);
+#ifdef GCM_HAVE_PCLMUL
+	if (pclmul_supported())
+		HashPowers(ctx, h);
+#endif
+	return 0;
+}
+
+// 카운터 블록의 하위 32비트만 1 증가시킨다 (inc32).
+static void Inc32(uint8_t *cb)
+{
+	for (int i = 15; i >= 12; i--)
+		if (++cb[i] != 0)
+			break;
+}
+
+// 첫 카운터 블록 J0을 만든다.
+static void Counter0(const aes_gcm_ctx *ctx, const uint8_t *iv, size_t ivlen, uint8_t *j0)
+{
+	uint8_t lenblock[16] = {0};
+
+	if (ivlen == GCM_IVLEN){
+		memcpy(j0, iv, GCM_IVLEN);
+		j0[12] = j0[13] = j0[14] = 0;
+		j0[15] = 1;
+		return;
+	}
+	// 96비트가 아닌 IV는 GHASH(IV || 0 || [len(IV)]_64)
+	memset(j0, 0, 16);
+	Ghash(ctx, j0, iv, ivlen);
+	store64be(lenblock + 8, (uint64_t)ivlen * 8);
+	Ghash(ctx, j0, lenblock, 16);
+}
+
+/*
+GCM의 카운터는 하위 32비트만 증가하고 넘치면 0으로 돌아간다. aes_ctr()은 128비트 전체를
+증가시키므로 하위 32비트가 넘치기 직전까지씩 잘라서 호출하고, 넘친 뒤에는 하위 32비트를 0으로
+되돌린다. 96비트 IV이면 카운터가 2에서 시작하므로 한 번의 호출로 끝난다.
+*/
+static void GcmCtr(const aes_gcm_ctx *ctx, const uint8_t *icb, const uint8_t *in, uint8_t *out, size_t len)
+{
+	uint8_t cb[16];
+	uint64_t room;
+	size_t n;
+
+	memcpy(cb, icb, 16);
+	while (len > 0){
+		room = ((1ULL << 32) - (load64be(cb + 8) & 0xFFFFFFFF)) * 16;
+		n = len < room ? len : (size_t)room;
+		aes_ctr(&ctx->aes, cb, in, out, n);
+		in += n;
+		out += n;
+		len -= n;
+		cb[12] = cb[13] = cb[14] = cb[15] = 0;
+	}
+}
+
+// 태그 S = E_K(J0) ^ GHASH(A || 0 || C || 0 || [len(A)]_64 || [len(C)]_64)
+static void Tag(const aes_gcm_ctx *ctx, const uint8_t *j0, const uint8_t *aad, size_t aadlen,
+		const uint8_t *c, size_t clen, uint8_t *s)
+{
+	uint8_t y[16] = {0}, lenblock[16], ek[16];
+
+	Ghash(ctx, y, aad, aadlen);
+	Ghash(ctx, y, c, clen);
+	store64be(lenblock, (uint64_t)aadlen * 8);
+	store64be(lenblock + 8, (uint64_t)clen * 8);
+	Ghash(ctx, y, lenblock, 16);
+	aes_encrypt_block(&ctx->aes, j0, ek);
+	for (int i = 0; i < 16; i++)
+		s[i] = y[i] ^ ek[i];
+}
+
+// 인자 확인: 평문은 2^36 - 32 바이트까지, IV는 1바이트 이상, 태그는 16, 15, 14, 13, 12, 8, 4 바이트
+static int CheckArgs(size_t ivlen, size_t len, size_t taglen)
+{
+	if (ivlen == 0 || taglen > GCM_TAGLEN)
+		return GCM_INVALID;
+	if (taglen < GCM_MINTAGLEN && taglen != 8 && taglen != 4)
+		return GCM_INVALID;
+	if ((uint64_t)len > (1ULL << 36) - 32)
+		return GCM_INVALID;
+	return 0;
+}
+
+/*
+ * aes_gcm_seal() - 길이가 len인 평문 in을 암호화해서 out에 저장하고, aad와 암호문에 대한
+ * taglen 바이트의 인증 태그를 tag에 저장한다. in과 out은 같은 버퍼여도 된다.
+ * 성공하면 0, 인자가 잘못되었으면 GCM_INVALID를 넘겨준다.
+ */
+int aes_gcm_seal(const aes_gcm_ctx *ctx, const uint8_t *iv, size_t ivlen,
+		 const uint8_t *aad, size_t aadlen, const uint8_t *in, size_t len,
+		 uint8_t *out, uint8_t *tag, size_t taglen)
+{
+	uint8_t j0[16], cb[16], s[16];
+
+	if (CheckArgs(ivlen, len, taglen) != 0)
+		return GCM_INVALID;
+	Counter0(ctx, iv, ivlen, j0);
+	memcpy(cb, j0, 16);
+	Inc32(cb);
+	GcmCtr(ctx, cb, in, out, len);
+	Tag(ctx, j0, aad, aadlen, out, len, s);
+	memcpy(tag, s, taglen);
+	return 0;
+}
+
+/*
+ * aes_gcm_open() - aad와 암호문 in에 대한 태그가 tag와 같은지 확인하고, 같으면 in을 복호화해서
+ * out에 저장한다. 태그가 다르면 out에 아무것도 쓰지 않고 GCM_AUTH_FAIL을 넘겨준다.
+ * 태그 비교는 일치하는 바이트 수와 상관없이 같은 시간이 걸린다.
+ */
+int aes_gcm_open(const aes_gcm_ctx *ctx, const uint8_t *iv, size_t ivlen,
+		 const uint8_t *aad, size_t aadlen, const uint8_t *in, size_t len,
+		 uint8_t *out, const uint8_t *tag, size_t taglen)
+{
+	uint8_t j0[16], cb[16], s[16], diff = 0;
+
+	if (CheckArgs(ivlen, len, taglen) != 0)
+		return GCM_INVALID;
+	Counter0(ctx, iv, ivlen, j0);
+	Tag(ctx, j0, aad, aadlen, in, len, s);
+	for (size_t i = 0; i < taglen; i++)
+		diff |= s[i] ^ tag[i];
+	if (diff != 0)
+		return GCM_AUTH_FAIL;
+	memcpy(cb, j0, 16);
+	Inc32(cb);
+	GcmCtr(ctx, cb, in, out, len);
+	return 0;
+}
+
+/*
+ * aes_gcm_set_ghash() - GHASH 구현을 고른다.
+ * GCM_GHASH_AUTO이면 CPU에 맞는 구현을 고르고, CPU가 지원하지 않는 구현이면 -1을 넘겨준다.
+ * PCLMULQDQ용 H의 거듭제곱은 aes_gcm_init()에서 만들어 두므로 언제 바꿔도 된다.
+ */
+int aes_gcm_set_ghash(int impl)
+{
+	if (impl == GCM_GHASH_AUTO){
+#ifdef GCM_HAVE_PCLMUL
+		impl = pclmul_supported() ? GCM_GHASH_PCLMUL : GCM_GHASH_TABLE;
+#else
+		impl = GCM_GHASH_TABLE;
+#endif
+	}
+	if (impl == GCM_GHASH_PCLMUL){
+#ifdef GCM_HAVE_PCLMUL
+		if (!pclmul_supported())
+			return -1;
+#else
+		return -1;
+#endif
+	}
+	else if (impl != GCM_GHASH_TABLE)
+		return -1;
+	gcm_ghash = impl;
+	return 0;
+}
+
+// 현재 선택된 GHASH 구현을 돌려준다.
+int aes_gcm_get_ghash(void)
+{
+	return gcm_ghash == GCM_GHASH_AUTO ? GCM_GHASH_TABLE : gcm_ghash;
+}
+
+#ifdef GCM_HAVE_PCLMUL
+/*
+PCLMULQDQ GHASH이다. CPUID(EAX=1)의 ECX 1번 비트(PCLMULQDQ)와 9번 비트(SSSE3, pshufb)를 확인한다.
+
+블록의 바이트 순서를 뒤집어 읽으면 비트 순서가 뒤집힌 GF(2^128) 원소를 보통의 다항식처럼 곱할 수
+있다. 64비트 carry-less 곱셈 4번으로 256비트 곱을 만들고, 뒤집힌 비트 순서 때문에 1비트 왼쪽으로
+민 다음 기약 다항식으로 줄인다 (Intel의 "Carry-Less Multiplication and Its Usage for Computing
+the GCM Mode" 방식).
+곱셈과 줄이기가 모두 선형이므로 4블록을 한꺼번에 처리할 때는
+Y' = (Y ^ X1)*H^4 ^ X2*H^3 ^ X3*H^2 ^ X4*H 의 네 곱을 줄이지 않고 더한 뒤 한 번만 줄인다.
+*/
+static int pclmul_supported(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return 0;
+	return (ecx & bit_PCLMUL) != 0 && (ecx & bit_SSSE3) != 0;
+}
+
+// 프로그램이 시작될 때 GCM_GHASH_AUTO를 실제 구현으로 바꿔둔다.
+__attribute__((constructor))
+static void gcm_select_ghash(void)
+{
+	aes_gcm_set_ghash(GCM_GHASH_AUTO);
+}
+
+// 256비트 곱 (hi, lo) = a * b
+__attribute__((target("pclmul,ssse3")))
+static inline void ClMul(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+	__m128i t0, t1, t2, t3;
+
+	t0 = _mm_clmulepi64_si128(a, b, 0x00);
+	t1 = _mm_clmulepi64_si128(a, b, 0x10);
+	t2 = _mm_clmulepi64_si128(a, b, 0x01);
+	t3 = _mm_clmulepi64_si128(a, b, 0x11);
+	t1 = _mm_xor_si128(t1, t2);
+	*lo = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+	*hi = _mm_xor_si128(t3, _mm_srli_si128(t1, 8));
+}
+
+// (hi, lo)를 1비트 왼쪽으로 민 다음 x^128 + x^7 + x^2 + x + 1로 줄인다.
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i Reduce(__m128i lo, __m128i hi)
+{
+	__m128i t2, t4, t5, t7, t8, t9;
+
+	t7 = _mm_srli_epi32(lo, 31);
+	t8 = _mm_srli_epi32(hi, 31);
+	lo = _mm_slli_epi32(lo, 1);
+	hi = _mm_slli_epi32(hi, 1);
+	t9 = _mm_srli_si128(t7, 12);
+	t8 = _mm_slli_si128(t8, 4);
+	t7 = _mm_slli_si128(t7, 4);
+	lo = _mm_or_si128(lo, t7);
+	hi = _mm_or_si128(hi, t8);
+	hi = _mm_or_si128(hi, t9);
+
+	t7 = _mm_slli_epi32(lo, 31);
+	t8 = _mm_slli_epi32(lo, 30);
+	t9 = _mm_slli_epi32(lo, 25);
+	t7 = _mm_xor_si128(t7, t8);
+	t7 = _mm_xor_si128(t7, t9);
+	t8 = _mm_srli_si128(t7, 4);
+	t7 = _mm_slli_si128(t7, 12);
+	lo = _mm_xor_si128(lo, t7);
+
+	t2 = _mm_srli_epi32(lo, 1);
+	t4 = _mm_srli_epi32(lo, 2);
+	t5 = _mm_srli_epi32(lo, 7);
+	t2 = _mm_xor_si128(t2, t4);
+	t2 = _mm_xor_si128(t2, t5);
+	t2 = _mm_xor_si128(t2, t8);
+	lo = _mm_xor_si128(lo, t2);
+	return _mm_xor_si128(hi, lo);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static inline __m128i GfMul(__m128i a, __m128i b)
+{
+	__m128i lo, hi;
+
+	ClMul(a, b, &lo, &hi);
+	return Reduce(lo, hi);
+}
+
+#define BSWAP_MASK _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)
+
+// H^1 ~ H^4를 바이트 순서를 뒤집은 형태로 만든다.
+__attribute__((target("pclmul,ssse3")))
+static void HashPowers(aes_gcm_ctx *ctx, const uint8_t *h)
+{
+	__m128i h1, hp;
+
+	h1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)h), BSWAP_MASK);
+	hp = h1;
+	_mm_storeu_si128((__m128i *)ctx->Hpow[0], hp);
+	for (int i = 1; i < 4; i++){
+		hp = GfMul(hp, h1);
+		_mm_storeu_si128((__m128i *)ctx->Hpow[i], hp);
+	}
+}
+
+__attribute__((target("pclmul,ssse3")))
+static void GhashPCLMUL(const aes_gcm_ctx *ctx, uint8_t *y, const uint8_t *x, size_t nblocks)
+{
+	const __m128i mask = BSWAP_MASK;
+	__m128i h1, h2, h3, h4, Y, x0, x1, x2, x3, lo, hi, l, h;
+
+	h1 = _mm_loadu_si128((const __m128i *)ctx->Hpow[0]);
+	h2 = _mm_loadu_si128((const __m128i *)ctx->Hpow[1]);
+	h3 = _mm_loadu_si128((const __m128i *)ctx->Hpow[2]);
+	h4 = _mm_loadu_si128((const __m128i *)ctx->Hpow[3]);
+	Y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)y), mask);
+
+	while (nblocks >= 4){
+		x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(x +  0)), mask);
+		x1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(x + 16)), mask);
+		x2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(x + 32)), mask);
+		x3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(x + 48)), mask);
+		ClMul(_mm_xor_si128(Y, x0), h4, &lo, &hi);
+		ClMul(x1, h3, &l, &h);
+		lo = _mm_xor_si128(lo, l);
+		hi = _mm_xor_si128(hi, h);
+		ClMul(x2, h2, &l, &h);
+		lo = _mm_xor_si128(lo, l);
+		hi = _mm_xor_si128(hi, h);
+		ClMul(x3, h1, &l, &h);
+		lo = _mm_xor_si128(lo, l);
+		hi = _mm_xor_si128(hi, h);
+		Y = Reduce(lo, hi);
+		x += 64;
+		nblocks -= 4;
+	}
+	while (nblocks-- > 0){
+		x0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)x), mask);
+		Y = GfMul(_mm_xor_si128(Y, x0), h1);
+		x += 16;
+	}
+	_mm_storeu_si128((__m128i *)y, _mm_shuffle_epi8(Y, mask));
+}
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#ifndef _GCM_H_
+#define _GCM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "aes.h"
+
+/*
+ * AES-GCM 인증 암호 (NIST SP 800-38D)
+ * aes_gcm_seal()은 평문을 암호화하고 인증 태그를 만들고, aes_gcm_open()은 태그를 먼저 확인한 다음
+ * 맞는 경우에만 복호화한다. 태그 길이는 GCM_MINTAGLEN ~ GCM_TAGLEN 바이트이고, SP 800-38D
+ * 5.2.1.2와 부록 C에 따라 짧은 태그가 필요한 특수한 용도를 위한 8, 4 바이트도 받는다.
+ * 그 밖의 길이(5 ~ 7, 9 ~ 11 바이트 등)는 GCM_INVALID이다.
+ */
+#define GCM_TAGLEN 16
+#define GCM_MINTAGLEN 12
+#define GCM_IVLEN 12                /* 권장하는 IV 길이 (96비트) */
+
+/*
+ * GHASH 구현 목록이다.
+ * GCM_GHASH_TABLE은 H의 배수 16개를 미리 계산해 두고 4비트씩 처리하는 구현이고,
+ * GCM_GHASH_PCLMUL은 x86-64의 PCLMULQDQ(carry-less 곱셈) 명령어를 사용한다.
+ * GCM_GHASH_AUTO는 실행할 때 CPU를 확인해서 PCLMULQDQ가 있으면 GCM_GHASH_PCLMUL을 고른다.
+ */
+#define GCM_GHASH_AUTO   -1
+#define GCM_GHASH_TABLE  0
+#define GCM_GHASH_PCLMUL 1
+
+/*
+ * 오류 코드
+ */
+#define GCM_INVALID   -1            /* 잘못된 키, IV, 태그 길이 */
+#define GCM_AUTH_FAIL -2            /* 인증 태그 불일치 */
+
+typedef struct {
+    aes_ctx aes;                    /* 블록 암호 문맥 */
+    uint64_t HH[16], HL[16];        /* 4비트 테이블: i*H의 상위/하위 64비트 */
+    uint8_t Hpow[4][16];            /* PCLMULQDQ용 H^1 ~ H^4 (바이트 순서를 뒤집은 값) */
+} aes_gcm_ctx;
+
+int aes_gcm_init(aes_gcm_ctx *ctx, const uint8_t *key, int keylen);
+int aes_gcm_seal(const aes_gcm_ctx *ctx, const uint8_t *iv, size_t ivlen,
+                 const uint8_t *aad, size_t aadlen, const uint8_t *in, size_t len,
+                 uint8_t *out, uint8_t *tag, size_t taglen);
+int aes_gcm_open(const aes_gcm_ctx *ctx, const uint8_t *iv, size_t ivlen,
+                 const uint8_t *aad, size_t aadlen, const uint8_t *in, size_t len,
+                 uint8_t *out, const uint8_t *tag, size_t taglen);
+int aes_gcm_set_ghash(int impl);
+int aes_gcm_get_ghash(void);
+
+#endif
@@ -8,6 +8,7 @@
 #define _AES_H_
 
 #include <stdint.h>
+#include <stddef.h>
 /*
  * AES128 (128 비트 키, 10 라운드): Nb = 4, Nk = 4, Nr = 10
  * AES192 (192 비트 키, 12 라운드): Nb = 4, Nk = 6, Nr = 12
@@ -21,12 +22,132 @@
 #define KEYLEN (4*Nk)             /* key length in bytes */
 #define RNDKEYLEN (Nb*(Nr+1))     /* round key length in words */
 
+/*
+ * Nk, Nr, KEYLEN, RNDKEYLEN은 KeyExpansion(), Cipher()가 사용하는 AES-128 값이다.
+ * aes_ctx는 aes_init()에 넘긴 키 길이로 실행 중에 nk, nr을 정하므로
+ * 한 프로그램에서 세 가지 키 길이를 모두 사용할 수 있다.
+ */
+#define AES128_KEYLEN 16
+#define AES192_KEYLEN 24
+#define AES256_KEYLEN 32
+#define AES_MAXNR 14                          /* AES-256의 라운드 수 */
+#define AES_MAXRNDKEYLEN (Nb*(AES_MAXNR+1))   /* 가장 긴 라운드 키의 워드 수 */
+
 #define XTIME(a) (((a)<<1) ^ ((((a)>>7) & 1) * 0x1b))
 
 #define ENCRYPT 1
 #define DECRYPT 0
 
+/*
+ * aes_init(), aes_encrypt_block(), aes_decrypt_block()과 KeyExpansion(), Cipher()가
+ * 사용하는 엔진 목록이다.
+ * AES_ENGINE_REF는 SubBytes, ShiftRows, MixColumns, AddRoundKey를 차례로 수행하는 기준 구현이고,
+ * AES_ENGINE_TTABLE은 라운드 연산을 열 단위 32비트 테이블 조회로 합친 구현이며,
+ * AES_ENGINE_AESNI는 x86-64의 AES-NI 명령어(aesenc, aesdec, aeskeygenassist, aesimc)를 사용한다.
+ * AES_ENGINE_BITSLICE는 8개의 블록을 비트 평면으로 바꿔 논리 연산만으로 계산하는 구현으로,
+ * 키 확장과 암호화, 복호화에서 비밀 값으로 테이블을 조회하지 않는다 (AES-NI가 없는 CPU용).
+ * 캐시 타이밍으로 새는 경로를 없앤 것이고, 컴파일러와 CPU에 따라 달라지는 다른 부채널까지
+ * 검증한 것은 아니다.
+ * 8블록씩 처리하므로 aes_encrypt_blocks()나 CTR 모드처럼 여러 블록을 한 번에 넘길 때 빠르다.
+ * AES_ENGINE_AUTO는 실행할 때 CPU를 확인해서 AES-NI가 있으면 AES_ENGINE_AESNI를,
+ * 없으면 AES_ENGINE_TTABLE을 고른다. 테이블 조회를 피해야 하면 AES_ENGINE_BITSLICE를 직접 고른다.
+ * 기본 엔진은 빌드할 때 -DAES_DEFAULT_ENGINE=AES_ENGINE_REF 처럼 바꿀 수 있고,
+ * 실행 중에는 aes_set_engine()으로 바꿀 수 있다. aes_init()은 그때 선택된 엔진을 문맥에 기록하므로
+ * 엔진을 바꾸면 그 뒤에 aes_init()한 문맥과 KeyExpansion()한 키로 하는 Cipher()에만 적용된다.
+ */
+#define AES_ENGINE_AUTO   -1
+#define AES_ENGINE_REF    0
+#define AES_ENGINE_TTABLE 1
+#define AES_ENGINE_AESNI  2
+#define AES_ENGINE_BITSLICE 3
+
+#ifndef AES_DEFAULT_ENGINE
+#define AES_DEFAULT_ENGINE AES_ENGINE_AUTO
+#endif
+
+/*
+ * 하나의 키에 대한 암호화용, 복호화용 라운드 키를 담는 문맥이다.
+ * 문맥마다 라운드 키와 엔진을 따로 가지므로 여러 키를 동시에 사용할 수 있고,
+ * aes_init() 이후에는 읽기만 하므로 여러 스레드가 잠금 없이 공유할 수 있다.
+ */
+#define AES_BSKEYLEN (32*(AES_MAXNR+1))   /* 비트 슬라이스 라운드 키의 워드 수 */
+
+typedef struct {
+    int nk;                                /* 키의 워드 수 (4, 6, 8) */
+    int nr;                                /* 라운드 수 (10, 12, 14) */
+    int engine;                            /* aes_init()할 때 고른 엔진 (AES_ENGINE_*) */
+    uint32_t roundKey[AES_MAXRNDKEYLEN];   /* 암호화용 라운드 키 */
+    uint32_t droundKey[AES_MAXRNDKEYLEN];  /* 복호화용 라운드 키 (동등 역암호) */
+    uint32_t bsKey[AES_BSKEYLEN];          /* 비트 슬라이스 형태의 roundKey (항상 만든다) */
+    uint32_t bsDKey[AES_BSKEYLEN];         /* 비트 슬라이스 형태의 droundKey */
+} aes_ctx;
+
+int aes_init(aes_ctx *ctx, const uint8_t *key, int keylen);
+void aes_encrypt_block(const aes_ctx *ctx, const uint8_t *in, uint8_t *out);
+void aes_decrypt_block(const aes_ctx *ctx, const uint8_t *in, uint8_t *out);
+void aes_encrypt_blocks(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t nblocks);
+void aes_decrypt_blocks(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t nblocks);
+
+/*
+ * CTR 모드 (NIST SP 800-38A)
+ * 카운터 블록 전체를 128비트 빅 엔디안 정수로 보고 블록마다 1씩 증가시킨다.
+ * 한 번에 AES_CTR_BLOCKS개의 블록을 함께 암호화하고, AES_PARALLEL_MIN 바이트 이상인 버퍼는
+ * aes_set_threads()로 정한 수의 스레드에 나누어 처리한다. 스레드를 만들고 기다리는 비용이
+ * 호출마다 들기 때문에 스레드 하나가 AES_THREAD_MIN 바이트 이상을 맡도록 스레드 수를 줄인다.
+ * 암호화와 복호화는 같은 연산이다.
+ */
+#define AES_CTR_BLOCKS 8
+#define AES_PARALLEL_MIN (4 << 20)
+#define AES_THREAD_MIN (1 << 20)
+#define AES_MAXTHREADS 64
+
+typedef struct {
+    const aes_ctx *key;
+    uint8_t counter[BLOCKLEN];  /* 다음에 사용할 카운터 블록 */
+    uint8_t stream[BLOCKLEN];   /* 마지막으로 만든 키 스트림 블록 */
+    int used;                   /* stream에서 이미 사용한 바이트 수 */
+} aes_ctr_ctx;
+
+void aes_ctr_init(aes_ctr_ctx *ctr, const aes_ctx *key, const uint8_t *iv);
+void aes_ctr_update(aes_ctr_ctx *ctr, const uint8_t *in, uint8_t *out, size_t len);
+void aes_ctr(const aes_ctx *key, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len);
+void aes_set_threads(int n);
+
+/*
+ * ECB, CBC, CFB, OFB 모드 (NIST SP 800-38A)
+ * ECB와 CBC는 블록 단위로 동작하므로 AES_PAD_PKCS7을 지정하면 PKCS#7 패딩을 붙이고 떼며,
+ * AES_PAD_NONE이면 len이 BLOCKLEN의 배수여야 한다. 패딩을 붙여 암호화할 때 out에는
+ * (len / BLOCKLEN + 1) * BLOCKLEN 바이트가 필요하고, 실제 길이는 *outlen에 저장된다.
+ * CFB(128비트 피드백)와 OFB는 스트림 모드이므로 패딩 없이 len 바이트를 그대로 처리한다.
+ * 모든 함수에서 in과 out은 같은 버퍼여도 된다(제자리 처리).
+ * 서로 의존하지 않는 블록은 AES_PIPE_BLOCKS개씩 함께 처리한다 (ECB, CBC 복호화, CFB 복호화).
+ */
+#define AES_PAD_NONE  0
+#define AES_PAD_PKCS7 1
+#define AES_PIPE_BLOCKS 8
+
+/*
+ * 오류 코드
+ */
+#define AES_INVALID     -1          /* 잘못된 키 길이, 데이터 길이, 패딩 방식 */
+#define AES_BAD_PADDING -2          /* 복호화한 PKCS#7 패딩이 올바르지 않음 */
+
+int aes_ecb_encrypt(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t len, int pad, size_t *outlen);
+int aes_ecb_decrypt(const aes_ctx *ctx, const uint8_t *in, uint8_t *out, size_t len, int pad, size_t *outlen);
+int aes_cbc_encrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len,
+                    int pad, size_t *outlen);
+int aes_cbc_decrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len,
+                    int pad, size_t *outlen);
+void aes_cfb_encrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len);
+void aes_cfb_decrypt(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len);
+void aes_ofb(const aes_ctx *ctx, const uint8_t *iv, const uint8_t *in, uint8_t *out, size_t len);
+
+/*
+ * 기존 인터페이스이다. 복호화용 라운드 키를 내부에 하나만 두므로 한 번에 하나의 키만 쓸 수 있다.
+ */
 void KeyExpansion(const uint8_t *key, uint32_t *roundKey);
 void Cipher(uint8_t *state, const uint32_t *roundKey, int mode);
+int aes_set_engine(int engine);
+int aes_get_engine(void);
 
 #endif
@@ -0,0 +1,349 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <bsd/stdlib.h>
+#elif __APPLE__
+#include <stdlib.h>
+#else
+#include <stdlib.h>
+#endif
+#include "aes.h"
+#include "gcm.h"
+
+/*
+ * AES-GCM 파일 암호화 도구
+ *
+ *   aesfile enc|dec [-t 스레드수] 키파일 입력파일 출력파일
+ *
+ * 키를 명령행 인자로 받으면 ps나 셸 기록에 남으므로 키 파일에서 읽는다. 키 파일에는 16진수
+ * 32, 48, 64자를 넣고, 공백과 줄바꿈은 무시한다.
+ *
+ * 암호문 파일은 NONCELEN 바이트의 무작위 값 다음에, 평문을 CHUNKLEN 바이트씩 나눈 조각마다
+ * AES-GCM으로 만든 "암호문 || 16바이트 태그"가 이어지는 형식이다. i번째 조각의 IV는
+ * 무작위 값 || i(32비트 빅 엔디안)이고, AAD는 마지막 조각이면 1, 아니면 0인 1바이트이다.
+ * 마지막 조각은 항상 있으므로(평문 길이가 CHUNKLEN의 배수이면 빈 조각) 조각을 바꾸거나 빼거나
+ * 파일 끝을 잘라내도 태그 확인에서 걸린다. 복호화는 조각의 태그를 확인한 다음에만 평문을 쓴다.
+ *
+ * 입력 파일은 mmap으로 읽는다. 조각 하나가 AES_PARALLEL_MIN 이상이므로 aes.c가 조각의 CTR을
+ * 여러 스레드에 나누어 처리한다. 출력은 버퍼 두 개를 번갈아 사용한다: 한 버퍼를 쓰기 스레드가
+ * 디스크에 쓰는 동안 다음 조각을 다른 버퍼에 처리하므로 암호화와 쓰기가 겹친다. 이미 처리한
+ * 입력 페이지는 madvise()로 돌려주므로 파일 크기와 관계없이 메모리 사용량이 버퍼 두 개 정도로 일정하다.
+ *
+ * 출력은 같은 디렉터리의 임시 파일(권한 0600)에 쓰고 끝까지 성공했을 때만 rename()으로
+ * 출력 파일 이름을 붙인다. 그래서 인증에 실패하면 출력 파일이 생기지 않고, 입력과 출력이
+ * 같은 파일이어도 매핑한 입력이 잘리지 않는다.
+ */
+#define CHUNKLEN (4*1024*1024)
+#define NONCELEN 8
+
+/*
+ * 쓰기 스레드가 맡는 일
+ */
+typedef struct {
+    int fd;
+    const uint8_t *buf;
+    size_t len;
+    int err;                    /* 쓰기에 실패했으면 errno */
+} write_job;
+
+static void *writer(void *arg)
+{
+    write_job *job = (write_job *)arg;
+    const uint8_t *p = job->buf;
+    size_t left = job->len;
+    ssize_t n;
+
+    job->err = 0;
+    while (left > 0) {
+        n = write(job->fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            job->err = errno;
+            break;
+        }
+        p += n;
+        left -= (size_t)n;
+    }
+    return NULL;
+}
+
+/*
+ * parse_key() - 16진수 문자열을 키로 바꾸고 키 길이(16, 24, 32)를 돌려준다. 잘못되었으면 -1
+ */
+static int parse_key(const char *hex, uint8_t *key)
+{
+    size_t len = strlen(hex);
+    unsigned int b;
+    size_t i;
+
+    if (len != 2*AES128_KEYLEN && len != 2*AES192_KEYLEN && len != 2*AES256_KEYLEN)
+        return -1;
+    for (i = 0; i < len / 2; ++i) {
+        if (sscanf(hex + 2*i, "%2x", &b) != 1)
+            return -1;
+        key[i] = (uint8_t)b;
+    }
+    return (int)(len / 2);
+}
+
+/*
+ * read_key() - 키 파일 path에서 16진수 키를 읽어 key에 넣고 키 길이를 돌려준다. 잘못되었으면 -1
+ */
+static int read_key(const char *path, uint8_t *key)
+{
+    char hex[2*AES256_KEYLEN + 2];
+    size_t len = 0;
+    int c, ret;
+    FILE *fp;
+
+    if ((fp = fopen(path, "r")) == NULL) {
+        perror(path);
+        return -1;
+    }
+    // 너무 긴 키는 2*AES256_KEYLEN + 1자에서 멈추므로 parse_key()가 거부한다.
+    while (len < sizeof(hex) - 1 && (c = fgetc(fp)) != EOF)
+        if (!isspace(c))
+            hex[len++] = (char)c;
+    fclose(fp);
+    hex[len] = '\0';
+    if ((ret = parse_key(hex, key)) < 0)
+        fprintf(stderr, "%s: 키는 16진수 32, 48, 64자여야 한다.\n", path);
+    memset(hex, 0, sizeof(hex));
+    return ret;
+}
+
+// i번째 조각의 IV: 무작위 값 || i
+static void chunk_iv(uint8_t *iv, const uint8_t *nonce, uint32_t i)
+{
+    memcpy(iv, nonce, NONCELEN);
+    iv[NONCELEN + 0] = (uint8_t)(i >> 24);
+    iv[NONCELEN + 1] = (uint8_t)(i >> 16);
+    iv[NONCELEN + 2] = (uint8_t)(i >> 8);
+    iv[NONCELEN + 3] = (uint8_t)i;
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "사용법: aesfile enc|dec [-t 스레드수] 키파일 입력파일 출력파일\n");
+}
+
+int main(int argc, char *argv[])
+{
+    static const uint8_t empty[1];
+    uint8_t key[AES256_KEYLEN], nonce[NONCELEN], iv[GCM_IVLEN], last = 0;
+    uint8_t *buf[2] = {NULL, NULL};
+    const uint8_t *in = empty;
+    const char *ipath, *opath;
+    char *tmp = NULL;
+    size_t len, off, n, olen, total = 0, page = (size_t)sysconf(_SC_PAGESIZE);
+    uint32_t idx;
+    pthread_t tid;
+    write_job job[2];
+    struct stat st;
+    aes_gcm_ctx ctx;
+    int decrypt, keylen, ifd, ofd = -1, argi = 2, cur = 0, running = 0, ret = 1;
+    double t0, t1;
+
+    if (argc < 5 || (strcmp(argv[1], "enc") && strcmp(argv[1], "dec"))) {
+        usage();
+        return 1;
+    }
+    decrypt = strcmp(argv[1], "dec") == 0;
+    if (strcmp(argv[argi], "-t") == 0) {
+        if (argc < 7) {
+            usage();
+            return 1;
+        }
+        aes_set_threads(atoi(argv[argi + 1]));
+        argi += 2;
+    }
+    if (argc != argi + 3) {
+        usage();
+        return 1;
+    }
+    ipath = argv[argi + 1];
+    opath = argv[argi + 2];
+    if ((keylen = read_key(argv[argi], key)) < 0)
+        return 1;
+    aes_gcm_init(&ctx, key, keylen);
+    memset(key, 0, sizeof(key));
+
+    if ((ifd = open(ipath, O_RDONLY)) < 0) {
+        perror(ipath);
+        return 1;
+    }
+    if (fstat(ifd, &st) < 0) {
+        perror(ipath);
+        close(ifd);
+        return 1;
+    }
+    len = (size_t)st.st_size;
+    if (len > 0) {
+        in = mmap(NULL, len, PROT_READ, MAP_PRIVATE, ifd, 0);
+        if (in == MAP_FAILED) {
+            perror("mmap");
+            close(ifd);
+            return 1;
+        }
+        madvise((void *)in, len, MADV_SEQUENTIAL);
+    }
+    if (decrypt && len < NONCELEN + GCM_TAGLEN) {
+        fprintf(stderr, "%s: 암호문 파일이 너무 짧다.\n", ipath);
+        goto out;
+    }
+    // 출력 파일과 같은 디렉터리에 임시 파일을 만든다. (rename()은 같은 파일 시스템 안에서만 된다)
+    if ((tmp = malloc(strlen(opath) + sizeof(".XXXXXX"))) == NULL) {
+        fprintf(stderr, "메모리 부족\n");
+        goto out;
+    }
+    sprintf(tmp, "%s.XXXXXX", opath);
+    if ((ofd = mkstemp(tmp)) < 0) {
+        perror(tmp);
+        free(tmp);
+        tmp = NULL;
+        goto out;
+    }
+    buf[0] = malloc(CHUNKLEN + GCM_TAGLEN);
+    buf[1] = malloc(CHUNKLEN + GCM_TAGLEN);
+    if (buf[0] == NULL || buf[1] == NULL) {
+        fprintf(stderr, "메모리 부족\n");
+        goto out;
+    }
+
+    /*
+     * 암호화는 무작위 값을 만들어 먼저 쓰고, 복호화는 입력의 앞에서 읽는다.
+     */
+    off = 0;
+    if (decrypt) {
+        memcpy(nonce, in, NONCELEN);
+        off = NONCELEN;
+    }
+    else {
+        arc4random_buf(nonce, NONCELEN);
+        job[0].fd = ofd;
+        job[0].buf = nonce;
+        job[0].len = NONCELEN;
+        writer(&job[0]);
+        if (job[0].err) {
+            fprintf(stderr, "%s: %s\n", tmp, strerror(job[0].err));
+            goto out;
+        }
+    }
+
+    t0 = seconds();
+    for (idx = 0; !last; ++idx) {
+        chunk_iv(iv, nonce, idx);
+        if (decrypt) {
+            // 남은 입력은 (조각 || 태그)이고, 태그도 없으면 파일 끝이 잘린 것이다.
+            if (len - off < GCM_TAGLEN) {
+                fprintf(stderr, "%s: 암호문 파일이 잘렸다.\n", ipath);
+                goto out;
+            }
+            n = len - off < CHUNKLEN + GCM_TAGLEN ? len - off : CHUNKLEN + GCM_TAGLEN;
+            last = n < CHUNKLEN + GCM_TAGLEN;
+            olen = n - GCM_TAGLEN;
+            if (aes_gcm_open(&ctx, iv, GCM_IVLEN, &last, 1, in + off, olen, buf[cur],
+                             in + off + olen, GCM_TAGLEN) != 0) {
+                fprintf(stderr, "%s: %u번째 조각의 인증 태그가 맞지 않는다.\n", ipath, (unsigned)idx);
+                goto out;
+            }
+        }
+        else {
+            n = len - off < CHUNKLEN ? len - off : CHUNKLEN;
+            last = n < CHUNKLEN;
+            aes_gcm_seal(&ctx, iv, GCM_IVLEN, &last, 1, in + off, n, buf[cur], buf[cur] + n, GCM_TAGLEN);
+            olen = n + GCM_TAGLEN;
+        }
+        // 처리한 입력 페이지는 다시 읽지 않으므로 돌려준다. (페이지 경계에 맞춘다)
+        if (n > 0)
+            madvise((void *)(in + (off & ~(page - 1))), n + (off & (page - 1)), MADV_DONTNEED);
+        off += n;
+        total += decrypt ? olen : n;
+        // 앞 조각의 쓰기가 끝나야 그 버퍼를 다시 쓸 수 있다.
+        if (running) {
+            pthread_join(tid, NULL);
+            running = 0;
+            if (job[cur ^ 1].err) {
+                fprintf(stderr, "%s: %s\n", tmp, strerror(job[cur ^ 1].err));
+                goto out;
+            }
+        }
+        job[cur].fd = ofd;
+        job[cur].buf = buf[cur];
+        job[cur].len = olen;
+        if (pthread_create(&tid, NULL, writer, &job[cur]) == 0)
+            running = 1;
+        else {
+            // 스레드를 만들지 못하면 직접 쓴다.
+            writer(&job[cur]);
+            if (job[cur].err) {
+                fprintf(stderr, "%s: %s\n", tmp, strerror(job[cur].err));
+                goto out;
+            }
+        }
+        cur ^= 1;
+    }
+    if (running) {
+        pthread_join(tid, NULL);
+        running = 0;
+        if (job[cur ^ 1].err) {
+            fprintf(stderr, "%s: %s\n", tmp, strerror(job[cur ^ 1].err));
+            goto out;
+        }
+    }
+    if (close(ofd) < 0) {
+        ofd = -1;
+        perror(tmp);
+        goto out;
+    }
+    ofd = -1;
+    if (rename(tmp, opath) < 0) {
+        perror(opath);
+        goto out;
+    }
+    free(tmp);
+    tmp = NULL;
+    t1 = seconds();
+    printf("%s: %zu 바이트, %.3f 초, %.1f MB/s\n", decrypt ? "복호화" : "암호화", total, t1 - t0,
+           t1 > t0 ? (double)total / (t1 - t0) / 1e6 : 0.0);
+    ret = 0;
+
+out:
+    if (running)
+        pthread_join(tid, NULL);
+    if (ofd >= 0)
+        close(ofd);
+    // 실패했으면 임시 파일을 지운다. 출력 파일은 만들어지지 않았거나 그대로이다.
+    if (tmp != NULL) {
+        unlink(tmp);
+        free(tmp);
+    }
+    if (len > 0)
+        munmap((void *)in, len);
+    close(ifd);
+    free(buf[0]);
+    free(buf[1]);
+    return ret;
+}
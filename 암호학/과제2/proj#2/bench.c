@@ -0,0 +1,292 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#ifdef __linux__
+#include <bsd/stdlib.h>
+#elif __APPLE__
+#include <stdlib.h>
+#else
+#include <stdlib.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "aes.h"
+#include "gcm.h"
+
+/*
+ * 엔진별 성능 측정에 사용할 버퍼 크기와 반복 횟수
+ */
+#define BUFLEN (16*1024)
+#define ROUNDS 256
+#define BIGLEN (64*1024*1024)
+#define GCMTOTAL (16*1024*1024)
+#define GCMMAXLEN (64*1024)
+#define KEYROUNDS 100000
+
+static const char *engine_name[] = {"reference", "t-table", "aes-ni", "bitslice"};
+static const char *ghash_name[] = {"4bit-table", "pclmulqdq"};
+
+/*
+ * cycles() - 사이클 카운터를 읽는다.
+ * x86에서는 TSC(기준 클록)를 사용하고, 그 외에는 나노초를 사이클 대신 사용한다.
+ */
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * run() - buf를 ECB로 ROUNDS번 암호화(또는 복호화)하고 바이트당 사이클과 MB/s를 구한다.
+ */
+static void run(uint8_t *buf, const aes_ctx *ctx, int mode, double *cpb, double *mbps)
+{
+    uint64_t c0, c1;
+    double t0, t1;
+    int i;
+
+    t0 = seconds();
+    c0 = cycles();
+    for (i = 0; i < ROUNDS; ++i) {
+        if (mode == ENCRYPT)
+            aes_encrypt_blocks(ctx, buf, buf, BUFLEN / BLOCKLEN);
+        else
+            aes_decrypt_blocks(ctx, buf, buf, BUFLEN / BLOCKLEN);
+    }
+    c1 = cycles();
+    t1 = seconds();
+    *cpb = (double)(c1 - c0) / ((double)BUFLEN * ROUNDS);
+    *mbps = (double)BUFLEN * ROUNDS / (t1 - t0) / 1e6;
+}
+
+/*
+ * run_ctr() - 길이가 len인 buf를 CTR 모드로 rounds번 암호화하고 바이트당 사이클과 MB/s를 구한다.
+ */
+static void run_ctr(uint8_t *buf, size_t len, int rounds, const aes_ctx *ctx, double *cpb, double *mbps)
+{
+    uint8_t iv[BLOCKLEN] = {0};
+    uint64_t c0, c1;
+    double t0, t1;
+    int i;
+
+    t0 = seconds();
+    c0 = cycles();
+    for (i = 0; i < rounds; ++i)
+        aes_ctr(ctx, iv, buf, buf, len);
+    c1 = cycles();
+    t1 = seconds();
+    *cpb = (double)(c1 - c0) / ((double)len * rounds);
+    *mbps = (double)len * rounds / (t1 - t0) / 1e6;
+}
+
+/*
+ * run_key() - aes_init()을 KEYROUNDS번 호출해서 키 설정 한 번의 사이클을 구한다.
+ */
+static double run_key(const uint8_t *key, int keylen)
+{
+    aes_ctx ctx;
+    uint64_t c0, c1;
+    int i;
+
+    c0 = cycles();
+    for (i = 0; i < KEYROUNDS; ++i)
+        aes_init(&ctx, key, keylen);
+    c1 = cycles();
+    return (double)(c1 - c0) / KEYROUNDS;
+}
+
+/*
+ * run_cbc() - buf를 CBC로 ROUNDS번 암호화(또는 제자리 복호화)하고 바이트당 사이클과 MB/s를 구한다.
+ */
+static void run_cbc(uint8_t *buf, const aes_ctx *ctx, int mode, double *cpb, double *mbps)
+{
+    uint8_t iv[BLOCKLEN] = {0};
+    uint64_t c0, c1;
+    double t0, t1;
+    size_t outlen;
+    int i;
+
+    t0 = seconds();
+    c0 = cycles();
+    for (i = 0; i < ROUNDS; ++i) {
+        if (mode == ENCRYPT)
+            aes_cbc_encrypt(ctx, iv, buf, buf, BUFLEN, AES_PAD_NONE, &outlen);
+        else
+            aes_cbc_decrypt(ctx, iv, buf, buf, BUFLEN, AES_PAD_NONE, &outlen);
+    }
+    c1 = cycles();
+    t1 = seconds();
+    *cpb = (double)(c1 - c0) / ((double)BUFLEN * ROUNDS);
+    *mbps = (double)BUFLEN * ROUNDS / (t1 - t0) / 1e6;
+}
+
+/*
+ * run_gcm() - 길이가 len인 메시지를 AES-GCM으로 봉인하는 일을 총 GCMTOTAL 바이트만큼 반복한다.
+ */
+static void run_gcm(uint8_t *buf, size_t len, const aes_gcm_ctx *ctx, double *cpb, double *mbps)
+{
+    uint8_t iv[GCM_IVLEN] = {0}, aad[16] = {0}, tag[GCM_TAGLEN];
+    size_t i, n = GCMTOTAL / len;
+    uint64_t c0, c1;
+    double t0, t1;
+
+    t0 = seconds();
+    c0 = cycles();
+    for (i = 0; i < n; ++i) {
+        iv[0] = (uint8_t)i;
+        aes_gcm_seal(ctx, iv, GCM_IVLEN, aad, sizeof(aad), buf, len, buf, tag, GCM_TAGLEN);
+    }
+    c1 = cycles();
+    t1 = seconds();
+    *cpb = (double)(c1 - c0) / ((double)len * n);
+    *mbps = (double)len * n / (t1 - t0) / 1e6;
+}
+
+int main(void)
+{
+    uint8_t key[AES256_KEYLEN];
+    uint32_t roundKey[RNDKEYLEN], refKey[RNDKEYLEN];
+    static uint8_t ptxt[BUFLEN], buf[BUFLEN], ref[BUFLEN];
+    static const int keylen[3] = {AES128_KEYLEN, AES192_KEYLEN, AES256_KEYLEN};
+    uint8_t *big;
+    static const int gcm_len[3] = {64, 1024, GCMMAXLEN};
+    static uint8_t msg[GCMMAXLEN];
+    aes_ctx ctx;
+    aes_gcm_ctx gcm;
+    double cpb, mbps;
+    int engine, ghash, j, k;
+
+    arc4random_buf(key, AES256_KEYLEN);
+    arc4random_buf(ptxt, BUFLEN);
+
+    /*
+     * 모든 엔진이 기준 구현과 같은 라운드 키와 암호문을 만드는지 먼저 확인한다.
+     */
+    aes_set_engine(AES_ENGINE_REF);
+    KeyExpansion(key, refKey);
+    memcpy(ref, ptxt, BUFLEN);
+    for (j = 0; j < BUFLEN; j += BLOCKLEN)
+        Cipher(ref + j, refKey, ENCRYPT);
+    for (engine = AES_ENGINE_TTABLE; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        KeyExpansion(key, roundKey);
+        memcpy(buf, ptxt, BUFLEN);
+        for (j = 0; j < BUFLEN; j += BLOCKLEN)
+            Cipher(buf + j, roundKey, ENCRYPT);
+        if (memcmp(roundKey, refKey, sizeof(refKey)) || memcmp(buf, ref, BUFLEN)) {
+            printf("%s 엔진 결과 불일치 .....FAILED\n", engine_name[engine]);
+            return 1;
+        }
+    }
+
+    /*
+     * 엔진과 키 길이별로 암호화와 복호화의 바이트당 사이클을 측정한다.
+     * CPU가 지원하지 않는 엔진은 건너뛴다.
+     */
+    printf("%-10s %-4s %-8s %12s %12s\n", "engine", "key", "mode", "cycles/byte", "MB/s");
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        for (k = 0; k < 3; ++k) {
+            aes_init(&ctx, key, keylen[k]);
+            memcpy(buf, ptxt, BUFLEN);
+            run(buf, &ctx, ENCRYPT, &cpb, &mbps);
+            printf("%-10s %-4d %-8s %12.2f %12.1f\n", engine_name[engine], keylen[k]*8, "encrypt", cpb, mbps);
+            run(buf, &ctx, DECRYPT, &cpb, &mbps);
+            printf("%-10s %-4d %-8s %12.2f %12.1f\n", engine_name[engine], keylen[k]*8, "decrypt", cpb, mbps);
+            if (memcmp(buf, ptxt, BUFLEN)) {
+                printf("%s AES-%d 복호문 불일치 .....FAILED\n", engine_name[engine], keylen[k]*8);
+                return 1;
+            }
+        }
+    }
+
+    /*
+     * 엔진과 키 길이별 키 설정(암호화/복호화 라운드 키 생성) 비용
+     */
+    printf("\n%-10s %-4s %12s\n", "engine", "key", "cycles/key");
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        for (k = 0; k < 3; ++k)
+            printf("%-10s %-4d %12.1f\n", engine_name[engine], keylen[k]*8, run_key(key, keylen[k]));
+    }
+
+    /*
+     * 엔진별 CBC 모드 성능: 암호화는 한 블록씩, 복호화는 AES_PIPE_BLOCKS개씩 함께 처리된다.
+     */
+    printf("\n%-10s %-4s %-8s %12s %12s\n", "engine", "key", "CBC", "cycles/byte", "MB/s");
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        aes_init(&ctx, key, AES128_KEYLEN);
+        memcpy(buf, ptxt, BUFLEN);
+        run_cbc(buf, &ctx, ENCRYPT, &cpb, &mbps);
+        printf("%-10s %-4d %-8s %12.2f %12.1f\n", engine_name[engine], 128, "encrypt", cpb, mbps);
+        run_cbc(buf, &ctx, DECRYPT, &cpb, &mbps);
+        printf("%-10s %-4d %-8s %12.2f %12.1f\n", engine_name[engine], 128, "decrypt", cpb, mbps);
+        if (memcmp(buf, ptxt, BUFLEN)) {
+            printf("%s CBC 복호문 불일치 .....FAILED\n", engine_name[engine]);
+            return 1;
+        }
+    }
+
+    /*
+     * 엔진별 CTR 모드 성능: 16KiB 버퍼는 한 스레드로, 64MiB 버퍼는 여러 스레드로 처리된다.
+     */
+    big = malloc(BIGLEN);
+    if (big == NULL)
+        return 1;
+    memset(big, 0, BIGLEN);
+    printf("\n%-10s %-4s %-8s %12s %12s\n", "engine", "key", "CTR", "cycles/byte", "MB/s");
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        aes_init(&ctx, key, AES128_KEYLEN);
+        run_ctr(buf, BUFLEN, ROUNDS, &ctx, &cpb, &mbps);
+        printf("%-10s %-4d %-8s %12.2f %12.1f\n", engine_name[engine], 128, "16KiB", cpb, mbps);
+        run_ctr(big, BIGLEN, engine == AES_ENGINE_REF ? 1 : 4, &ctx, &cpb, &mbps);
+        printf("%-10s %-4d %-8s %12.2f %12.1f\n", engine_name[engine], 128, "64MiB", cpb, mbps);
+    }
+    free(big);
+    aes_set_engine(AES_ENGINE_AUTO);
+
+    /*
+     * GHASH 구현별 AES-GCM 봉인 성능 (AES 엔진은 자동 선택, 16바이트 AAD)
+     */
+    printf("\n%-10s %-10s %8s %12s %12s\n", "engine", "ghash", "msg", "cycles/byte", "MB/s");
+    aes_gcm_init(&gcm, key, AES128_KEYLEN);
+    for (ghash = GCM_GHASH_TABLE; ghash <= GCM_GHASH_PCLMUL; ++ghash) {
+        if (aes_gcm_set_ghash(ghash) != 0)
+            continue;
+        for (k = 0; k < 3; ++k) {
+            run_gcm(msg, gcm_len[k], &gcm, &cpb, &mbps);
+            printf("%-10s %-10s %8d %12.2f %12.1f\n", engine_name[aes_get_engine()], ghash_name[ghash],
+                   gcm_len[k], cpb, mbps);
+        }
+    }
+    aes_gcm_set_ghash(GCM_GHASH_AUTO);
+
+    return 0;
+}
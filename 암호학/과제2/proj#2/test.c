@@ -15,6 +15,23 @@
 #include <stdlib.h>
 #endif
 #include "aes.h"
+#include "gcm.h"
+
+/*
+ * 여러 스레드로 나누어 처리되는 CTR 버퍼 크기 (AES_PARALLEL_MIN보다 크고 블록 단위가 아님)
+ * 스레드를 8개로 정해도 AES_THREAD_MIN 때문에 4개로 나누어진다.
+ */
+#define BIGLEN (AES_PARALLEL_MIN + 5)
+
+/*
+ * 비트 슬라이스 엔진 시험의 블록 수 (8블록 단위 두 번과 남는 블록)
+ */
+#define ECBBLOCKS 21
+
+/*
+ * 두 GHASH 구현을 비교할 무작위 메시지의 최대 길이
+ */
+#define GCMLEN (64*1024)
 
 /*
  *  ================= 128 비트 AES 검증 데이터 =================
@@ -43,11 +60,192 @@ uint32_t rkey[RNDKEYLEN] = {0xc971150f,0x59e8d947,0xd6adb70c,0x98677faf,0xb03790
 uint8_t ptxt[BLOCKLEN] = {0x01,0x23,0x45,0x67,0x89,0xab,0xcd,0xef,0xfe,0xdc,0xba,0x98,0x76,0x54,0x32,0x10};
 uint8_t ctxt[BLOCKLEN] = {0xff,0x0b,0x84,0x4a,0x08,0x53,0xbf,0x7c,0x69,0x34,0xab,0x43,0x64,0x14,0x8f,0xb9};
 
+/*
+ * FIPS-197 부록 A(키 확장)와 부록 C(암호화 예제)의 AES-128, AES-192, AES-256 검증용 벡터값
+ * fips_w는 마지막 라운드 키 워드 w[Nb*(Nr+1)-1]의 바이트이다.
+ */
+const uint8_t fips_ptxt[BLOCKLEN] = {0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,0x88,0x99,0xaa,0xbb,0xcc,0xdd,0xee,0xff};
+const uint8_t fips_ctxt[3][BLOCKLEN] = {
+    {0x69,0xc4,0xe0,0xd8,0x6a,0x7b,0x04,0x30,0xd8,0xcd,0xb7,0x80,0x70,0xb4,0xc5,0x5a},
+    {0xdd,0xa9,0x7c,0xa4,0x86,0x4c,0xdf,0xe0,0x6e,0xaf,0x70,0xa0,0xec,0x0d,0x71,0x91},
+    {0x8e,0xa2,0xb7,0xca,0x51,0x67,0x45,0xbf,0xea,0xfc,0x49,0x90,0x4b,0x49,0x60,0x89}};
+const uint8_t fips_akey[3][AES256_KEYLEN] = {
+    {0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c},
+    {0x8e,0x73,0xb0,0xf7,0xda,0x0e,0x64,0x52,0xc8,0x10,0xf3,0x2b,0x80,0x90,0x79,0xe5,
+     0x62,0xf8,0xea,0xd2,0x52,0x2c,0x6b,0x7b},
+    {0x60,0x3d,0xeb,0x10,0x15,0xca,0x71,0xbe,0x2b,0x73,0xae,0xf0,0x85,0x7d,0x77,0x81,
+     0x1f,0x35,0x2c,0x07,0x3b,0x61,0x08,0xd7,0x2d,0x98,0x10,0xa3,0x09,0x14,0xdf,0xf4}};
+const uint8_t fips_w[3][4] = {{0xb6,0x63,0x0c,0xa6}, {0x01,0x00,0x22,0x02}, {0x70,0x6c,0x63,0x1e}};
+const int fips_keylen[3] = {AES128_KEYLEN, AES192_KEYLEN, AES256_KEYLEN};
+
+/*
+ * NIST SP 800-38A F.5.1 CTR-AES128 검증용 벡터값과
+ * 카운터의 하위 64비트가 넘칠 때 상위로 올림되는지 확인하는 벡터값 (키 00 01 .. 0f, 평문 0)
+ */
+const uint8_t ctr_key[AES128_KEYLEN] = {0x2b,0x7e,0x15,0x16,0x28,0xae,0xd2,0xa6,0xab,0xf7,0x15,0x88,0x09,0xcf,0x4f,0x3c};
+const uint8_t ctr_iv[BLOCKLEN] = {0xf0,0xf1,0xf2,0xf3,0xf4,0xf5,0xf6,0xf7,0xf8,0xf9,0xfa,0xfb,0xfc,0xfd,0xfe,0xff};
+const uint8_t ctr_ptxt[4*BLOCKLEN] = {
+    0x6b,0xc1,0xbe,0xe2,0x2e,0x40,0x9f,0x96,0xe9,0x3d,0x7e,0x11,0x73,0x93,0x17,0x2a,
+    0xae,0x2d,0x8a,0x57,0x1e,0x03,0xac,0x9c,0x9e,0xb7,0x6f,0xac,0x45,0xaf,0x8e,0x51,
+    0x30,0xc8,0x1c,0x46,0xa3,0x5c,0xe4,0x11,0xe5,0xfb,0xc1,0x19,0x1a,0x0a,0x52,0xef,
+    0xf6,0x9f,0x24,0x45,0xdf,0x4f,0x9b,0x17,0xad,0x2b,0x41,0x7b,0xe6,0x6c,0x37,0x10};
+const uint8_t ctr_ctxt[4*BLOCKLEN] = {
+    0x87,0x4d,0x61,0x91,0xb6,0x20,0xe3,0x26,0x1b,0xef,0x68,0x64,0x99,0x0d,0xb6,0xce,
+    0x98,0x06,0xf6,0x6b,0x79,0x70,0xfd,0xff,0x86,0x17,0x18,0x7b,0xb9,0xff,0xfd,0xff,
+    0x5a,0xe4,0xdf,0x3e,0xdb,0xd5,0xd3,0x5e,0x5b,0x4f,0x09,0x02,0x0d,0xb0,0x3e,0xab,
+    0x1e,0x03,0x1d,0xda,0x2f,0xbe,0x03,0xd1,0x79,0x21,0x70,0xa0,0xf3,0x00,0x9c,0xee};
+const uint8_t carry_iv[BLOCKLEN] = {0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xfe};
+const uint8_t carry_ks[3*BLOCKLEN] = {
+    0x71,0xa7,0xd6,0x5a,0xf2,0xae,0x7a,0x26,0x01,0x76,0xad,0x0a,0x18,0x1c,0x8c,0x77,
+    0x00,0x83,0xd9,0xce,0x48,0xe6,0x53,0x91,0x16,0xbe,0xf6,0x05,0x58,0x32,0x3f,0x62,
+    0xba,0x3c,0x8c,0x14,0xec,0xef,0xe3,0x87,0xd0,0x4b,0x2c,0xab,0x35,0xe9,0x98,0x85};
+
+/*
+ * NIST SP 800-38A F.1.1 ECB-AES128, F.2.1 CBC-AES128, F.3.13 CFB128-AES128, F.4.1 OFB-AES128
+ * 검증용 벡터값 (키와 평문은 CTR 벡터와 같다)
+ */
+const uint8_t mode_iv[BLOCKLEN] = {0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f};
+const uint8_t ecb_ctxt[4*BLOCKLEN] = {
+    0x3a,0xd7,0x7b,0xb4,0x0d,0x7a,0x36,0x60,0xa8,0x9e,0xca,0xf3,0x24,0x66,0xef,0x97,
+    0xf5,0xd3,0xd5,0x85,0x03,0xb9,0x69,0x9d,0xe7,0x85,0x89,0x5a,0x96,0xfd,0xba,0xaf,
+    0x43,0xb1,0xcd,0x7f,0x59,0x8e,0xce,0x23,0x88,0x1b,0x00,0xe3,0xed,0x03,0x06,0x88,
+    0x7b,0x0c,0x78,0x5e,0x27,0xe8,0xad,0x3f,0x82,0x23,0x20,0x71,0x04,0x72,0x5d,0xd4};
+const uint8_t cbc_ctxt[4*BLOCKLEN] = {
+    0x76,0x49,0xab,0xac,0x81,0x19,0xb2,0x46,0xce,0xe9,0x8e,0x9b,0x12,0xe9,0x19,0x7d,
+    0x50,0x86,0xcb,0x9b,0x50,0x72,0x19,0xee,0x95,0xdb,0x11,0x3a,0x91,0x76,0x78,0xb2,
+    0x73,0xbe,0xd6,0xb8,0xe3,0xc1,0x74,0x3b,0x71,0x16,0xe6,0x9e,0x22,0x22,0x95,0x16,
+    0x3f,0xf1,0xca,0xa1,0x68,0x1f,0xac,0x09,0x12,0x0e,0xca,0x30,0x75,0x86,0xe1,0xa7};
+const uint8_t cfb_ctxt[4*BLOCKLEN] = {
+    0x3b,0x3f,0xd9,0x2e,0xb7,0x2d,0xad,0x20,0x33,0x34,0x49,0xf8,0xe8,0x3c,0xfb,0x4a,
+    0xc8,0xa6,0x45,0x37,0xa0,0xb3,0xa9,0x3f,0xcd,0xe3,0xcd,0xad,0x9f,0x1c,0xe5,0x8b,
+    0x26,0x75,0x1f,0x67,0xa3,0xcb,0xb1,0x40,0xb1,0x80,0x8c,0xf1,0x87,0xa4,0xf4,0xdf,
+    0xc0,0x4b,0x05,0x35,0x7c,0x5d,0x1c,0x0e,0xea,0xc4,0xc6,0x6f,0x9f,0xf7,0xf2,0xe6};
+const uint8_t ofb_ctxt[4*BLOCKLEN] = {
+    0x3b,0x3f,0xd9,0x2e,0xb7,0x2d,0xad,0x20,0x33,0x34,0x49,0xf8,0xe8,0x3c,0xfb,0x4a,
+    0x77,0x89,0x50,0x8d,0x16,0x91,0x8f,0x03,0xf5,0x3c,0x52,0xda,0xc5,0x4e,0xd8,0x25,
+    0x97,0x40,0x05,0x1e,0x9c,0x5f,0xec,0xf6,0x43,0x44,0xf7,0xa8,0x22,0x60,0xed,0xcc,
+    0x30,0x4c,0x65,0x28,0xf6,0x59,0xc7,0x78,0x66,0xa5,0x10,0xd9,0xc1,0xd6,0xae,0x5e};
+
+/*
+ * GCM 규격서(McGrew, Viega)의 AES-GCM 검증용 벡터값 (NIST SP 800-38D 시험 벡터와 같다)
+ * Test Case 6은 96비트가 아닌 IV, Test Case 16은 256비트 키이다.
+ * 마지막 벡터는 J0의 하위 32비트가 fffffffe가 되도록 고른 128비트 IV로, 두 번째 블록에서 카운터가
+ * 0으로 돌아간다 (상위 96비트는 그대로). 값은 OpenSSL의 AES-ECB와 따로 작성한 GHASH로 계산했다.
+ */
+struct gcm_vector {
+    int keylen, ivlen, aadlen, len;
+    uint8_t key[AES256_KEYLEN], iv[64], aad[20], ptxt[64], ctxt[64], tag[GCM_TAGLEN];
+};
+const struct gcm_vector gcm_vec[] = {
+    /* Test Case 1 */
+    {16, 12, 0, 0,
+     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+     {0},
+     {0},
+     {0},
+     {0x58,0xe2,0xfc,0xce,0xfa,0x7e,0x30,0x61,0x36,0x7f,0x1d,0x57,0xa4,0xe7,0x45,0x5a}},
+    /* Test Case 2 */
+    {16, 12, 0, 16,
+     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+     {0},
+     {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+     {0x03,0x88,0xda,0xce,0x60,0xb6,0xa3,0x92,0xf3,0x28,0xc2,0xb9,0x71,0xb2,0xfe,0x78},
+     {0xab,0x6e,0x47,0xd4,0x2c,0xec,0x13,0xbd,0xf5,0x3a,0x67,0xb2,0x12,0x57,0xbd,0xdf}},
+    /* Test Case 3 */
+    {16, 12, 0, 64,
+     {0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08},
+     {0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88},
+     {0},
+     {0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+     0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+     0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+     0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39,0x1a,0xaf,0xd2,0x55},
+     {0x42,0x83,0x1e,0xc2,0x21,0x77,0x74,0x24,0x4b,0x72,0x21,0xb7,0x84,0xd0,0xd4,0x9c,
+     0xe3,0xaa,0x21,0x2f,0x2c,0x02,0xa4,0xe0,0x35,0xc1,0x7e,0x23,0x29,0xac,0xa1,0x2e,
+     0x21,0xd5,0x14,0xb2,0x54,0x66,0x93,0x1c,0x7d,0x8f,0x6a,0x5a,0xac,0x84,0xaa,0x05,
+     0x1b,0xa3,0x0b,0x39,0x6a,0x0a,0xac,0x97,0x3d,0x58,0xe0,0x91,0x47,0x3f,0x59,0x85},
+     {0x4d,0x5c,0x2a,0xf3,0x27,0xcd,0x64,0xa6,0x2c,0xf3,0x5a,0xbd,0x2b,0xa6,0xfa,0xb4}},
+    /* Test Case 4 */
+    {16, 12, 20, 60,
+     {0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08},
+     {0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88},
+     {0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,
+     0xab,0xad,0xda,0xd2},
+     {0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+     0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+     0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+     0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39},
+     {0x42,0x83,0x1e,0xc2,0x21,0x77,0x74,0x24,0x4b,0x72,0x21,0xb7,0x84,0xd0,0xd4,0x9c,
+     0xe3,0xaa,0x21,0x2f,0x2c,0x02,0xa4,0xe0,0x35,0xc1,0x7e,0x23,0x29,0xac,0xa1,0x2e,
+     0x21,0xd5,0x14,0xb2,0x54,0x66,0x93,0x1c,0x7d,0x8f,0x6a,0x5a,0xac,0x84,0xaa,0x05,
+     0x1b,0xa3,0x0b,0x39,0x6a,0x0a,0xac,0x97,0x3d,0x58,0xe0,0x91},
+     {0x5b,0xc9,0x4f,0xbc,0x32,0x21,0xa5,0xdb,0x94,0xfa,0xe9,0x5a,0xe7,0x12,0x1a,0x47}},
+    /* Test Case 6 */
+    {16, 60, 20, 60,
+     {0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08},
+     {0x93,0x13,0x22,0x5d,0xf8,0x84,0x06,0xe5,0x55,0x90,0x9c,0x5a,0xff,0x52,0x69,0xaa,
+     0x6a,0x7a,0x95,0x38,0x53,0x4f,0x7d,0xa1,0xe4,0xc3,0x03,0xd2,0xa3,0x18,0xa7,0x28,
+     0xc3,0xc0,0xc9,0x51,0x56,0x80,0x95,0x39,0xfc,0xf0,0xe2,0x42,0x9a,0x6b,0x52,0x54,
+     0x16,0xae,0xdb,0xf5,0xa0,0xde,0x6a,0x57,0xa6,0x37,0xb3,0x9b},
+     {0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,
+     0xab,0xad,0xda,0xd2},
+     {0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+     0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+     0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+     0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39},
+     {0x8c,0xe2,0x49,0x98,0x62,0x56,0x15,0xb6,0x03,0xa0,0x33,0xac,0xa1,0x3f,0xb8,0x94,
+     0xbe,0x91,0x12,0xa5,0xc3,0xa2,0x11,0xa8,0xba,0x26,0x2a,0x3c,0xca,0x7e,0x2c,0xa7,
+     0x01,0xe4,0xa9,0xa4,0xfb,0xa4,0x3c,0x90,0xcc,0xdc,0xb2,0x81,0xd4,0x8c,0x7c,0x6f,
+     0xd6,0x28,0x75,0xd2,0xac,0xa4,0x17,0x03,0x4c,0x34,0xae,0xe5},
+     {0x61,0x9c,0xc5,0xae,0xff,0xfe,0x0b,0xfa,0x46,0x2a,0xf4,0x3c,0x16,0x99,0xd0,0x50}},
+    /* Test Case 16 */
+    {32, 12, 20, 60,
+     {0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08,
+     0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08},
+     {0xca,0xfe,0xba,0xbe,0xfa,0xce,0xdb,0xad,0xde,0xca,0xf8,0x88},
+     {0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,
+     0xab,0xad,0xda,0xd2},
+     {0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+     0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+     0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+     0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39},
+     {0x52,0x2d,0xc1,0xf0,0x99,0x56,0x7d,0x07,0xf4,0x7f,0x37,0xa3,0x2a,0x84,0x42,0x7d,
+     0x64,0x3a,0x8c,0xdc,0xbf,0xe5,0xc0,0xc9,0x75,0x98,0xa2,0xbd,0x25,0x55,0xd1,0xaa,
+     0x8c,0xb0,0x8e,0x48,0x59,0x0d,0xbb,0x3d,0xa7,0xb0,0x8b,0x10,0x56,0x82,0x88,0x38,
+     0xc5,0xf6,0x1e,0x63,0x93,0xba,0x7a,0x0a,0xbc,0xc9,0xf6,0x62},
+     {0x76,0xfc,0x6e,0xce,0x0f,0x4e,0x17,0x68,0xcd,0xdf,0x88,0x53,0xbb,0x2d,0x55,0x1b}},
+    /* 32비트 카운터 넘침 (J0 = cafebabe facedbad decaf888 fffffffe) */
+    {16, 16, 20, 60,
+     {0xfe,0xff,0xe9,0x92,0x86,0x65,0x73,0x1c,0x6d,0x6a,0x8f,0x94,0x67,0x30,0x83,0x08},
+     {0xaa,0x41,0x4a,0x69,0x92,0xb0,0x02,0x9d,0xcf,0x5c,0x41,0xda,0x2a,0x97,0x7f,0x2a},
+     {0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,0xfe,0xed,0xfa,0xce,0xde,0xad,0xbe,0xef,
+     0xab,0xad,0xda,0xd2},
+     {0xd9,0x31,0x32,0x25,0xf8,0x84,0x06,0xe5,0xa5,0x59,0x09,0xc5,0xaf,0xf5,0x26,0x9a,
+     0x86,0xa7,0xa9,0x53,0x15,0x34,0xf7,0xda,0x2e,0x4c,0x30,0x3d,0x8a,0x31,0x8a,0x72,
+     0x1c,0x3c,0x0c,0x95,0x95,0x68,0x09,0x53,0x2f,0xcf,0x0e,0x24,0x49,0xa6,0xb5,0x25,
+     0xb1,0x6a,0xed,0xf5,0xaa,0x0d,0xe6,0x57,0xba,0x63,0x7b,0x39},
+     {0x77,0xff,0xd1,0xba,0x63,0xb1,0x41,0xba,0xfb,0x2e,0xfb,0x32,0x9c,0x9c,0x25,0xee,
+     0x99,0xe5,0xe0,0x6e,0x60,0x3d,0xd5,0xc6,0x8e,0xfe,0x1c,0xb2,0xce,0xfc,0x06,0x77,
+     0x2e,0x7b,0x14,0xde,0xa9,0x27,0x60,0xf7,0x62,0x73,0xdc,0x0c,0xce,0x1d,0x01,0x3d,
+     0x2a,0xd8,0xc1,0x12,0x73,0xfe,0x94,0x96,0x54,0x48,0x53,0x4b},
+     {0xe4,0x78,0x7c,0xb0,0x89,0xfd,0xd0,0x1f,0x1c,0xe6,0xab,0x0e,0x7a,0x4e,0xea,0xa6}}
+};
+
 int main(void)
 {
     uint32_t roundKey[RNDKEYLEN];
-    uint8_t *p, buf[BLOCKLEN];
-    int i, count;
+    uint8_t *p, buf[BLOCKLEN], buf2[BLOCKLEN], key2[AES256_KEYLEN];
+    uint8_t ctr_buf[4*BLOCKLEN], *big;
+    uint8_t ecb_ptxt[ECBBLOCKS*BLOCKLEN], ecb_ref[ECBBLOCKS*BLOCKLEN], ecb_buf[ECBBLOCKS*BLOCKLEN];
+    uint8_t gcm_buf[64], tag[GCM_TAGLEN], tag2[GCM_TAGLEN];
+    uint8_t pad_buf[ECBBLOCKS*BLOCKLEN + BLOCKLEN], pad_ref[ECBBLOCKS*BLOCKLEN + BLOCKLEN];
+    size_t outlen;
+    aes_gcm_ctx gcm;
+    aes_ctx ctx, ctx2;
+    aes_ctr_ctx ctr;
+    int i, j, engine, ghash, count;
     clock_t start, end;
     double cpu_time;
 
@@ -107,6 +305,343 @@ int main(void)
     for (i = 0; i < BLOCKLEN; ++i)
         printf("%02x ", buf[i]);
     printf(".....PASSED\n");
+    /*
+     * 문맥(aes_ctx) 시험: 서로 다른 키의 두 문맥을 번갈아 사용해도 결과가 섞이지 않아야 한다.
+     */
+    printf("---\n문맥 API 시험");
+    arc4random_buf(key2, KEYLEN);
+    if (aes_init(&ctx, key, KEYLEN) || aes_init(&ctx2, key2, KEYLEN)) {
+        printf(".....FAILED: aes_init 실패\n");
+        return 1;
+    }
+    if (memcmp(ctx.roundKey, rkey, sizeof(rkey))) {
+        printf(".....FAILED: 라운드 키 불일치\n");
+        return 1;
+    }
+    aes_encrypt_block(&ctx, ptxt, buf);
+    aes_encrypt_block(&ctx2, ptxt, buf2);
+    if (memcmp(buf, ctxt, BLOCKLEN)) {
+        printf(".....FAILED: 암호문 불일치\n");
+        return 1;
+    }
+    aes_decrypt_block(&ctx2, buf2, buf2);
+    aes_decrypt_block(&ctx, buf, buf);
+    if (memcmp(buf, ptxt, BLOCKLEN) || memcmp(buf2, ptxt, BLOCKLEN)) {
+        printf(".....FAILED: 복호문 불일치\n");
+        return 1;
+    }
+    // 문맥은 aes_init()할 때의 엔진을 계속 쓰므로, 나중에 엔진을 바꿔도 결과가 같아야 한다.
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        aes_init(&ctx2, key, KEYLEN);
+        for (j = AES_ENGINE_REF; j <= AES_ENGINE_BITSLICE; ++j) {
+            if (aes_set_engine(j) != 0)
+                continue;
+            aes_encrypt_block(&ctx2, ptxt, buf);
+            aes_decrypt_block(&ctx2, buf, buf2);
+            if (ctx2.engine != engine || memcmp(buf, ctxt, BLOCKLEN) || memcmp(buf2, ptxt, BLOCKLEN)) {
+                printf(".....FAILED: 엔진을 바꾼 뒤 문맥 결과 불일치\n");
+                return 1;
+            }
+        }
+    }
+    aes_set_engine(AES_ENGINE_AUTO);
+    printf(".....PASSED\n");
+    /*
+     * FIPS-197 시험: 세 가지 키 길이를 사용할 수 있는 모든 엔진으로 확인한다.
+     */
+    printf("---\nFIPS-197 AES-128/192/256 시험");
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        for (i = 0; i < 3; ++i) {
+            if (aes_init(&ctx, fips_akey[i], fips_keylen[i]) ||
+                memcmp(ctx.roundKey + Nb*(ctx.nr+1) - 1, fips_w[i], 4)) {
+                printf(".....FAILED: AES-%d 라운드 키 불일치\n", fips_keylen[i]*8);
+                return 1;
+            }
+            for (j = 0; j < fips_keylen[i]; ++j)
+                key2[j] = (uint8_t)j;
+            aes_init(&ctx, key2, fips_keylen[i]);
+            aes_encrypt_block(&ctx, fips_ptxt, buf);
+            if (memcmp(buf, fips_ctxt[i], BLOCKLEN)) {
+                printf(".....FAILED: AES-%d 암호문 불일치\n", fips_keylen[i]*8);
+                return 1;
+            }
+            aes_decrypt_block(&ctx, buf, buf);
+            if (memcmp(buf, fips_ptxt, BLOCKLEN)) {
+                printf(".....FAILED: AES-%d 복호문 불일치\n", fips_keylen[i]*8);
+                return 1;
+            }
+        }
+    }
+    aes_set_engine(AES_ENGINE_AUTO);
+    if (aes_init(&ctx, key2, 20) != -1) {
+        printf(".....FAILED: 잘못된 키 길이\n");
+        return 1;
+    }
+    printf(".....PASSED\n");
+    /*
+     * 비트 슬라이스 엔진 시험: 테이블 없이 만든 라운드 키, 8블록 단위와 남는 블록,
+     * 기존 Cipher() 인터페이스의 결과가 기준 구현과 같은지 확인한다.
+     */
+    printf("---\n비트 슬라이스 엔진 시험");
+    arc4random_buf(ecb_ptxt, sizeof(ecb_ptxt));
+    arc4random_buf(key2, AES256_KEYLEN);
+    for (i = 0; i < 3; ++i) {
+        aes_set_engine(AES_ENGINE_REF);
+        aes_init(&ctx, key2, fips_keylen[i]);
+        for (j = 0; j < ECBBLOCKS; ++j)
+            aes_encrypt_block(&ctx, ecb_ptxt + j*BLOCKLEN, ecb_ref + j*BLOCKLEN);
+        if (aes_set_engine(AES_ENGINE_BITSLICE) != 0)
+            break;
+        aes_init(&ctx2, key2, fips_keylen[i]);
+        if (memcmp(ctx2.roundKey, ctx.roundKey, Nb*(ctx.nr+1)*sizeof(uint32_t)) ||
+            memcmp(ctx2.droundKey, ctx.droundKey, Nb*(ctx.nr+1)*sizeof(uint32_t))) {
+            printf(".....FAILED: AES-%d 키 확장 불일치\n", fips_keylen[i]*8);
+            return 1;
+        }
+        aes_encrypt_blocks(&ctx2, ecb_ptxt, ecb_buf, ECBBLOCKS);
+        if (memcmp(ecb_buf, ecb_ref, sizeof(ecb_ref))) {
+            printf(".....FAILED: AES-%d 암호문 불일치\n", fips_keylen[i]*8);
+            return 1;
+        }
+        aes_decrypt_blocks(&ctx2, ecb_buf, ecb_buf, ECBBLOCKS);
+        if (memcmp(ecb_buf, ecb_ptxt, sizeof(ecb_ptxt))) {
+            printf(".....FAILED: AES-%d 복호문 불일치\n", fips_keylen[i]*8);
+            return 1;
+        }
+    }
+    KeyExpansion(key, roundKey);
+    memcpy(buf, ptxt, BLOCKLEN);
+    Cipher(buf, roundKey, ENCRYPT);
+    memcpy(buf2, buf, BLOCKLEN);
+    Cipher(buf, roundKey, DECRYPT);
+    aes_set_engine(AES_ENGINE_AUTO);
+    aes_init(&ctx, key, KEYLEN);
+    aes_encrypt_block(&ctx, ptxt, ecb_buf);
+    if (memcmp(buf2, ecb_buf, BLOCKLEN) || memcmp(buf, ptxt, BLOCKLEN)) {
+        printf(".....FAILED: Cipher() 불일치\n");
+        return 1;
+    }
+    printf(".....PASSED\n");
+    /*
+     * CTR 모드 시험: 사용할 수 있는 모든 엔진으로 NIST 벡터를 한 번에, 그리고 여러 조각으로 나누어
+     * 처리해 보고, 카운터 올림과 여러 스레드로 나눈 큰 버퍼의 결과도 확인한다.
+     */
+    printf("---\nCTR 모드 시험");
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        aes_init(&ctx, ctr_key, AES128_KEYLEN);
+        aes_ctr(&ctx, ctr_iv, ctr_ptxt, ctr_buf, sizeof(ctr_ptxt));
+        if (memcmp(ctr_buf, ctr_ctxt, sizeof(ctr_ctxt))) {
+            printf(".....FAILED: 암호문 불일치\n");
+            return 1;
+        }
+        aes_ctr_init(&ctr, &ctx, ctr_iv);
+        for (i = 0, j = 1; i < 4*BLOCKLEN; i += j, j += 2)
+            aes_ctr_update(&ctr, ctr_buf + i, ctr_buf + i, i + j > 4*BLOCKLEN ? 4*BLOCKLEN - i : j);
+        if (memcmp(ctr_buf, ctr_ptxt, sizeof(ctr_ptxt))) {
+            printf(".....FAILED: 복호문 불일치\n");
+            return 1;
+        }
+        for (i = 0; i < AES128_KEYLEN; ++i)
+            key2[i] = (uint8_t)i;
+        aes_init(&ctx, key2, AES128_KEYLEN);
+        memset(ctr_buf, 0, sizeof(carry_ks));
+        aes_ctr(&ctx, carry_iv, ctr_buf, ctr_buf, sizeof(carry_ks));
+        if (memcmp(ctr_buf, carry_ks, sizeof(carry_ks))) {
+            printf(".....FAILED: 카운터 올림 불일치\n");
+            return 1;
+        }
+    }
+    aes_set_engine(AES_ENGINE_AUTO);
+    big = malloc(2 * BIGLEN);
+    if (big == NULL) {
+        printf(".....FAILED: 메모리 부족\n");
+        return 1;
+    }
+    arc4random_buf(big, BIGLEN);
+    aes_set_threads(1);
+    aes_ctr(&ctx, carry_iv, big, big + BIGLEN, BIGLEN);
+    aes_set_threads(8);
+    aes_ctr(&ctx, carry_iv, big, big, BIGLEN);
+    aes_set_threads(0);
+    if (memcmp(big, big + BIGLEN, BIGLEN)) {
+        printf(".....FAILED: 병렬 처리 결과 불일치\n");
+        return 1;
+    }
+    free(big);
+    printf(".....PASSED\n");
+    /*
+     * 운용 모드 시험: 사용할 수 있는 모든 엔진으로 ECB, CBC, CFB, OFB 벡터를 확인하고(복호화는 제자리),
+     * 8블록 묶음을 넘는 CBC/CFB 복호화를 블록 단위 계산과 비교한다. PKCS#7 패딩은 모든 나머지
+     * 길이에 대해 붙이고 떼어 보고, 잘못된 패딩과 길이를 거부하는지 확인한다.
+     */
+    printf("---\n운용 모드 시험");
+    arc4random_buf(ecb_ptxt, sizeof(ecb_ptxt));
+    for (engine = AES_ENGINE_REF; engine <= AES_ENGINE_BITSLICE; ++engine) {
+        if (aes_set_engine(engine) != 0)
+            continue;
+        aes_init(&ctx, ctr_key, AES128_KEYLEN);
+        if (aes_ecb_encrypt(&ctx, ctr_ptxt, ctr_buf, sizeof(ctr_ptxt), AES_PAD_NONE, &outlen) ||
+            outlen != sizeof(ctr_ptxt) || memcmp(ctr_buf, ecb_ctxt, sizeof(ecb_ctxt)) ||
+            aes_ecb_decrypt(&ctx, ctr_buf, ctr_buf, sizeof(ctr_buf), AES_PAD_NONE, &outlen) ||
+            memcmp(ctr_buf, ctr_ptxt, sizeof(ctr_ptxt))) {
+            printf(".....FAILED: ECB 불일치\n");
+            return 1;
+        }
+        if (aes_cbc_encrypt(&ctx, mode_iv, ctr_ptxt, ctr_buf, sizeof(ctr_ptxt), AES_PAD_NONE, &outlen) ||
+            outlen != sizeof(ctr_ptxt) || memcmp(ctr_buf, cbc_ctxt, sizeof(cbc_ctxt)) ||
+            aes_cbc_decrypt(&ctx, mode_iv, ctr_buf, ctr_buf, sizeof(ctr_buf), AES_PAD_NONE, &outlen) ||
+            memcmp(ctr_buf, ctr_ptxt, sizeof(ctr_ptxt))) {
+            printf(".....FAILED: CBC 불일치\n");
+            return 1;
+        }
+        for (j = 4*BLOCKLEN; j > 4*BLOCKLEN - 2*BLOCKLEN; j -= 13) {
+            aes_cfb_encrypt(&ctx, mode_iv, ctr_ptxt, ctr_buf, j);
+            if (memcmp(ctr_buf, cfb_ctxt, j)) {
+                printf(".....FAILED: CFB 암호문 불일치\n");
+                return 1;
+            }
+            aes_cfb_decrypt(&ctx, mode_iv, ctr_buf, ctr_buf, j);
+            if (memcmp(ctr_buf, ctr_ptxt, j)) {
+                printf(".....FAILED: CFB 복호문 불일치\n");
+                return 1;
+            }
+            aes_ofb(&ctx, mode_iv, ctr_ptxt, ctr_buf, j);
+            if (memcmp(ctr_buf, ofb_ctxt, j)) {
+                printf(".....FAILED: OFB 암호문 불일치\n");
+                return 1;
+            }
+            aes_ofb(&ctx, mode_iv, ctr_buf, ctr_buf, j);
+            if (memcmp(ctr_buf, ctr_ptxt, j)) {
+                printf(".....FAILED: OFB 복호문 불일치\n");
+                return 1;
+            }
+        }
+        // CBC, CFB 복호화를 블록 단위 계산과 비교
+        aes_cbc_encrypt(&ctx, mode_iv, ecb_ptxt, ecb_buf, sizeof(ecb_ptxt), AES_PAD_NONE, &outlen);
+        for (i = 0; i < ECBBLOCKS; ++i) {
+            aes_decrypt_block(&ctx, ecb_buf + i*BLOCKLEN, buf);
+            for (j = 0; j < BLOCKLEN; ++j)
+                ecb_ref[i*BLOCKLEN + j] = buf[j] ^ (i == 0 ? mode_iv[j] : ecb_buf[(i-1)*BLOCKLEN + j]);
+        }
+        aes_cbc_decrypt(&ctx, mode_iv, ecb_buf, ecb_buf, sizeof(ecb_buf), AES_PAD_NONE, &outlen);
+        if (memcmp(ecb_ref, ecb_ptxt, sizeof(ecb_ptxt)) || memcmp(ecb_buf, ecb_ptxt, sizeof(ecb_ptxt))) {
+            printf(".....FAILED: CBC 여러 블록 복호화 불일치\n");
+            return 1;
+        }
+        aes_cfb_encrypt(&ctx, mode_iv, ecb_ptxt, ecb_buf, sizeof(ecb_ptxt) - 7);
+        aes_cfb_decrypt(&ctx, mode_iv, ecb_buf, ecb_buf, sizeof(ecb_ptxt) - 7);
+        if (memcmp(ecb_buf, ecb_ptxt, sizeof(ecb_ptxt) - 7)) {
+            printf(".....FAILED: CFB 여러 블록 복호화 불일치\n");
+            return 1;
+        }
+    }
+    aes_set_engine(AES_ENGINE_AUTO);
+    aes_init(&ctx, ctr_key, AES128_KEYLEN);
+    for (j = 0; j <= 3*BLOCKLEN; ++j) {
+        // 패딩을 직접 붙여서 AES_PAD_NONE으로 암호화한 결과와 같아야 한다.
+        memcpy(pad_ref, ecb_ptxt, j);
+        memset(pad_ref + j, BLOCKLEN - j % BLOCKLEN, BLOCKLEN - j % BLOCKLEN);
+        aes_cbc_encrypt(&ctx, mode_iv, pad_ref, pad_ref, j - j % BLOCKLEN + BLOCKLEN, AES_PAD_NONE, &outlen);
+        memcpy(pad_buf, ecb_ptxt, j);
+        if (aes_cbc_encrypt(&ctx, mode_iv, pad_buf, pad_buf, j, AES_PAD_PKCS7, &outlen) ||
+            outlen != (size_t)(j - j % BLOCKLEN + BLOCKLEN) || memcmp(pad_buf, pad_ref, outlen) ||
+            aes_cbc_decrypt(&ctx, mode_iv, pad_buf, pad_buf, outlen, AES_PAD_PKCS7, &outlen) ||
+            outlen != (size_t)j || memcmp(pad_buf, ecb_ptxt, j)) {
+            printf(".....FAILED: CBC PKCS#7 패딩 불일치 (%d 바이트)\n", j);
+            return 1;
+        }
+        if (aes_ecb_encrypt(&ctx, ecb_ptxt, pad_buf, j, AES_PAD_PKCS7, &outlen) ||
+            aes_ecb_decrypt(&ctx, pad_buf, pad_buf, outlen, AES_PAD_PKCS7, &outlen) ||
+            outlen != (size_t)j || memcmp(pad_buf, ecb_ptxt, j)) {
+            printf(".....FAILED: ECB PKCS#7 패딩 불일치 (%d 바이트)\n", j);
+            return 1;
+        }
+    }
+    // 마지막 바이트가 0, 17이거나 패딩 바이트가 서로 다르면 거부해야 한다.
+    for (i = 0; i < 3; ++i) {
+        memset(buf, 3, BLOCKLEN);
+        buf[BLOCKLEN-1] = i == 0 ? 0 : i == 1 ? 17 : 3;
+        buf[BLOCKLEN-2] = i == 2 ? 2 : buf[BLOCKLEN-2];
+        aes_cbc_encrypt(&ctx, mode_iv, buf, buf, BLOCKLEN, AES_PAD_NONE, &outlen);
+        if (aes_cbc_decrypt(&ctx, mode_iv, buf, buf2, BLOCKLEN, AES_PAD_PKCS7, &outlen) != AES_BAD_PADDING) {
+            printf(".....FAILED: 잘못된 패딩 통과\n");
+            return 1;
+        }
+    }
+    if (aes_cbc_encrypt(&ctx, mode_iv, buf, buf, 5, AES_PAD_NONE, &outlen) != AES_INVALID ||
+        aes_cbc_decrypt(&ctx, mode_iv, buf, buf, 0, AES_PAD_PKCS7, &outlen) != AES_INVALID ||
+        aes_ecb_decrypt(&ctx, pad_buf, pad_buf, 20, AES_PAD_PKCS7, &outlen) != AES_INVALID ||
+        aes_ecb_encrypt(&ctx, buf, buf, BLOCKLEN, 7, &outlen) != AES_INVALID) {
+        printf(".....FAILED: 잘못된 길이 통과\n");
+        return 1;
+    }
+    printf(".....PASSED\n");
+    /*
+     * GCM 시험: 두 가지 GHASH 구현으로 벡터값을 확인하고, 태그나 AAD가 바뀌면 거부하는지 본다.
+     * SP 800-38D가 허용하는 태그 길이만 받는지도 확인한다.
+     * 길이가 여러 가지인 무작위 메시지로 두 GHASH 구현의 결과가 같은지도 확인한다.
+     */
+    printf("---\nAES-GCM 시험");
+    for (ghash = GCM_GHASH_TABLE; ghash <= GCM_GHASH_PCLMUL; ++ghash) {
+        if (aes_gcm_set_ghash(ghash) != 0)
+            continue;
+        for (i = 0; i < (int)(sizeof(gcm_vec)/sizeof(gcm_vec[0])); ++i) {
+            const struct gcm_vector *v = gcm_vec + i;
+            aes_gcm_init(&gcm, v->key, v->keylen);
+            aes_gcm_seal(&gcm, v->iv, v->ivlen, v->aad, v->aadlen, v->ptxt, v->len, gcm_buf, tag, GCM_TAGLEN);
+            if (memcmp(gcm_buf, v->ctxt, v->len) || memcmp(tag, v->tag, GCM_TAGLEN)) {
+                printf(".....FAILED: Test Case %d 암호문 또는 태그 불일치\n", i+1);
+                return 1;
+            }
+            if (aes_gcm_open(&gcm, v->iv, v->ivlen, v->aad, v->aadlen, gcm_buf, v->len, gcm_buf, tag, GCM_TAGLEN) ||
+                memcmp(gcm_buf, v->ptxt, v->len)) {
+                printf(".....FAILED: Test Case %d 복호문 불일치\n", i+1);
+                return 1;
+            }
+            tag[0] ^= 1;
+            if (aes_gcm_open(&gcm, v->iv, v->ivlen, v->aad, v->aadlen, v->ctxt, v->len, gcm_buf, tag, GCM_TAGLEN) != GCM_AUTH_FAIL ||
+                (v->aadlen > 0 && aes_gcm_open(&gcm, v->iv, v->ivlen, v->aad, v->aadlen-1, v->ctxt, v->len, gcm_buf, v->tag, GCM_TAGLEN) != GCM_AUTH_FAIL)) {
+                printf(".....FAILED: Test Case %d 위조 통과\n", i+1);
+                return 1;
+            }
+        }
+    }
+    for (j = 0; j <= GCM_TAGLEN + 1; ++j) {
+        int valid = j == 4 || j == 8 || (j >= GCM_MINTAGLEN && j <= GCM_TAGLEN);
+        if ((aes_gcm_seal(&gcm, gcm_vec[0].iv, GCM_IVLEN, NULL, 0, NULL, 0, gcm_buf, tag, j) == 0) != valid) {
+            printf(".....FAILED: 태그 길이 %d 바이트 처리 오류\n", j);
+            return 1;
+        }
+    }
+    big = malloc(3 * GCMLEN);
+    if (big == NULL) {
+        printf(".....FAILED: 메모리 부족\n");
+        return 1;
+    }
+    arc4random_buf(key2, AES256_KEYLEN);
+    aes_gcm_init(&gcm, key2, AES256_KEYLEN);
+    for (j = 0; j < GCMLEN; j = 3*j + 1) {
+        arc4random_buf(big, j);
+        arc4random_buf(gcm_buf, sizeof(gcm_buf));
+        aes_gcm_set_ghash(GCM_GHASH_TABLE);
+        aes_gcm_seal(&gcm, gcm_buf, 1 + j % 40, gcm_buf + 40, j % 24, big, j, big + GCMLEN, tag, GCM_TAGLEN);
+        aes_gcm_set_ghash(GCM_GHASH_AUTO);
+        aes_gcm_seal(&gcm, gcm_buf, 1 + j % 40, gcm_buf + 40, j % 24, big, j, big + 2*GCMLEN, tag2, GCM_TAGLEN);
+        if (memcmp(big + GCMLEN, big + 2*GCMLEN, j) || memcmp(tag, tag2, GCM_TAGLEN) ||
+            aes_gcm_open(&gcm, gcm_buf, 1 + j % 40, gcm_buf + 40, j % 24, big + GCMLEN, j, big + GCMLEN, tag, 12) ||
+            memcmp(big, big + GCMLEN, j)) {
+            printf(".....FAILED: GHASH 구현 간 불일치 (%d 바이트)\n", j);
+            return 1;
+        }
+    }
+    free(big);
+    printf(".....PASSED\n");
     /*
      * 키와 평문을 무작위로 선택해서 암복호화를 여러번 수행하고 CUP 시간을 측정한다.
      */
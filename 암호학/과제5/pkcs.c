@@ -12,64 +12,233 @@
 #include <stdlib.h>
 #endif
 #include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 #include <gmp.h>
-#include <math.h>
 #include "pkcs.h"
 #include "sha2.h"
 
-void MGF1(const unsigned char *, size_t, size_t, int, unsigned char*);
+int MGF1(const unsigned char *, size_t, size_t, int, unsigned char*);
 void I2OSP(size_t, unsigned char*);
 int countBits(size_t);
-static void sha_gen(int sha2_ndx, const unsigned char *message, unsigned int len, unsigned char *digest);
-static int sha_len(int sha2_ndx);
 
 /*
- * rsa_generate_key() - generates RSA keys e, d and n in octet strings.
+ * rsa_keyref - 내부 함수에 키를 넘기는 방법
+ * 옥텟 문자열 지수 x와 모듈러스 n, CRT 개인키 crt, 키 핸들 h 중 하나를 가리킨다.
+ * k는 모듈러스의 바이트 길이이고, 0이면 지원하지 않는 키 길이이다.
+ */
+typedef struct {
+    const void *x, *n;
+    const rsa_crt_key *crt;
+    const rsa_handle *h;
+    int k;
+} rsa_keyref;
+
+static int pss_sign_digest(const void *mHash, const rsa_keyref *kr, void *s, int sha2_ndx);
+static int pss_verify_digest(const void *mHash, const rsa_keyref *kr, const void *s, int sha2_ndx);
+
+// PSS의 M 프라임 앞에 붙는 0 8바이트
+static const unsigned char M_P_zero[8];
+
+/*
+ * key_len() - returns the modulus length in octets of a bits-bit key,
+ * or 0 if the key size is not supported.
+ */
+static int key_len(int bits)
+{
+    if (bits < 2048 || bits > RSA_MAXKEYSIZE || bits % 16 != 0)
+        return 0;
+    return bits / 8;
+}
+
+/*
+ * 소수 후보를 밀러-라빈 시험 전에 걸러내는 체
+ * 홀수 시작점 x에서 x, x+2, ..., x+2(SIEVE_SPAN-1)를 SIEVE_LIMIT보다 작은 홀수 소수로
+ * 나눠지는 것을 한꺼번에 지우고, 남은 후보만 밀러-라빈 시험을 한다.
+ */
+#define SIEVE_LIMIT 16384
+#define SIEVE_SPAN 4096
+
+static unsigned short small_prime[SIEVE_LIMIT/2];
+static int n_small_prime;
+static pthread_once_t small_prime_once = PTHREAD_ONCE_INIT;
+
+static void small_prime_init(void)
+{
+    static unsigned char comp[SIEVE_LIMIT];
+    int i, j;
+
+    for (i = 3; i < SIEVE_LIMIT; i += 2) {
+        if (comp[i])
+            continue;
+        small_prime[n_small_prime++] = i;
+        for (j = i * i; j < SIEVE_LIMIT; j += 2 * i)
+            comp[j] = 1;
+    }
+}
+
+/*
+ * rand_init() - initializes state with a 256-bit seed from arc4random.
+ */
+static void rand_init(gmp_randstate_t state)
+{
+    unsigned char buf[32];
+    mpz_t seed;
+
+    arc4random_buf(buf, sizeof(buf));
+    mpz_init(seed);
+    mpz_import(seed, sizeof(buf), 1, 1, 1, 0, buf);
+    gmp_randinit_default(state);
+    gmp_randseed(state, seed);
+    mpz_clear(seed);
+    memset(buf, 0, sizeof(buf));
+}
+
+/*
+ * mr_rounds() - FIPS 186-5 표 B.1의 밀러-라빈 반복 횟수
+ * nlen이 2048비트이면 5번, 3072비트 이상이면 4번으로 오류 확률이 보안 강도 이하가 된다.
+ */
+static int mr_rounds(int bits)
+{
+    return bits < 3072 ? 5 : 4;
+}
+
+/*
+ * miller_rabin() - 임의의 밑으로 rounds번 밀러-라빈 시험을 한다 (FIPS 186-5 B.3.1).
+ * w가 아마도 소수이면 1, 합성수이면 0을 넘겨준다.
+ */
+static int miller_rabin(const mpz_t w, int rounds, gmp_randstate_t state)
+{
+    mpz_t w1, w3, m, b, z;
+    mp_bitcnt_t a, j;
+    int i, ret = 1;
+
+    mpz_inits(w1, w3, m, b, z, NULL);
+    mpz_sub_ui(w1, w, 1);
+    mpz_sub_ui(w3, w, 3);
+    a = mpz_scan1(w1, 0);
+    mpz_tdiv_q_2exp(m, w1, a);
+    for (i = 0; i < rounds && ret; ++i) {
+        mpz_urandomm(b, state, w3);
+        mpz_add_ui(b, b, 2);
+        mpz_powm(z, b, m, w);
+        if (mpz_cmp_ui(z, 1) == 0 || mpz_cmp(z, w1) == 0)
+            continue;
+        for (j = 1; j < a; ++j) {
+            mpz_powm_ui(z, z, 2, w);
+            if (mpz_cmp(z, w1) == 0 || mpz_cmp_ui(z, 1) == 0)
+                break;
+        }
+        if (j == a || mpz_cmp(z, w1) != 0)
+            ret = 0;
+    }
+    mpz_clears(w1, w3, m, b, z, NULL);
+    return ret;
+}
+
+/*
+ * prime_search() - finds a random prime p of pbits bits for a bits-bit RSA key.
+ * The two top bits of p are set so that p*q has exactly bits bits.
+ * If mode = 0, p-1 is also made relatively prime to e = 65537.
+ */
+static void prime_search(mpz_t p, int pbits, int bits, int mode, gmp_randstate_t state)
+{
+    unsigned char comp[SIEVE_SPAN];
+    unsigned long r, sp;
+    mpz_t x;
+    int i, j, found = 0;
+
+    pthread_once(&small_prime_once, small_prime_init);
+    mpz_init(x);
+    while (!found) {
+        mpz_urandomb(x, state, pbits);
+        mpz_setbit(x, 0);
+        mpz_setbit(x, pbits-1);
+        mpz_setbit(x, pbits-2);
+        /*
+         * Mark x + 2j divisible by a small prime sp: 2j = -r (mod sp), j = -r(sp+1)/2 (mod sp)
+         */
+        memset(comp, 0, SIEVE_SPAN);
+        for (i = 0; i < n_small_prime; ++i) {
+            sp = small_prime[i];
+            r = mpz_fdiv_ui(x, sp);
+            for (j = (sp - r) % sp * ((sp + 1) / 2) % sp; j < SIEVE_SPAN; j += sp)
+                comp[j] = 1;
+        }
+        /*
+         * If e = 65537, drop x + 2j = 1 (mod 65537), whose p-1 is a multiple of e
+         */
+        if (mode == 0) {
+            r = mpz_fdiv_ui(x, 65537);
+            for (j = (65537 + 1 - r) % 65537 * 32769 % 65537; j < SIEVE_SPAN; j += 65537)
+                comp[j] = 1;
+        }
+        for (j = 0; j < SIEVE_SPAN && !found; ++j) {
+            if (comp[j])
+                continue;
+            mpz_add_ui(p, x, 2 * j);
+            if (mpz_sizeinbase(p, 2) > (size_t)pbits)
+                break;
+            found = miller_rabin(p, mr_rounds(bits), state);
+        }
+    }
+    mpz_clear(x);
+}
+
+typedef struct {
+    mpz_t p;
+    int bits;
+    int mode;
+} prime_job;
+
+static void *prime_worker(void *arg)
+{
+    prime_job *job = arg;
+    gmp_randstate_t state;
+
+    rand_init(state);
+    prime_search(job->p, job->bits/2, job->bits, job->mode, state);
+    gmp_randclear(state);
+    return NULL;
+}
+
+/*
+ * rsa_generate() - generates primes p, q and a bits-bit RSA key e, d and n.
  * If mode = 0, then e = 65537 is used. Otherwise e will be randomly selected.
  * Carmichael's totient function Lambda(n) is used.
+ * q is searched in a second thread while this thread searches p.
  */
-void rsa_generate_key(void *_e, void *_d, void *_n, int mode)
+static void rsa_generate(mpz_t p, mpz_t q, mpz_t e, mpz_t d, mpz_t n, int bits, int mode)
 {
-    mpz_t p, q, lambda, e, d, n, gcd;
+    mpz_t lambda, gcd;
     gmp_randstate_t state;
+    prime_job job;
+    pthread_t tid;
+    int started;
     
     /*
      * Initialize mpz variables
      */
-    mpz_inits(p, q, lambda, e, d, n, gcd, NULL);
-    gmp_randinit_default(state);
-    gmp_randseed_ui(state, arc4random());
+    mpz_inits(lambda, gcd, NULL);
+    mpz_init(job.p);
+    job.bits = bits;
+    job.mode = mode;
+    rand_init(state);
     /*
-     * Generate prime p and q such that 2^(RSAKEYSIZE-1) <= p*q < 2^RSAKEYSIZE
+     * Generate prime p and q such that 2^(bits-1) <= p*q < 2^bits and
+     * |p - q| > 2^(bits/2 - 100) (FIPS 186-5 A.1.3)
      */
     do {
-        do {
-            mpz_urandomb(p, state, RSAKEYSIZE/2);
-            mpz_setbit(p, 0);
-            mpz_setbit(p, RSAKEYSIZE/2-1);
-        } while (mpz_probab_prime_p(p, 50) == 0);
-        do {
-            mpz_urandomb(q, state, RSAKEYSIZE/2);
-            mpz_setbit(q, 0);
-            mpz_setbit(q, RSAKEYSIZE/2-1);
-        } while (mpz_probab_prime_p(q, 50) == 0);
-        /*
-         * If we select e = 65537, it should be relatively prime to Lambda(n)
-         */
-        if (mode == 0) {
-            mpz_sub_ui(p, p, 1);
-            if (mpz_gcd_ui(gcd, p, 65537) != 1)
-                continue;
-            else
-                mpz_add_ui(p, p, 1);
-            mpz_sub_ui(q, q, 1);
-            if (mpz_gcd_ui(gcd, q, 65537) != 1)
-                continue;
-            else
-                mpz_add_ui(q, q, 1);
-        }
-        mpz_mul(n, p, q);
-    } while (!mpz_tstbit(n, RSAKEYSIZE-1));
+        started = pthread_create(&tid, NULL, prime_worker, &job) == 0;
+        prime_search(p, bits/2, bits, mode, state);
+        if (started)
+            pthread_join(tid, NULL);
+        else
+            prime_worker(&job);
+        mpz_set(q, job.p);
+        mpz_sub(gcd, p, q);
+    } while (mpz_sizeinbase(gcd, 2) <= (size_t)(bits/2 - 100));
+    mpz_mul(n, p, q);
     /*
      * Generate e and d using Lambda(n)
      */
@@ -79,27 +248,75 @@ void rsa_generate_key(void *_e, void *_d, void *_n, int mode)
     if (mode == 0)
         mpz_set_ui(e, 65537);
     else do {
-        mpz_urandomb(e, state, RSAKEYSIZE);
+        mpz_urandomb(e, state, bits);
         mpz_gcd(gcd, e, lambda);
     } while (mpz_cmp(e, lambda) >= 0 || mpz_cmp_ui(gcd, 1) != 0);
     mpz_invert(d, e, lambda);
+    mpz_add_ui(p, p, 1);
+    mpz_add_ui(q, q, 1);
+    /*
+     * Free the space occupied by mpz variables
+     */
+    mpz_clears(lambda, gcd, job.p, NULL);
+    gmp_randclear(state);
+}
+
+/*
+ * rsa_generate_key() - generates RSA keys e, d and n in octet strings.
+ * If mode = 0, then e = 65537 is used. Otherwise e will be randomly selected.
+ */
+void rsa_generate_key(void *_e, void *_d, void *_n, int mode)
+{
+    mpz_t p, q, e, d, n;
+
+    mpz_inits(p, q, e, d, n, NULL);
+    rsa_generate(p, q, e, d, n, RSAKEYSIZE, mode);
     /*
      * Convert mpz_t values into octet strings
      */
     mpz_export(_e, NULL, 1, RSAKEYSIZE/8, 1, 0, e);
     mpz_export(_d, NULL, 1, RSAKEYSIZE/8, 1, 0, d);
     mpz_export(_n, NULL, 1, RSAKEYSIZE/8, 1, 0, n);
-    /*
-     * Free the space occupied by mpz variables
-     */
-    mpz_clears(p, q, lambda, e, d, n, gcd, NULL);
+    mpz_clears(p, q, e, d, n, NULL);
 }
 
 /*
- * rsa_cipher() - compute m^k mod n
+ * rsa_generate_crt_key() - generates a bits-bit RSA key that keeps the CRT components.
+ * dP = d mod (p-1), dQ = d mod (q-1), qInv = q^-1 mod p are stored with p and q.
+ * Returns PKCS_INVALID_KEYSIZE if bits is not supported, otherwise 0.
+ */
+int rsa_generate_crt_key(rsa_crt_key *key, int bits, int mode)
+{
+    mpz_t p, q, e, d, n, t;
+    int k = key_len(bits);
+
+    if (k == 0)
+        return PKCS_INVALID_KEYSIZE;
+    mpz_inits(p, q, e, d, n, t, NULL);
+    rsa_generate(p, q, e, d, n, bits, mode);
+    key->pub.bits = bits;
+    mpz_export(key->pub.n, NULL, 1, k, 1, 0, n);
+    mpz_export(key->pub.e, NULL, 1, k, 1, 0, e);
+    mpz_export(key->d, NULL, 1, k, 1, 0, d);
+    mpz_export(key->p, NULL, 1, k/2, 1, 0, p);
+    mpz_export(key->q, NULL, 1, k/2, 1, 0, q);
+    mpz_sub_ui(t, p, 1);
+    mpz_mod(t, d, t);
+    mpz_export(key->dP, NULL, 1, k/2, 1, 0, t);
+    mpz_sub_ui(t, q, 1);
+    mpz_mod(t, d, t);
+    mpz_export(key->dQ, NULL, 1, k/2, 1, 0, t);
+    mpz_invert(t, q, p);
+    mpz_export(key->qInv, NULL, 1, k/2, 1, 0, t);
+    mpz_clears(p, q, e, d, n, t, NULL);
+    return 0;
+}
+
+/*
+ * rsa_cipher() - compute m^k mod n, where m, k and n are len-octet strings
  * If m >= n then returns PKCS_MSG_OUT_OF_RANGE, otherwise returns 0 for success.
  */
-static int rsa_cipher(void *_m, const void *_k, const void *_n)
+static int rsa_cipher(void *_m, const void *_k, const void *_n, int len)
 {
     mpz_t m, k, n;
     
@@ -110,9 +327,9 @@ static int rsa_cipher(void *_m, const void *_k, const void *_n)
     /*
      * Convert big-endian octets into mpz_t values
      */
-    mpz_import(m, RSAKEYSIZE/8, 1, 1, 1, 0, _m);
-    mpz_import(k, RSAKEYSIZE/8, 1, 1, 1, 0, _k);
-    mpz_import(n, RSAKEYSIZE/8, 1, 1, 1, 0, _n);
+    mpz_import(m, len, 1, 1, 1, 0, _m);
+    mpz_import(k, len, 1, 1, 1, 0, _k);
+    mpz_import(n, len, 1, 1, 1, 0, _n);
     /*
      * Compute m^k mod n
      */
@@ -124,7 +341,7 @@ static int rsa_cipher(void *_m, const void *_k, const void *_n)
     /*
      * Convert mpz_t m into the octet string _m
      */
-    mpz_export(_m, NULL, 1, RSAKEYSIZE/8, 1, 0, m);
+    mpz_export(_m, NULL, 1, len, 1, 0, m);
     /*
      * Free the space occupied by mpz variables
      */
@@ -133,33 +350,427 @@ static int rsa_cipher(void *_m, const void *_k, const void *_n)
 }
 
 /*
- * rsaes_oaep_encrypt() - RSA encrytion with the EME-OAEP encoding method
- * 길이가 len 바이트인 메시지 m을 공개키 (e,n)으로 암호화한 결과를 c에 저장한다.
- * label은 데이터를 식별하기 위한 라벨 문자열로 NULL을 입력하여 생략할 수 있다.
- * sha2_ndx는 사용할 SHA-2 해시함수 색인 값으로 SHA224, SHA256, SHA384, SHA512,
- * SHA512_224, SHA512_256 중에서 선택한다. c의 크기는 RSAKEYSIZE와 같아야 한다.
+ * rsa_cipher_crt() - compute m^d mod n with the CRT components of key
+ * m1 = m^dP mod p, m2 = m^dQ mod q를 구하고 Garner 방법으로 m^d = m2 + q(qInv(m1 - m2) mod p)를 얻는다.
+ * 결과를 e로 다시 거듭제곱해서 m이 나오는지 확인한 다음에만 내보낸다. 계산 중에 오류가 생긴
+ * 결과가 밖으로 나가면 그것으로 n을 인수분해할 수 있기 때문이다 (Bellcore 공격).
+ * If m >= n then returns PKCS_MSG_OUT_OF_RANGE, if the check fails returns PKCS_CRT_FAULT,
+ * otherwise returns 0 for success.
+ */
+static int rsa_cipher_crt(void *_m, const rsa_crt_key *key)
+{
+    mpz_t m, n, e, p, q, dP, dQ, qInv, m1, m2, h;
+    int k = key->pub.bits / 8, ret = 0;
+
+    mpz_inits(m, n, e, p, q, dP, dQ, qInv, m1, m2, h, NULL);
+    mpz_import(m, k, 1, 1, 1, 0, _m);
+    mpz_import(n, k, 1, 1, 1, 0, key->pub.n);
+    mpz_import(e, k, 1, 1, 1, 0, key->pub.e);
+    mpz_import(p, k/2, 1, 1, 1, 0, key->p);
+    mpz_import(q, k/2, 1, 1, 1, 0, key->q);
+    mpz_import(dP, k/2, 1, 1, 1, 0, key->dP);
+    mpz_import(dQ, k/2, 1, 1, 1, 0, key->dQ);
+    mpz_import(qInv, k/2, 1, 1, 1, 0, key->qInv);
+    if (mpz_cmp(m, n) >= 0)
+        ret = PKCS_MSG_OUT_OF_RANGE;
+    else {
+        /*
+         * Two half-size exponentiations and Garner's recombination
+         */
+        mpz_powm(m1, m, dP, p);
+        mpz_powm(m2, m, dQ, q);
+        mpz_sub(h, m1, m2);
+        mpz_mul(h, h, qInv);
+        mpz_mod(h, h, p);
+        mpz_mul(h, h, q);
+        mpz_add(m1, m2, h);
+        /*
+         * Fault check: (m^d)^e mod n must give m back
+         */
+        mpz_powm(h, m1, e, n);
+        if (mpz_cmp(h, m) != 0)
+            ret = PKCS_CRT_FAULT;
+        else
+            mpz_export(_m, NULL, 1, k, 1, 0, m1);
+    }
+    mpz_clears(m, n, e, p, q, dP, dQ, qInv, m1, m2, h, NULL);
+    return ret;
+}
+
+/*
+ * 옥텟 문자열과 림브 배열 사이의 변환
+ * 림브 배열은 GMP mpn 함수가 쓰는 형태로 낮은 자리 림브가 앞에 온다.
+ */
+static void limbs_from_octets(mp_limb_t *l, int n, const unsigned char *b, int len)
+{
+    int i;
+
+    memset(l, 0, n * sizeof(mp_limb_t));
+    for (i = 0; i < len; ++i)
+        l[i / sizeof(mp_limb_t)] |= (mp_limb_t)b[len-1-i] << (8 * (i % sizeof(mp_limb_t)));
+}
+
+static void octets_from_limbs(unsigned char *b, int len, const mp_limb_t *l, int n)
+{
+    int i;
+
+    for (i = 0; i < len; ++i)
+        b[len-1-i] = i / (int)sizeof(mp_limb_t) < n ? l[i / sizeof(mp_limb_t)] >> (8 * (i % sizeof(mp_limb_t))) : 0;
+}
+
+static void limbs_from_mpz(mp_limb_t *l, int n, const mpz_t z)
+{
+    memset(l, 0, n * sizeof(mp_limb_t));
+    mpz_export(l, NULL, -1, sizeof(mp_limb_t), 0, 0, z);
+}
+
+/*
+ * mont_init() - 홀수 모듈러스 m의 몽고메리 상수를 계산한다. R = 2^(GMP_NUMB_BITS * size)이다.
+ * minv = -m^-1 mod 2^GMP_NUMB_BITS는 뉴턴 반복으로 구한다. m이 홀수이면 m * m = 1 (mod 8)이므로
+ * m에서 시작해서 한 번 반복할 때마다 맞는 비트 수가 두 배가 된다.
+ */
+static void mont_init(rsa_mont_ctx *M, const mpz_t m)
+{
+    mp_limb_t inv;
+    mpz_t t;
+    int i;
+
+    M->size = mpz_size(m);
+    limbs_from_mpz(M->m, M->size, m);
+    inv = M->m[0];
+    for (i = 0; i < 6; ++i)
+        inv *= 2 - M->m[0] * inv;
+    M->minv = -inv;
+    mpz_init(t);
+    mpz_setbit(t, GMP_NUMB_BITS * M->size);
+    mpz_mod(t, t, m);
+    limbs_from_mpz(M->one, M->size, t);
+    mpz_mul(t, t, t);
+    mpz_mod(t, t, m);
+    limbs_from_mpz(M->rr, M->size, t);
+    mpz_clear(t);
+}
+
+/*
+ * mont_redc() - 2*size 림브인 t를 t * R^-1 mod m으로 줄여서 r에 넣는다. t는 망가진다.
+ * u = t[i] * minv에 m을 곱해 더하면 t[i]가 0이 되므로 그 자리에 위로 올라갈 자리올림을
+ * 보관했다가 마지막에 한꺼번에 더한다. 결과는 2m보다 작으므로 한 번만 빼면 된다.
+ * 뺄지 말지가 비밀 값에 따라 달라지므로 항상 빼 본 다음 마스크로 고른다. 더할 때 자리올림이
+ * 생겼으면 뺄 때도 반드시 빌림이 생기므로, 둘이 같을 때 뺀 값을 고르면 된다.
+ */
+static void mont_redc(mp_limb_t *r, mp_limb_t *t, const rsa_mont_ctx *M)
+{
+    mp_limb_t u[RSA_MAXLIMBS], carry, mask;
+    int i, n = M->size;
+
+    for (i = 0; i < n; ++i)
+        t[i] = mpn_addmul_1(t + i, M->m, n, t[i] * M->minv);
+    carry = mpn_add_n(r, t + n, t, n);
+    mask = (carry ^ mpn_sub_n(u, r, M->m, n)) - 1;
+    for (i = 0; i < n; ++i)
+        r[i] = (u[i] & mask) | (r[i] & ~mask);
+}
+
+/*
+ * mont_mul() - r = a * b * R^-1 mod m. a와 b가 같으면 제곱을 쓴다. r은 a나 b와 겹쳐도 된다.
+ */
+static void mont_mul(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *b, const rsa_mont_ctx *M)
+{
+    mp_limb_t t[2*RSA_MAXLIMBS];
+
+    if (a == b)
+        mpn_sqr(t, a, M->size);
+    else
+        mpn_mul_n(t, a, b, M->size);
+    mont_redc(r, t, M);
+}
+
+/*
+ * mod_reduce() - an 림브인 a를 m으로 나눈 나머지를 size 림브로 r에 넣는다.
+ * 비밀 값도 줄이므로 앞자리의 0인 림브를 떼지 않고 mpn_sec_div_r()로 정해진 길이만큼 나눈다.
+ */
+static void mod_reduce(mp_limb_t *r, const mp_limb_t *a, int an, const rsa_mont_ctx *M)
+{
+    int n = an > M->size ? an : M->size;
+    mp_limb_t t[n], tp[mpn_sec_div_r_itch(n, M->size)];
+
+    memset(t, 0, n * sizeof(mp_limb_t));
+    memcpy(t, a, an * sizeof(mp_limb_t));
+    mpn_sec_div_r(t, n, M->m, M->size, tp);
+    memcpy(r, t, M->size * sizeof(mp_limb_t));
+}
+
+/*
+ * window_bits() - ebits 비트 지수에 쓸 윈도 크기
+ * 표를 만드는 곱셈 2^w번과 줄어드는 곱셈 수가 맞먹는 곳에서 크기를 바꾼다.
+ */
+static int window_bits(int ebits)
+{
+    return ebits > 671 ? 6 : ebits > 239 ? 5 : ebits > 79 ? 4 : ebits > 23 ? 3 : 1;
+}
+
+static unsigned int exp_bits(const mp_limb_t *e, int ebits, int pos, int w)
+{
+    unsigned int d = 0;
+    int i;
+
+    for (i = w - 1; i >= 0; --i) {
+        d <<= 1;
+        if (pos + i < ebits)
+            d |= (e[(pos + i) / GMP_NUMB_BITS] >> ((pos + i) % GMP_NUMB_BITS)) & 1;
+    }
+    return d;
+}
+
+/*
+ * mont_powm() - r = a^e mod m, 고정 윈도 방식
+ * a는 m보다 작은 보통 형태의 수이고 e는 ebits 비트인 공개 지수이다. a^0 ~ a^(2^w - 1)의 몽고메리
+ * 형태 표를 만든 다음, 지수를 위에서부터 w비트씩 끊어서 제곱 w번과 표의 값 곱하기 한 번을 되풀이한다.
+ * 0인 윈도는 곱셈을 건너뛴다. 17비트 e = 65537처럼 짧은 지수에서는 mpz_powm()이 매번 하는
+ * 몽고메리 상수 계산이 거듭제곱의 큰 몫을 차지하므로, 상수를 미리 구해 둔 이 함수가 더 빠르다.
+ */
+static void mont_powm(mp_limb_t *r, const mp_limb_t *a, const mp_limb_t *e, int ebits, const rsa_mont_ctx *M)
+{
+    int n = M->size, w = window_bits(ebits), pos, i;
+    mp_limb_t table[1 << w][n], acc[n], t[2*RSA_MAXLIMBS];
+    unsigned int d;
+
+    memcpy(table[0], M->one, n * sizeof(mp_limb_t));
+    mont_mul(table[1], a, M->rr, M);
+    for (i = 2; i < (1 << w); ++i)
+        mont_mul(table[i], table[i-1], table[1], M);
+    pos = (ebits + w - 1) / w * w - w;
+    memcpy(acc, table[exp_bits(e, ebits, pos, w)], n * sizeof(mp_limb_t));
+    while (pos > 0) {
+        pos -= w;
+        for (i = 0; i < w; ++i)
+            mont_mul(acc, acc, acc, M);
+        if ((d = exp_bits(e, ebits, pos, w)) != 0)
+            mont_mul(acc, acc, table[d], M);
+    }
+    memset(t, 0, 2 * n * sizeof(mp_limb_t));
+    memcpy(t, acc, n * sizeof(mp_limb_t));
+    mont_redc(r, t, M);
+}
+
+/*
+ * rsa_handle_init_pub() - 공개키 pub를 읽어서 공개키 연산만 하는 핸들 h를 만든다.
+ * rsa_handle_init_crt() - CRT 개인키 key를 읽어서 모든 연산을 하는 핸들 h를 만든다.
+ * 키 길이가 잘못되었으면 PKCS_INVALID_KEYSIZE, 몽고메리 곱셈을 쓸 수 없는 키(n이 짝수이거나
+ * 정확히 bits 비트가 아닌 경우, e가 1 이하이거나 n 이상인 경우, p나 q가 짝수이거나 p * q가 n이
+ * 아닌 경우)이면 PKCS_INVALID_KEY, 그렇지 않으면 0을 넘겨준다.
+ */
+int rsa_handle_init_pub(rsa_handle *h, const rsa_public_key *pub)
+{
+    int k = key_len(pub->bits);
+    mpz_t n, e;
+
+    if (k == 0)
+        return PKCS_INVALID_KEYSIZE;
+    mpz_inits(n, e, NULL);
+    mpz_import(n, k, 1, 1, 1, 0, pub->n);
+    mpz_import(e, k, 1, 1, 1, 0, pub->e);
+    if (mpz_even_p(n) || mpz_sizeinbase(n, 2) != (size_t)pub->bits || mpz_cmp_ui(e, 1) <= 0 || mpz_cmp(e, n) >= 0) {
+        mpz_clears(n, e, NULL);
+        return PKCS_INVALID_KEY;
+    }
+    h->bits = pub->bits;
+    h->priv = 0;
+    mont_init(&h->n, n);
+    limbs_from_mpz(h->e, RSA_MAXLIMBS, e);
+    h->ebits = mpz_sizeinbase(e, 2);
+    mpz_clears(n, e, NULL);
+    return 0;
+}
+
+int rsa_handle_init_crt(rsa_handle *h, const rsa_crt_key *key)
+{
+    int k, val;
+    mpz_t p, q, t, n;
+
+    if ((val = rsa_handle_init_pub(h, &key->pub)) != 0)
+        return val;
+    k = key_len(key->pub.bits);
+    mpz_inits(p, q, t, n, NULL);
+    mpz_import(p, k/2, 1, 1, 1, 0, key->p);
+    mpz_import(q, k/2, 1, 1, 1, 0, key->q);
+    mpz_import(n, k, 1, 1, 1, 0, key->pub.n);
+    mpz_mul(t, p, q);
+    val = mpz_even_p(p) || mpz_even_p(q) || mpz_cmp(t, n) != 0;
+    mpz_clear(n);
+    if (val) {
+        mpz_clears(p, q, t, NULL);
+        return PKCS_INVALID_KEY;
+    }
+    mont_init(&h->p, p);
+    mont_init(&h->q, q);
+    mpz_import(t, k/2, 1, 1, 1, 0, key->dP);
+    limbs_from_mpz(h->dP, RSA_MAXLIMBS/2, t);
+    mpz_import(t, k/2, 1, 1, 1, 0, key->dQ);
+    limbs_from_mpz(h->dQ, RSA_MAXLIMBS/2, t);
+    /*
+     * qInv는 몽고메리 형태 qInv * R mod p로 보관해서 mont_mul 한 번으로 곱한다.
+     */
+    mpz_import(t, k/2, 1, 1, 1, 0, key->qInv);
+    mpz_mul_2exp(t, t, GMP_NUMB_BITS * h->p.size);
+    mpz_mod(t, t, p);
+    limbs_from_mpz(h->qInv, RSA_MAXLIMBS/2, t);
+    h->priv = 1;
+    mpz_clears(p, q, t, NULL);
+    return 0;
+}
+
+/*
+ * handle_public() - 핸들 h로 m^e mod n을 계산한다.
+ * If m >= n then returns PKCS_MSG_OUT_OF_RANGE, otherwise returns 0 for success.
+ */
+static int handle_public(void *_m, const rsa_handle *h)
+{
+    int k = h->bits / 8, n = h->n.size;
+    mp_limb_t m[RSA_MAXLIMBS], r[RSA_MAXLIMBS];
+
+    limbs_from_octets(m, n, _m, k);
+    if (mpn_cmp(m, h->n.m, n) >= 0)
+        return PKCS_MSG_OUT_OF_RANGE;
+    mont_powm(r, m, h->e, h->ebits, &h->n);
+    octets_from_limbs(_m, k, r, n);
+    return 0;
+}
+
+/*
+ * half_powm() - job->r = job->a^job->x mod job->M->m. a와 r은 모듈러스와 같은 size 림브이고
+ * x는 size 림브인 비밀 지수이다. 보관한 림브 위에 mpz_roinit_n()으로 읽기 전용 mpz_t를 씌워서
+ * mpz_powm()을 부르므로 rsa_cipher_crt()와 같은 거듭제곱을 옥텟 문자열 변환 없이 한다.
+ * CPU가 둘 이상이면 handle_private()이 두 번째 스레드에서 m2를 구할 때 쓴다.
+ */
+typedef struct {
+    mp_limb_t *r;
+    const mp_limb_t *a, *x;
+    const rsa_mont_ctx *M;
+} half_job;
+
+static long online_cpus;
+static pthread_once_t online_cpus_once = PTHREAD_ONCE_INIT;
+
+static void online_cpus_init(void)
+{
+    online_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+static void *half_powm(void *arg)
+{
+    half_job *job = arg;
+    mpz_t t, za, zx, zm;
+    int n = job->M->size;
+
+    mpz_init2(t, GMP_NUMB_BITS * n);
+    mpz_powm(t, mpz_roinit_n(za, job->a, n), mpz_roinit_n(zx, job->x, n), mpz_roinit_n(zm, job->M->m, n));
+    memset(job->r, 0, n * sizeof(mp_limb_t));
+    memcpy(job->r, mpz_limbs_read(t), mpz_size(t) * sizeof(mp_limb_t));
+    mpz_clear(t);
+    return NULL;
+}
+
+/*
+ * handle_private() - 핸들 h로 m^d mod n을 계산한다.
+ * rsa_cipher_crt()와 같이 CRT와 Garner 결합을 쓰고, e로 다시 확인한 다음에만 내보낸다.
+ * 공개키만 읽은 핸들이면 PKCS_NOT_PRIVATE를 넘겨준다.
+ */
+static int handle_private(void *_m, const rsa_handle *h)
+{
+    int k = h->bits / 8, n = h->n.size, ps = h->p.size, qs = h->q.size;
+    mp_limb_t c[RSA_MAXLIMBS], cp[RSA_MAXLIMBS], cq[RSA_MAXLIMBS], m1[RSA_MAXLIMBS], m2[RSA_MAXLIMBS];
+    mp_limb_t s[RSA_MAXLIMBS], chk[RSA_MAXLIMBS], tp[mpn_sec_add_1_itch(ps)];
+    half_job j1 = {m1, cp, h->dP, &h->p}, j2 = {m2, cq, h->dQ, &h->q};
+    pthread_t tid;
+    int started;
+
+    if (!h->priv)
+        return PKCS_NOT_PRIVATE;
+    limbs_from_octets(c, n, _m, k);
+    if (mpn_cmp(c, h->n.m, n) >= 0)
+        return PKCS_MSG_OUT_OF_RANGE;
+    /*
+     * m1 = c^dP mod p, m2 = c^dQ mod q
+     * CPU가 둘 이상이면 rsa_generate()처럼 m2는 두 번째 스레드에서 구한다.
+     */
+    mod_reduce(cp, c, n, &h->p);
+    mod_reduce(cq, c, n, &h->q);
+    pthread_once(&online_cpus_once, online_cpus_init);
+    started = online_cpus > 1 && pthread_create(&tid, NULL, half_powm, &j2) == 0;
+    half_powm(&j1);
+    if (started)
+        pthread_join(tid, NULL);
+    else
+        half_powm(&j2);
+    /*
+     * s = m2 + q * (qInv * (m1 - m2) mod p)
+     * 빼서 빌림이 생기면 p를 더하는 것도 자리올림을 s의 위쪽 림브로 올리는 것도 분기 없이 한다.
+     */
+    mod_reduce(cp, m2, qs, &h->p);
+    mpn_cnd_add_n(mpn_sub_n(cp, m1, cp, ps), cp, cp, h->p.m, ps);
+    mont_mul(cp, cp, h->qInv, &h->p);
+    if (ps >= qs)
+        mpn_mul(s, cp, ps, h->q.m, qs);
+    else
+        mpn_mul(s, h->q.m, qs, cp, ps);
+    mpn_sec_add_1(s + qs, s + qs, ps, mpn_add_n(s, s, m2, qs), tp);
+    /*
+     * Fault check: s^e mod n must give c back
+     */
+    mont_powm(chk, s, h->e, h->ebits, &h->n);
+    if (mpn_cmp(chk, c, n) != 0)
+        return PKCS_CRT_FAULT;
+    octets_from_limbs(_m, k, s, n);
+    return 0;
+}
+
+/*
+ * rsa_public() - 공개키 연산 m^e mod n
+ * rsa_private() - 개인키 연산 m^d mod n
+ * kr이 가리키는 키 핸들, CRT 개인키, 옥텟 문자열 (x,n) 순서로 골라서 계산한다.
  * 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
  */
+static int rsa_public(void *m, const rsa_keyref *kr)
+{
+    if (kr->h != NULL)
+        return handle_public(m, kr->h);
+    return rsa_cipher(m, kr->x, kr->n, kr->k);
+}
 
-int rsaes_oaep_encrypt(const void *m, size_t mLen, const void *label, const void *e, const void *n, void *c, int sha2_ndx) {
+static int rsa_private(void *m, const rsa_keyref *kr)
+{
+    if (kr->h != NULL)
+        return handle_private(m, kr->h);
+    if (kr->crt != NULL)
+        return rsa_cipher_crt(m, kr->crt);
+    return rsa_cipher(m, kr->x, kr->n, kr->k);
+}
+
+/*
+ * oaep_encrypt() - rsaes_oaep_encrypt(), rsaes_oaep_encrypt_pub(), rsaes_oaep_encrypt_handle()의 본체
+ */
+static int oaep_encrypt(const void *m, size_t mLen, const void *label, const rsa_keyref *kr, void *c, int sha2_ndx) {
     
 	// 변수 선언
-	int k = RSAKEYSIZE / 8;
-    int hLen = sha_len(sha2_ndx);
+	int k = kr->k;
+    const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+    int hLen = hash != NULL ? hash->digest_size : SHA512_DIGEST_SIZE;
 	int padding_size = k - mLen - 2 * hLen - 2;
 	int DBlength = k - hLen - 1;
 	int lLen = strlen(label);
-	int maskLen = ceil((double)DBlength/hLen)*hLen;
+	int val;
 
-	// 8비트 단위로 계산해주는 매우 큰 값들
-	unsigned char lHash[hLen];
-	unsigned char DB[DBlength];
-	unsigned char seed[hLen];
-	unsigned char dbMask[maskLen];
-	unsigned char maskedDB[DBlength];
-	unsigned char seedMask[hLen];
-	unsigned char maskedSeed[hLen];
-	unsigned char EM[k];	
+	// 지원하지 않는 키 길이면 return PKCS_INVALID_KEYSIZE
+	if (k == 0) return PKCS_INVALID_KEYSIZE;
+
+	// EM = 0x00 || maskedSeed || maskedDB이다. seed와 DB를 EM 안에 만들고 마스크를 그 자리에 XOR한다.
+	unsigned char EM[k];
+	unsigned char *seed = EM + 1;
+	unsigned char *DB = EM + 1 + hLen;
+
+	// 해시함수 색인이 잘못되었으면 return PKCS_INVALID_HASH
+	if (hash == NULL) return PKCS_INVALID_HASH;
 
 	// 문서에 따라 해당 조건이면 return PKCS_MSG_TOO_LONG
     if (mLen > k - 2 * hLen - 2) {
@@ -174,11 +785,8 @@ int rsaes_oaep_encrypt(const void *m, size_t mLen, const void *label, const void
 		if (countBits(lLen) > 125) return PKCS_LABEL_TOO_LONG;
 	}
 
-	// 라벨의 해시값 구하기
-    sha_gen(sha2_ndx, label, lLen, lHash);
-
-	// DB 구성하기
-    memcpy(DB, lHash, hLen);
+	// 라벨의 해시값으로 DB 구성하기
+    hash->digest(label, lLen, DB);
     memset(DB + hLen, 0x00, padding_size);
     DB[hLen + padding_size] = 0x01;
     memcpy(DB + hLen + padding_size + 1, m, mLen);
@@ -186,63 +794,88 @@ int rsaes_oaep_encrypt(const void *m, size_t mLen, const void *label, const void
 	// seed 랜덤으로 hLen 바이트만큼 뽑기
     arc4random_buf(seed, hLen);
     
-	// seed MGF해서 dbMask 구하기
-    MGF1(seed, hLen, DBlength, sha2_ndx, dbMask);
+	// seed MGF해서 DB에 XOR -> maskedDB
+    if ((val = MGF1(seed, hLen, DBlength, sha2_ndx, DB)) != 0)
+        return val;
 
-	// DB와 dbMask를 XOR해서 maskedDB 구하기
-    for (int i = 0; i < DBlength; i++) {
-        maskedDB[i] = dbMask[i] ^ DB[i];
-    }
+	// maskedDB MGF해서 seed에 XOR -> maskedSeed
+    if ((val = MGF1(DB, DBlength, hLen, sha2_ndx, seed)) != 0)
+        return val;
 
-	// maskedDB MGF해서 seedMask구하기
-    MGF1(maskedDB, DBlength, hLen, sha2_ndx, seedMask);
-    
-	// seedMask와 seed XOR해서 maskedSeed 구하기
-    for (int i = 0; i < hLen; i++) {
-        maskedSeed[i] = seedMask[i] ^ seed[i];
-    }
-
-	// EM 구하기
-    EM[0] = 0x00; // 첫 바이트는 0x00
-    memcpy(EM + 1, maskedSeed, hLen);
-    memcpy(EM + 1 + hLen, maskedDB, DBlength);
+	// 첫 바이트는 0x00
+    EM[0] = 0x00;
 
 	// EM 공개키로 암호화
-    if (rsa_cipher(EM, e, n) == 1)
-        return PKCS_MSG_OUT_OF_RANGE;
+    if ((val = rsa_public(EM, kr)) != 0)
+        return val;
 
 	// c에 복사
     memcpy(c, EM, k);
 
     return 0;
 }
+
 /*
- * rsaes_oaep_decrypt() - RSA decrytion with the EME-OAEP encoding method
- * 암호문 c를 개인키 (d,n)을 사용하여 원본 메시지 m과 길이 len을 회복한다.
- * label과 sha2_ndx는 암호화할 때 사용한 것과 일치해야 한다.
+ * rsaes_oaep_encrypt() - RSA encrytion with the EME-OAEP encoding method
+ * 길이가 len 바이트인 메시지 m을 공개키 (e,n)으로 암호화한 결과를 c에 저장한다.
+ * label은 데이터를 식별하기 위한 라벨 문자열로 NULL을 입력하여 생략할 수 있다.
+ * sha2_ndx는 사용할 SHA-2 해시함수 색인 값으로 SHA224, SHA256, SHA384, SHA512,
+ * SHA512_224, SHA512_256 중에서 선택한다. c의 크기는 RSAKEYSIZE와 같아야 한다.
  * 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
  */
-int rsaes_oaep_decrypt(void *m, size_t *mLen, const void *label, const void *d, const void *n, const void *c, int sha2_ndx)
+int rsaes_oaep_encrypt(const void *m, size_t mLen, const void *label, const void *e, const void *n, void *c, int sha2_ndx)
+{
+	rsa_keyref kr = {e, n, NULL, NULL, RSAKEYSIZE / 8};
+
+	return oaep_encrypt(m, mLen, label, &kr, c, sha2_ndx);
+}
+
+/*
+ * rsaes_oaep_encrypt_pub() - 공개키 객체 pub으로 암호화한다. c의 크기는 pub->bits 비트이다.
+ */
+int rsaes_oaep_encrypt_pub(const void *m, size_t mLen, const void *label, const rsa_public_key *pub, void *c, int sha2_ndx)
+{
+	rsa_keyref kr = {pub->e, pub->n, NULL, NULL, key_len(pub->bits)};
+
+	return oaep_encrypt(m, mLen, label, &kr, c, sha2_ndx);
+}
+
+/*
+ * rsaes_oaep_encrypt_handle() - 미리 읽어 둔 키 핸들 h로 암호화한다.
+ */
+int rsaes_oaep_encrypt_handle(const void *m, size_t mLen, const void *label, const rsa_handle *h, void *c, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, NULL, h, key_len(h->bits)};
+
+	return oaep_encrypt(m, mLen, label, &kr, c, sha2_ndx);
+}
+/*
+ * oaep_decrypt() - rsaes_oaep_decrypt(), rsaes_oaep_decrypt_crt(), rsaes_oaep_decrypt_handle()의 본체
+ */
+static int oaep_decrypt(void *m, size_t *mLen, const void *label, const rsa_keyref *kr, const void *c, int sha2_ndx)
 {
 
 	// 변수 선언
-    int k = RSAKEYSIZE / 8;
-    int hLen = sha_len(sha2_ndx);
+    int k = kr->k;
+    const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+    int hLen = hash != NULL ? hash->digest_size : SHA512_DIGEST_SIZE;
 	int DBlength = k - hLen - 1;
 	int lLen = strlen(label);
 	int pos = hLen;
-	int maskLen = ceil((double)DBlength/hLen)*hLen;
+	int val;
+
+	// 지원하지 않는 키 길이면 return PKCS_INVALID_KEYSIZE
+	if (k == 0) return PKCS_INVALID_KEYSIZE;
 
-	// 8비트 단위 매우 큰 수 정의
+	// 8비트 단위 매우 큰 수 정의. 마스크를 EM 안의 maskedSeed와 maskedDB에 바로 XOR해서 seed와 DB를 얻는다.
     unsigned char temC[k];
-	unsigned char maskedSeed[hLen];
-	unsigned char maskedDB[DBlength];
-	unsigned char seedMask[hLen];
-	unsigned char seed[hLen];
-	unsigned char dbMask[maskLen];
-	unsigned char DB[DBlength];
+	unsigned char *seed = temC + 1;
+	unsigned char *DB = temC + 1 + hLen;
 	unsigned char lHash[hLen];
 
+	// 해시함수 색인이 잘못되었으면 return PKCS_INVALID_HASH
+	if (hash == NULL) return PKCS_INVALID_HASH;
+
 	// 라벨 길이가 해시하기 너무 길다면 return PKCS_LABEL_TOO_LONG
 	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
 		if (countBits(lLen) > 61) return PKCS_LABEL_TOO_LONG;
@@ -256,39 +889,24 @@ int rsaes_oaep_decrypt(void *m, size_t *mLen, const void *label, const void *d,
     memcpy(temC, c, sizeof(unsigned char)*k);
 
 	// 복호화-> EM
-	if(rsa_cipher(temC, d, n) != 0) return PKCS_MSG_OUT_OF_RANGE;
+	if ((val = rsa_private(temC, kr)) != 0) return val;
    
 	// 첫 바이트가 0x00이 아니면 return PKCS_INITIAL_NONZERO
 	if (temC[0] != 0x00) return PKCS_INITIAL_NONZERO;
 	
-	// EM에서 maskedSeed 구하기
-    memcpy(maskedSeed, temC + 1, hLen);
-    
-	// EM에서 maskedDB 구하기
-	memcpy(maskedDB, temC + 1 + hLen, DBlength);
-
-	// maskedDB MGF해서 seedMask구하기
-    MGF1(maskedDB, DBlength, hLen, sha2_ndx, seedMask);
-	
-	// seedMask와 maskedSeed XOR해서 seed구하기
-    for (int i = 0; i < hLen; i++) {
-        seed[i] = seedMask[i] ^ maskedSeed[i];
-    }
-
-	// seed MGF해서 dbMask구하기
-    MGF1(seed, hLen, DBlength, sha2_ndx, dbMask);
+	// maskedDB MGF해서 maskedSeed에 XOR -> seed
+    if ((val = MGF1(DB, DBlength, hLen, sha2_ndx, seed)) != 0)
+        return val;
 
-
-	// dbMask와 maskedDB XOR해서 DB 구하기
-    for (int i = 0; i < DBlength; i++) {
-        DB[i] = dbMask[i] ^ maskedDB[i];
-    }
+	// seed MGF해서 maskedDB에 XOR -> DB
+    if ((val = MGF1(seed, hLen, DBlength, sha2_ndx, DB)) != 0)
+        return val;
 
 	// 라벨 해시
-    sha_gen(sha2_ndx, label, lLen, lHash);
+    hash->digest(label, lLen, lHash);
 
 	// 패딩 다음의 0x01 위치 구하기
-	while(DB[pos] == 0x00) pos++;
+	while(pos < DBlength && DB[pos] == 0x00) pos++;
 
 	// 평문 길이 복원
     *mLen = DBlength - pos - 1;
@@ -317,6 +935,63 @@ int rsaes_oaep_decrypt(void *m, size_t *mLen, const void *label, const void *d,
     return 0;
 }
 
+/*
+ * rsaes_oaep_decrypt() - RSA decrytion with the EME-OAEP encoding method
+ * 암호문 c를 개인키 (d,n)을 사용하여 원본 메시지 m과 길이 len을 회복한다.
+ * label과 sha2_ndx는 암호화할 때 사용한 것과 일치해야 한다.
+ * 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
+ */
+int rsaes_oaep_decrypt(void *m, size_t *mLen, const void *label, const void *d, const void *n, const void *c, int sha2_ndx)
+{
+	rsa_keyref kr = {d, n, NULL, NULL, RSAKEYSIZE / 8};
+
+	return oaep_decrypt(m, mLen, label, &kr, c, sha2_ndx);
+}
+
+/*
+ * rsaes_oaep_decrypt_crt() - 개인키 (d,n) 대신 CRT 개인키 key로 복호화한다.
+ */
+int rsaes_oaep_decrypt_crt(void *m, size_t *mLen, const void *label, const rsa_crt_key *key, const void *c, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, key, NULL, key_len(key->pub.bits)};
+
+	return oaep_decrypt(m, mLen, label, &kr, c, sha2_ndx);
+}
+
+/*
+ * rsaes_oaep_decrypt_handle() - 미리 읽어 둔 키 핸들 h로 복호화한다.
+ */
+int rsaes_oaep_decrypt_handle(void *m, size_t *mLen, const void *label, const rsa_handle *h, const void *c, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, NULL, h, key_len(h->bits)};
+
+	return oaep_decrypt(m, mLen, label, &kr, c, sha2_ndx);
+}
+
+
+/*
+ * pss_sign() - rsassa_pss_sign(), rsassa_pss_sign_crt(), rsassa_pss_sign_handle()의 본체
+ */
+static int pss_sign(const void *m, size_t mLen, const rsa_keyref *kr, void *s, int sha2_ndx)
+{
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	// 해시함수 색인이 잘못되었으면 return PKCS_INVALID_HASH
+	if (hash == NULL) return PKCS_INVALID_HASH;
+
+	// 메시지가 해시하기 위한 길이를 만족하는지 확인
+	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
+		if (countBits(mLen) > 61) return PKCS_MSG_TOO_LONG;
+	}
+	else {
+		if (countBits(mLen) > 125) return PKCS_MSG_TOO_LONG;
+	}
+
+	// m을 해시해서 mHash구하기
+	hash->digest(m, mLen, mHash);
+	return pss_sign_digest(mHash, kr, s, sha2_ndx);
+}
 
 /*
  * rsassa_pss_sign - RSA Signature Scheme with Appendix
@@ -324,78 +999,152 @@ int rsaes_oaep_decrypt(void *m, size_t *mLen, const void *label, const void *d,
  * s의 크기는 RSAKEYSIZE와 같아야 한다. 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
  */
 int rsassa_pss_sign(const void *m, size_t mLen, const void *d, const void *n, void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {d, n, NULL, NULL, RSAKEYSIZE / 8};
+
+	return pss_sign(m, mLen, &kr, s, sha2_ndx);
+}
+
+/*
+ * rsassa_pss_sign_crt - 개인키 (d,n) 대신 CRT 개인키 key로 서명한다.
+ */
+int rsassa_pss_sign_crt(const void *m, size_t mLen, const rsa_crt_key *key, void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, key, NULL, key_len(key->pub.bits)};
+
+	return pss_sign(m, mLen, &kr, s, sha2_ndx);
+}
+
+/*
+ * rsassa_pss_sign_handle - 미리 읽어 둔 키 핸들 h로 서명한다.
+ */
+int rsassa_pss_sign_handle(const void *m, size_t mLen, const rsa_handle *h, void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, NULL, h, key_len(h->bits)};
+
+	return pss_sign(m, mLen, &kr, s, sha2_ndx);
+}
+
+/*
+ * pss_sign_digest() - rsassa_pss_sign_digest(), rsassa_pss_sign_digest_crt(), rsassa_pss_sign_digest_handle()의 본체
+ */
+static int pss_sign_digest(const void *mHash, const rsa_keyref *kr, void *s, int sha2_ndx)
 {
     
 	// 변수 선언
-	int k = RSAKEYSIZE / 8;
-    int hLen = sha_len(sha2_ndx);
+	int k = kr->k;
+    const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+    int hLen = hash != NULL ? hash->digest_size : SHA512_DIGEST_SIZE;
     int DBlength = k - hLen - 1;
     int PS_len = DBlength - hLen - 1;
-	int maskLen = ceil((double)DBlength/hLen)*hLen;
-
-	// 8비트 단위의 큰 값들 선언
-    unsigned char mHash[hLen];
-    unsigned char M_P[8 + 2 * hLen];
-    unsigned char M_P_Hash[hLen];
-    unsigned char DB[DBlength];
-    unsigned char dbMask[maskLen];
-    unsigned char maskedDB[DBlength];
+    int val;
+
+	// 지원하지 않는 키 길이면 return PKCS_INVALID_KEYSIZE
+	if (k == 0) return PKCS_INVALID_KEYSIZE;
+
+	// 8비트 단위의 큰 값들 선언. EM = maskedDB || M_P_Hash || 0xBC를 EM 안에서 바로 만든다.
     unsigned char EM[k];
+    unsigned char *DB = EM;
+    unsigned char *M_P_Hash = EM + DBlength;
     unsigned char salt[hLen];
+    sha2_ctx ctx;
 
-	// 메시지가 해시하기 위한 길이를 만족하는지 확인
-	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
-		if (countBits(mLen) > 61) return PKCS_MSG_TOO_LONG;
-	}
-	else {
-		if (countBits(mLen) > 125) return PKCS_MSG_TOO_LONG;
-	}
+	// 해시함수 색인이 잘못되었으면 return PKCS_INVALID_HASH
+	if (hash == NULL) return PKCS_INVALID_HASH;
 
 	// 문서상으로 해당 조건이면 return PKCS_HASH_TOO_LONG
 	if (k < 2*hLen + 2) return PKCS_HASH_TOO_LONG;
 
-    // m을 해시해서 mHash구하기
-    sha_gen(sha2_ndx, (unsigned char *)m, mLen, mHash);
-
     // salt 구하기
     arc4random_buf(salt, sizeof(unsigned char) * hLen);
     
-    // M 프라임 구성하기
-    memset(M_P, 0x00, sizeof(unsigned char) * 8);
-    memcpy(M_P + 8, mHash, sizeof(unsigned char) * hLen);
-    memcpy(M_P + (8 + hLen), salt, sizeof(unsigned char) * hLen);
-
-    // M 프라임 해시해서 M_P_Hash 구하기
-    sha_gen(sha2_ndx, M_P, sizeof(M_P), M_P_Hash);
-
-    // M_P_Hash MGF해서 dbMask 구하기
-	MGF1(M_P_Hash, hLen, DBlength, sha2_ndx, dbMask);
+    // M 프라임 = (0x)00 00 00 00 00 00 00 00 || mHash || salt를 따로 만들지 않고
+    // 세 부분을 차례로 넣어서 M_P_Hash 구하기
+    hash->init(&ctx);
+    hash->update(&ctx, M_P_zero, sizeof(M_P_zero));
+    hash->update(&ctx, mHash, hLen);
+    hash->update(&ctx, salt, hLen);
+    hash->final(&ctx, M_P_Hash);
 
 	// DB 구성
     memset(DB, 0x00, sizeof(unsigned char) * PS_len);
     memset(DB + PS_len, 0x01, sizeof(unsigned char));
     memcpy(DB + (PS_len + 1), salt, sizeof(unsigned char) * hLen);
 
-    // DB와 dbMask XOR 연산해서 maskedDB 구하기
-    for (int i = 0; i < DBlength; i++)
-        maskedDB[i] = DB[i] ^ dbMask[i];
+    // M_P_Hash MGF해서 DB에 XOR -> maskedDB
+    if ((val = MGF1(M_P_Hash, hLen, DBlength, sha2_ndx, DB)) != 0)
+        return val;
 
-    // EM 구성
-    memcpy(EM, maskedDB, DBlength);
-    memcpy(EM + DBlength, M_P_Hash, sizeof(unsigned char) * hLen);
-    memset(EM + (DBlength + hLen), 0xBC, sizeof(unsigned char));
+    // 마지막 바이트
+    EM[k - 1] = 0xBC;
 
 	// EM의 맨 왼쪽 비트가 1이라면 0으로 바꿔주기
 	if ((EM[0] >> 7) == 1) EM[0] = EM[0] ^ 0x80;
 
     // EM을 개인키로 서명하기
-    if (rsa_cipher(EM, d, n) != 0) return PKCS_MSG_OUT_OF_RANGE;
+    if ((val = rsa_private(EM, kr)) != 0) return val;
     	
 	// s에 복사
 	memcpy(s, EM, sizeof(EM));
     return 0;
 }
 
+/*
+ * rsassa_pss_sign_digest - 메시지 대신 해시값 mHash로 서명한다.
+ * mHash는 sha2_ndx 해시함수로 구한 메시지의 해시값이다. 메시지를 해시하는 곳과 서명하는 곳이
+ * 다를 때 사용한다. 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
+ */
+int rsassa_pss_sign_digest(const void *mHash, const void *d, const void *n, void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {d, n, NULL, NULL, RSAKEYSIZE / 8};
+
+	return pss_sign_digest(mHash, &kr, s, sha2_ndx);
+}
+
+/*
+ * rsassa_pss_sign_digest_crt - 개인키 (d,n) 대신 CRT 개인키 key로 해시값 mHash에 서명한다.
+ */
+int rsassa_pss_sign_digest_crt(const void *mHash, const rsa_crt_key *key, void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, key, NULL, key_len(key->pub.bits)};
+
+	return pss_sign_digest(mHash, &kr, s, sha2_ndx);
+}
+
+/*
+ * rsassa_pss_sign_digest_handle - 미리 읽어 둔 키 핸들 h로 해시값 mHash에 서명한다.
+ */
+int rsassa_pss_sign_digest_handle(const void *mHash, const rsa_handle *h, void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, NULL, h, key_len(h->bits)};
+
+	return pss_sign_digest(mHash, &kr, s, sha2_ndx);
+}
+
+
+/*
+ * pss_verify() - rsassa_pss_verify(), rsassa_pss_verify_pub(), rsassa_pss_verify_handle()의 본체
+ */
+static int pss_verify(const void *m, size_t mLen, const rsa_keyref *kr, const void *s, int sha2_ndx)
+{
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	// 해시함수 색인이 잘못되었으면 return PKCS_INVALID_HASH
+	if (hash == NULL) return PKCS_INVALID_HASH;
+
+	// m의 길이가 해시하기 너무 긴 지 확인
+	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
+		if (countBits(mLen) > 61) return PKCS_MSG_TOO_LONG;
+	}
+	else {
+		if (countBits(mLen) > 125) return PKCS_MSG_TOO_LONG;
+	}
+
+	// m을 해시해서 mHash 구하기
+	hash->digest(m, mLen, mHash);
+	return pss_verify_digest(mHash, kr, s, sha2_ndx);
+}
 
 /*
  * rsassa_pss_verify - RSA Signature Scheme with Appendix
@@ -403,43 +1152,67 @@ int rsassa_pss_sign(const void *m, size_t mLen, const void *d, const void *n, vo
  * 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
  */
 int rsassa_pss_verify(const void *m, size_t mLen, const void *e, const void *n, const void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {e, n, NULL, NULL, RSAKEYSIZE / 8};
+
+	return pss_verify(m, mLen, &kr, s, sha2_ndx);
+}
+
+/*
+ * rsassa_pss_verify_pub - 공개키 객체 pub으로 서명 s를 검증한다.
+ */
+int rsassa_pss_verify_pub(const void *m, size_t mLen, const rsa_public_key *pub, const void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {pub->e, pub->n, NULL, NULL, key_len(pub->bits)};
+
+	return pss_verify(m, mLen, &kr, s, sha2_ndx);
+}
+
+/*
+ * rsassa_pss_verify_handle - 미리 읽어 둔 키 핸들 h로 서명 s를 검증한다.
+ */
+int rsassa_pss_verify_handle(const void *m, size_t mLen, const rsa_handle *h, const void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, NULL, h, key_len(h->bits)};
+
+	return pss_verify(m, mLen, &kr, s, sha2_ndx);
+}
+
+/*
+ * pss_verify_digest() - rsassa_pss_verify_digest(), rsassa_pss_verify_digest_pub(), rsassa_pss_verify_digest_handle()의 본체
+ */
+static int pss_verify_digest(const void *mHash, const rsa_keyref *kr, const void *s, int sha2_ndx)
 {
 
 	// 변수 선언
-	int k = RSAKEYSIZE / 8;
-	int hLen = sha_len(sha2_ndx);
+	int k = kr->k;
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	int hLen = hash != NULL ? hash->digest_size : SHA512_DIGEST_SIZE;
 	int DBlength = k - hLen - 1;
 	int PS_len = DBlength - hLen - 1;
-	int maskLen = ceil((double)DBlength/hLen)*hLen;
+	int val;
+
+	// 지원하지 않는 키 길이면 return PKCS_INVALID_KEYSIZE
+	if (k == 0) return PKCS_INVALID_KEYSIZE;
 
-	// 8비트 단위의 큰 값들 선언
-	unsigned char mHash[hLen];
-	unsigned char M_p[8+hLen*2];
+	// 8비트 단위의 큰 값들 선언. EM = maskedDB || H || 0xBC의 maskedDB에 마스크를 바로 XOR해서 DB를 얻는다.
 	unsigned char M_P_Hash[hLen];
-	unsigned char EM_H[hLen];
-	unsigned char salt[hLen];
-	unsigned char DB[DBlength];
-	unsigned char maskedDB[DBlength];
-	unsigned char dbMask[maskLen];
 	unsigned char temS[k];
+	unsigned char *DB = temS;
+	unsigned char *EM_H = temS + DBlength;
+	unsigned char *salt = DB + PS_len + 1;
+	sha2_ctx ctx;
 
-	// m의 길이가 해시하기 너무 긴 지 확인
-	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
-		if (countBits(mLen) > 61) return PKCS_MSG_TOO_LONG;
-	}
-	else {
-		if (countBits(mLen) > 125) return PKCS_MSG_TOO_LONG;
-	}
+	// 해시함수 색인이 잘못되었으면 return PKCS_INVALID_HASH
+	if (hash == NULL) return PKCS_INVALID_HASH;
 
 	// 문서에 따라서 해당 조건이면 return PKCS_HASH_TOO_LONG
 	if (k < 2*hLen + 2) return PKCS_HASH_TOO_LONG;
 
-	// m을 해시해서 mHash 구하기
-	sha_gen(sha2_ndx, m, mLen, mHash);
 	memcpy(temS, s, sizeof(unsigned char)*k);
 
 	// s를 검증해서 EM 구하기 
-	if (rsa_cipher(temS,e,n) != 0) return PKCS_MSG_OUT_OF_RANGE;
+	if ((val = rsa_public(temS, kr)) != 0) return val;
 	
 	// EM의 마지막 바이트가 0xBC인지 확인
 	if (temS[k-1] != 0xBC) return PKCS_INVALID_LAST;
@@ -447,18 +1220,9 @@ int rsassa_pss_verify(const void *m, size_t mLen, const void *e, const void *n,
 	// EM의 가장 첫 비트가 0인지 확인
 	if ((temS[0] >> 7) != 0) return PKCS_INVALID_INIT;
 
-	// EM에서 해시값 뽑아내기
-	memcpy(EM_H, temS+DBlength, sizeof(unsigned char)*hLen);
-
-	// EM에서 maskedDB 뽑아내기
-	memcpy(maskedDB, temS, sizeof(unsigned char)*(DBlength));
-    
-	// EM_H 해시해서 dbMask 구하기
-	MGF1(EM_H, hLen, DBlength, sha2_ndx, dbMask);
-	
-	// maskedDB와 dbMask를 XOR 연산해서 DB 구하기
-	for (int i = 0; i < DBlength; i++)
-		DB[i] = maskedDB[i] ^ dbMask[i];
+	// EM_H MGF해서 maskedDB에 XOR -> DB
+	if ((val = MGF1(EM_H, hLen, DBlength, sha2_ndx, DB)) != 0)
+		return val;
 
 	// 만약 DB의 첫 비트가 1이면 0으로 바꿔주기
 	// 이전 서명에서 maskedDB의 첫 비트를 변경해줬으니
@@ -470,16 +1234,12 @@ int rsassa_pss_verify(const void *m, size_t mLen, const void *e, const void *n,
 		if(DB[i] != 0x00) return PKCS_INVALID_PD2;
 	if(DB[PS_len] != 0x01) return PKCS_INVALID_PD2;
 
-	// DB에서 salt 뽑아내기
-	memcpy(salt, DB+PS_len+1, sizeof(unsigned char)*hLen);
-
-	// M 프라임 만들기
-	memset(M_p, 0x00, sizeof(unsigned char)*8);
-	memcpy(M_p + 8, mHash, sizeof(unsigned char)*hLen);
-	memcpy(M_p + hLen + 8, salt, sizeof(unsigned char)*hLen);
-
-	// M_P 해시해서 M_P_Hash 만들기
-	sha_gen(sha2_ndx, M_p, 8+2*hLen, M_P_Hash);
+	// M 프라임 = (0x)00 00 00 00 00 00 00 00 || mHash || salt를 해시해서 M_P_Hash 만들기
+	hash->init(&ctx);
+	hash->update(&ctx, M_P_zero, sizeof(M_P_zero));
+	hash->update(&ctx, mHash, hLen);
+	hash->update(&ctx, salt, hLen);
+	hash->final(&ctx, M_P_Hash);
 
 	// 해시값 일치하는지 확인
 	for (int i = 0; i < hLen; i++){
@@ -491,46 +1251,306 @@ int rsassa_pss_verify(const void *m, size_t mLen, const void *e, const void *n,
 	return 0;
 }
 
-void MGF1(const unsigned char *mgfSeed, size_t seed_len, size_t mask_len, int
-sha2_ndx, unsigned char *T){
-	
-	// 변수 선언
-	size_t hLen;
-	uint64_t s;
+/*
+ * rsassa_pss_verify_digest - 메시지 대신 해시값 mHash에 대한 서명 s를 공개키 (e,n)으로 검증한다.
+ * 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
+ */
+int rsassa_pss_verify_digest(const void *mHash, const void *e, const void *n, const void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {e, n, NULL, NULL, RSAKEYSIZE / 8};
 
-	// 값 구하기
-	hLen = sha_len(sha2_ndx);
-	s = hLen * 0x100000000;
+	return pss_verify_digest(mHash, &kr, s, sha2_ndx);
+}
 
-	// 문서에 따라서 해당 조건이면 강제 종료
-	if (mask_len > s) {
-		printf("mask_len too long");
-		exit(1);
-	}
-	
-	
-	// ceil((double)mask_len/hLen)만큼 반복해서 T에 해시값을 추가하기
-	for (int i = 0; i < ceil((double)mask_len/hLen); i++){
-		// 임시 변수 선언
-		unsigned char c[4];
-		unsigned char digest[hLen];
-		unsigned char tem[seed_len + 4];
+/*
+ * rsassa_pss_verify_digest_pub - 공개키 객체 pub으로 해시값 mHash에 대한 서명 s를 검증한다.
+ */
+int rsassa_pss_verify_digest_pub(const void *mHash, const rsa_public_key *pub, const void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {pub->e, pub->n, NULL, NULL, key_len(pub->bits)};
 
-		// c 구하기 -> I2OSP(i, 4) 일때 알고리즘
-		I2OSP(i, c);
+	return pss_verify_digest(mHash, &kr, s, sha2_ndx);
+}
 
-		// tem = mgfSees || c
-		memcpy(tem, mgfSeed, sizeof(unsigned char)*seed_len);
-		memcpy(tem + seed_len, c, sizeof(unsigned char)*4);
+/*
+ * rsassa_pss_verify_digest_handle - 미리 읽어 둔 키 핸들 h로 해시값 mHash에 대한 서명 s를 검증한다.
+ */
+int rsassa_pss_verify_digest_handle(const void *mHash, const rsa_handle *h, const void *s, int sha2_ndx)
+{
+	rsa_keyref kr = {NULL, NULL, NULL, h, key_len(h->bits)};
 
-		// tem 해시해서 digest에 넣기
-		sha_gen(sha2_ndx, tem, seed_len+4, digest);
+	return pss_verify_digest(mHash, &kr, s, sha2_ndx);
+}
 
-		// T = T || digest
-		memcpy(T+hLen*i, digest, sizeof(unsigned char)*hLen);
-	
-	}	
+/*
+ * rsassa_pss_init - 메시지를 나눠서 서명하거나 검증하기 위해 ctx를 준비한다.
+ * rsassa_pss_update로 메시지를 도착하는 대로 넣은 다음 rsassa_pss_sign_final이나
+ * rsassa_pss_verify_final로 끝낸다. 메시지 전체를 메모리에 올릴 필요가 없다.
+ * 성공하면 0, 해시함수 색인이 잘못되었으면 PKCS_INVALID_HASH를 넘겨준다.
+ */
+int rsassa_pss_init(rsassa_pss_ctx *ctx, int sha2_ndx)
+{
+	if ((ctx->hash = sha2_get_desc(sha2_ndx)) == NULL)
+		return PKCS_INVALID_HASH;
+	ctx->sha2_ndx = sha2_ndx;
+	ctx->hash->init(&ctx->ctx);
+	return 0;
+}
+
+void rsassa_pss_update(rsassa_pss_ctx *ctx, const void *m, size_t mLen)
+{
+	if (mLen > 0)
+		ctx->hash->update(&ctx->ctx, m, mLen);
+}
+
+/*
+ * rsassa_pss_sign_final - 지금까지 넣은 메시지를 개인키 (d,n)으로 서명한 결과를 s에 저장한다.
+ */
+int rsassa_pss_sign_final(rsassa_pss_ctx *ctx, const void *d, const void *n, void *s)
+{
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	ctx->hash->final(&ctx->ctx, mHash);
+	return rsassa_pss_sign_digest(mHash, d, n, s, ctx->sha2_ndx);
+}
+
+/*
+ * rsassa_pss_sign_final_crt - 지금까지 넣은 메시지를 CRT 개인키 key로 서명한 결과를 s에 저장한다.
+ */
+int rsassa_pss_sign_final_crt(rsassa_pss_ctx *ctx, const rsa_crt_key *key, void *s)
+{
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	ctx->hash->final(&ctx->ctx, mHash);
+	return rsassa_pss_sign_digest_crt(mHash, key, s, ctx->sha2_ndx);
+}
+
+/*
+ * rsassa_pss_verify_final - 지금까지 넣은 메시지에 대한 서명 s를 공개키 (e,n)으로 검증한다.
+ */
+int rsassa_pss_verify_final(rsassa_pss_ctx *ctx, const void *e, const void *n, const void *s)
+{
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	ctx->hash->final(&ctx->ctx, mHash);
+	return rsassa_pss_verify_digest(mHash, e, n, s, ctx->sha2_ndx);
+}
+
+/*
+ * rsassa_pss_verify_final_pub - 지금까지 넣은 메시지에 대한 서명 s를 공개키 객체 pub으로 검증한다.
+ */
+int rsassa_pss_verify_final_pub(rsassa_pss_ctx *ctx, const rsa_public_key *pub, const void *s)
+{
+	unsigned char mHash[SHA512_DIGEST_SIZE];
 
+	ctx->hash->final(&ctx->ctx, mHash);
+	return rsassa_pss_verify_digest_pub(mHash, pub, s, ctx->sha2_ndx);
+}
+
+/*
+ * rsassa_pss_sign_final_handle - 지금까지 넣은 메시지를 키 핸들 h로 서명한 결과를 s에 저장한다.
+ */
+int rsassa_pss_sign_final_handle(rsassa_pss_ctx *ctx, const rsa_handle *h, void *s)
+{
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	ctx->hash->final(&ctx->ctx, mHash);
+	return rsassa_pss_sign_digest_handle(mHash, h, s, ctx->sha2_ndx);
+}
+
+/*
+ * rsassa_pss_verify_final_handle - 지금까지 넣은 메시지에 대한 서명 s를 키 핸들 h로 검증한다.
+ */
+int rsassa_pss_verify_final_handle(rsassa_pss_ctx *ctx, const rsa_handle *h, const void *s)
+{
+	unsigned char mHash[SHA512_DIGEST_SIZE];
+
+	ctx->hash->final(&ctx->ctx, mHash);
+	return rsassa_pss_verify_digest_handle(mHash, h, s, ctx->sha2_ndx);
+}
+
+/*
+ * 일괄 검증 작업
+ * 스레드들이 next를 BATCH_CHUNK개씩 가져가서 검증하므로 항목마다 걸리는 시간이 달라도
+ * 먼저 끝난 스레드가 남은 항목을 나눠 맡는다.
+ */
+#define BATCH_CHUNK 32
+
+typedef struct {
+    const rsassa_pss_batch_item *items;
+    int *status;
+    size_t count, next;
+    int sha2_ndx;
+    const sha2_desc *hash;
+    pthread_mutex_t lock;
+} batch_job;
+
+/*
+ * batch_verify() - items[from..to-1]을 검증한다.
+ * 메시지는 SHA2_MB_MAXLANES개씩 모아 다중 버퍼 해시로 한 번에 해시한 다음 하나씩 검증한다.
+ */
+static void batch_verify(batch_job *job, size_t from, size_t to)
+{
+    const unsigned char *msg[SHA2_MB_MAXLANES];
+    unsigned char mHash[SHA2_MB_MAXLANES][SHA512_DIGEST_SIZE], *digest[SHA2_MB_MAXLANES];
+    size_t len[SHA2_MB_MAXLANES], ndx[SHA2_MB_MAXLANES], i;
+    int limit = job->sha2_ndx == SHA224 || job->sha2_ndx == SHA256 ? 61 : 125;
+    int n = 0, j;
+    rsa_keyref kr = {NULL, NULL, NULL, NULL, 0};
+
+    for (j = 0; j < SHA2_MB_MAXLANES; ++j)
+        digest[j] = mHash[j];
+    for (i = from; i < to || n > 0; ++i) {
+        if (i < to) {
+            if (countBits(job->items[i].len) > limit) {
+                job->status[i] = PKCS_MSG_TOO_LONG;
+                continue;
+            }
+            msg[n] = job->items[i].msg;
+            len[n] = job->items[i].len;
+            ndx[n++] = i;
+            if (n < SHA2_MB_MAXLANES && i + 1 < to)
+                continue;
+        }
+        job->hash->digest_mb(msg, len, digest, n);
+        for (j = 0; j < n; ++j) {
+            kr.h = job->items[ndx[j]].key;
+            kr.k = key_len(kr.h->bits);
+            job->status[ndx[j]] = pss_verify_digest(mHash[j], &kr, job->items[ndx[j]].sig, job->sha2_ndx);
+        }
+        n = 0;
+    }
+}
+
+static void *batch_worker(void *arg)
+{
+    batch_job *job = arg;
+    size_t from, to;
+
+    for (;;) {
+        pthread_mutex_lock(&job->lock);
+        from = job->next;
+        to = job->count - from > BATCH_CHUNK ? from + BATCH_CHUNK : job->count;
+        job->next = to;
+        pthread_mutex_unlock(&job->lock);
+        if (from == to)
+            return NULL;
+        batch_verify(job, from, to);
+    }
+}
+
+/*
+ * rsassa_pss_verify_batch() - items[0..count-1]의 서명을 한꺼번에 검증하고 결과를 status에 넣는다.
+ * 이 스레드를 포함해 nthreads개의 스레드가 나눠서 검증한다. nthreads가 0 이하이면 온라인 CPU 수만큼,
+ * 스레드를 만들지 못하면 만든 스레드까지만 쓴다. 검증에 실패한 항목 수를 넘겨준다.
+ */
+size_t rsassa_pss_verify_batch(const rsassa_pss_batch_item *items, size_t count, int *status, int sha2_ndx, int nthreads)
+{
+    batch_job job;
+    pthread_t tid[RSA_BATCH_MAXTHREADS];
+    size_t i, bad = 0;
+    int t, started = 0;
+
+    job.hash = sha2_get_desc(sha2_ndx);
+    if (job.hash == NULL) {
+        for (i = 0; i < count; ++i)
+            status[i] = PKCS_INVALID_HASH;
+        return count;
+    }
+    job.items = items;
+    job.status = status;
+    job.count = count;
+    job.next = 0;
+    job.sha2_ndx = sha2_ndx;
+    pthread_mutex_init(&job.lock, NULL);
+    if (nthreads <= 0)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > RSA_BATCH_MAXTHREADS)
+        nthreads = RSA_BATCH_MAXTHREADS;
+    if ((size_t)nthreads > (count + BATCH_CHUNK - 1) / BATCH_CHUNK)
+        nthreads = (count + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    for (t = 1; t < nthreads; ++t) {
+        if (pthread_create(&tid[started], NULL, batch_worker, &job) != 0)
+            break;
+        ++started;
+    }
+    batch_worker(&job);
+    for (t = 0; t < started; ++t)
+        pthread_join(tid[t], NULL);
+    pthread_mutex_destroy(&job.lock);
+    for (i = 0; i < count; ++i)
+        bad += status[i] != 0;
+    return bad;
+}
+
+/*
+ * MGF1() - mgfSeed로 만든 mask_len 바이트의 마스크를 T에 XOR한다.
+ * 마스크를 따로 저장하지 않으므로 가릴 데이터 위에서 바로 호출한다. 해시할 블록 수는 길이로만
+ * 정해지고 데이터 값과 관계없다. seed는 해시 상태에 한 번만 넣어 두고 카운터마다 그 상태를
+ * 복사해서 I2OSP(C, 4)만 이어서 넣는다. seed가 한 블록보다 짧으면 복사로 아낄 압축이 없으므로
+ * seed || C 블록들을 다중 버퍼 해시로 SHA2_MB_MAXLANES개씩 한 번에 계산한다.
+ * 성공하면 0, 마스크가 2^32 * hLen 바이트보다 길면 PKCS_MASK_TOO_LONG을 넘겨준다.
+ */
+int MGF1(const unsigned char *mgfSeed, size_t seed_len, size_t mask_len, int
+sha2_ndx, unsigned char *T){
+
+	// 변수 선언
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char tem[SHA2_MB_MAXLANES][SHA512_BLOCK_SIZE + 4];
+	unsigned char digest[SHA2_MB_MAXLANES][SHA512_DIGEST_SIZE];
+	const unsigned char *msg[SHA2_MB_MAXLANES];
+	unsigned char *md[SHA2_MB_MAXLANES];
+	size_t len[SHA2_MB_MAXLANES];
+	sha2_ctx seed_ctx, ctx;
+	size_t hLen, count, i, j, l, n, off, m;
+
+	if (hash == NULL) return PKCS_INVALID_HASH;
+	hLen = hash->digest_size;
+
+	// 블록 수 = ceil(mask_len/hLen), 카운터가 4바이트이므로 2^32개까지
+	count = mask_len / hLen + (mask_len % hLen != 0);
+	if ((uint64_t)count > 0x100000000ULL) return PKCS_MASK_TOO_LONG;
+
+	if (seed_len < (size_t)hash->block_size && count > 1) {
+		// tem[l] = mgfSeed || I2OSP(i + l, 4)
+		for (l = 0; l < SHA2_MB_MAXLANES; l++) {
+			memcpy(tem[l], mgfSeed, seed_len);
+			msg[l] = tem[l];
+			len[l] = seed_len + 4;
+			md[l] = digest[l];
+		}
+		for (i = 0; i < count; i += n) {
+			n = count - i < SHA2_MB_MAXLANES ? count - i : SHA2_MB_MAXLANES;
+			for (l = 0; l < n; l++)
+				I2OSP(i + l, tem[l] + seed_len);
+			hash->digest_mb(msg, len, md, (int)n);
+
+			// 마지막 블록은 mask_len까지만 XOR한다.
+			for (l = 0; l < n; l++) {
+				off = (i + l) * hLen;
+				m = mask_len - off < hLen ? mask_len - off : hLen;
+				for (j = 0; j < m; j++)
+					T[off + j] ^= digest[l][j];
+			}
+		}
+	}
+	else {
+		hash->init(&seed_ctx);
+		if (seed_len > 0)
+			hash->update(&seed_ctx, mgfSeed, seed_len);
+		for (i = 0; i < count; i++) {
+			ctx = seed_ctx;
+			I2OSP(i, tem[0]);
+			hash->update(&ctx, tem[0], 4);
+			hash->final(&ctx, digest[0]);
+
+			off = i * hLen;
+			m = mask_len - off < hLen ? mask_len - off : hLen;
+			for (j = 0; j < m; j++)
+				T[off + j] ^= digest[0][j];
+		}
+	}
+	return 0;
 }
 
 void I2OSP(size_t x, unsigned char *t){
@@ -553,35 +1573,3 @@ int countBits(size_t num) {
     return count;
 }
 
-
-// 원하는 해시 함수 버전으로 해쉬값을 생성해준다.
-static void sha_gen(int sha2_ndx, const unsigned char *message, unsigned int len, unsigned char *digest)
-{
-
-	// 함수 포인터 배열 -> 해시 함수들
-    void (*f[6])(const unsigned char *, unsigned int, unsigned char *) = {
-        sha224, sha256, sha384, sha512, sha512_224, sha512_256
-    };
-
-	// 정당한 값이 들어왔다면 해당 해시 함수로 해시
-    if (sha2_ndx >= 0 && sha2_ndx <= 5)
-        f[sha2_ndx](message, len, digest);
-
-}
-
-//  원하는 해시 값의 길이를 리턴한다.
-static int sha_len(int sha2_ndx)
-{
-	// 미리 정의된 해시 길이의 배열
-    int shalen_index[6] = {
-        SHA224_DIGEST_SIZE, SHA256_DIGEST_SIZE, SHA384_DIGEST_SIZE,
-        SHA512_DIGEST_SIZE, SHA224_DIGEST_SIZE, SHA256_DIGEST_SIZE
-        };
-    
-	// 정당하지 못한 값이라면 리턴
-    if (sha2_ndx > 5 || sha2_ndx < 0)
-        return 1;
-	// 해시 길이 리턴
-    return (shalen_index[sha2_ndx]);
-}
-
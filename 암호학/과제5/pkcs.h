@@ -7,7 +7,17 @@
 #ifndef _PKCS_H_
 #define _PKCS_H_
 
+#include <stddef.h>
+#include <gmp.h>
+#include "sha2.h"
+
+/*
+ * RSAKEYSIZE는 옥텟 문자열 (e,d,n)을 받는 함수들이 쓰는 키 길이이다.
+ * 키 객체(rsa_public_key, rsa_crt_key)는 길이를 bits에 따로 가지므로 한 프로그램에서
+ * 2048, 3072, 4096비트 키를 함께 쓸 수 있다. 키 길이는 2048 이상 RSA_MAXKEYSIZE 이하의 16의 배수이다.
+ */
 #define RSAKEYSIZE 2048
+#define RSA_MAXKEYSIZE 4096
 
 /*
  * SHA-2 function index list
@@ -32,6 +42,12 @@
 #define PKCS_INVALID_LAST       8
 #define PKCS_INVALID_INIT       9
 #define PKCS_INVALID_PD2        10
+#define PKCS_INVALID_HASH       11
+#define PKCS_MASK_TOO_LONG      12
+#define PKCS_CRT_FAULT          13
+#define PKCS_INVALID_KEYSIZE    14
+#define PKCS_NOT_PRIVATE        15
+#define PKCS_INVALID_KEY        16
 
 void rsa_generate_key(void *e, void *d, void *n, int mode);
 int rsaes_oaep_encrypt(const void *msg, size_t len, const void *label, const void *e, const void *n, void *c, int sha2_ndx);
@@ -39,4 +55,128 @@ int rsaes_oaep_decrypt(void *msg, size_t *len, const void *label, const void *d,
 int rsassa_pss_sign(const void *msg, size_t len, const void *d, const void *n, void *sig, int sha2_ndx);
 int rsassa_pss_verify(const void *msg, size_t len, const void *e, const void *n, const void *sig, int sha2_ndx);
 
+/*
+ * 메시지를 나눠서 해시하는 RSASSA-PSS 서명과 검증
+ * rsassa_pss_init()으로 시작하고 rsassa_pss_update()로 메시지를 넣은 다음,
+ * rsassa_pss_sign_final()이나 rsassa_pss_verify_final()로 끝낸다.
+ * *_digest()는 메시지 대신 sha2_ndx 해시함수로 미리 구한 해시값 mHash를 받는다.
+ */
+typedef struct {
+    int sha2_ndx;
+    const sha2_desc *hash;
+    sha2_ctx ctx;
+} rsassa_pss_ctx;
+
+int rsassa_pss_init(rsassa_pss_ctx *ctx, int sha2_ndx);
+void rsassa_pss_update(rsassa_pss_ctx *ctx, const void *msg, size_t len);
+int rsassa_pss_sign_final(rsassa_pss_ctx *ctx, const void *d, const void *n, void *sig);
+int rsassa_pss_verify_final(rsassa_pss_ctx *ctx, const void *e, const void *n, const void *sig);
+int rsassa_pss_sign_digest(const void *mHash, const void *d, const void *n, void *sig, int sha2_ndx);
+int rsassa_pss_verify_digest(const void *mHash, const void *e, const void *n, const void *sig, int sha2_ndx);
+
+/*
+ * RSA 공개키 객체
+ * n과 e는 앞에서부터 bits/8 바이트를 쓴다. 암호문과 서명의 크기도 bits/8 바이트이다.
+ */
+typedef struct {
+    int bits;
+    unsigned char n[RSA_MAXKEYSIZE/8];
+    unsigned char e[RSA_MAXKEYSIZE/8];
+} rsa_public_key;
+
+/*
+ * 중국인의 나머지 정리(CRT)를 쓰는 RSA 개인키 (RFC 8017 3.2절의 두 번째 형식)
+ * p, q, dP = d mod (p-1), dQ = d mod (q-1), qInv = q^-1 mod p를 함께 보관해서
+ * 개인키 연산을 절반 크기의 거듭제곱 두 번과 Garner 결합으로 계산한다.
+ * 결과는 내보내기 전에 공개키 e로 다시 확인하고, 다르면 PKCS_CRT_FAULT를 넘겨준다.
+ * pub에 공개키가 들어 있고, d는 bits/8 바이트, 나머지 성분은 bits/16 바이트를 쓴다.
+ * 키 길이가 RSAKEYSIZE이면 pub.e, pub.n, d를 기존 (e,d,n) 함수에도 그대로 쓸 수 있다.
+ */
+typedef struct {
+    rsa_public_key pub;
+    unsigned char d[RSA_MAXKEYSIZE/8];
+    unsigned char p[RSA_MAXKEYSIZE/16];
+    unsigned char q[RSA_MAXKEYSIZE/16];
+    unsigned char dP[RSA_MAXKEYSIZE/16];
+    unsigned char dQ[RSA_MAXKEYSIZE/16];
+    unsigned char qInv[RSA_MAXKEYSIZE/16];
+} rsa_crt_key;
+
+int rsa_generate_crt_key(rsa_crt_key *key, int bits, int mode);
+int rsaes_oaep_encrypt_pub(const void *msg, size_t len, const void *label, const rsa_public_key *pub, void *c, int sha2_ndx);
+int rsassa_pss_verify_pub(const void *msg, size_t len, const rsa_public_key *pub, const void *sig, int sha2_ndx);
+int rsassa_pss_verify_final_pub(rsassa_pss_ctx *ctx, const rsa_public_key *pub, const void *sig);
+int rsassa_pss_verify_digest_pub(const void *mHash, const rsa_public_key *pub, const void *sig, int sha2_ndx);
+int rsaes_oaep_decrypt_crt(void *msg, size_t *len, const void *label, const rsa_crt_key *key, const void *c, int sha2_ndx);
+int rsassa_pss_sign_crt(const void *msg, size_t len, const rsa_crt_key *key, void *sig, int sha2_ndx);
+int rsassa_pss_sign_final_crt(rsassa_pss_ctx *ctx, const rsa_crt_key *key, void *sig);
+int rsassa_pss_sign_digest_crt(const void *mHash, const rsa_crt_key *key, void *sig, int sha2_ndx);
+
+
+/*
+ * RSA 키 핸들
+ * 키를 한 번만 읽어서 림브 배열로 보관하고, 모듈러스마다 몽고메리 상수 minv = -m^-1 mod 2^GMP_NUMB_BITS,
+ * one = R mod m, rr = R^2 mod m을 미리 계산해 둔다. 공개 지수의 거듭제곱과 결과 확인은 이 상수로
+ * 고정 윈도 몽고메리 거듭제곱을 하고, dP, dQ의 거듭제곱은 보관한 림브에 mpz_roinit_n()을 씌워서
+ * rsa_crt_key와 같이 mpz_powm()으로 한다. 따라서 비밀 지수의 거듭제곱은 상수 시간이 아니다.
+ * 온라인 CPU가 둘 이상이면 dQ의 거듭제곱은 두 번째 스레드에서 dP의 거듭제곱과 함께 한다.
+ * 분기와 메모리 접근이 비밀 값과 관계없는 것은 c mod p, c mod q, m2 mod p를 구하는 나눗셈
+ * (mpn_sec_div_r())과 Garner 결합(mpn_cnd_add_n(), qInv 몽고메리 곱셈, mpn_sec_add_1())뿐이다.
+ * 모듈러스가 홀수가 아니거나 bits 비트가 아니면 rsa_handle_init_pub(), rsa_handle_init_crt()가
+ * PKCS_INVALID_KEY를 넘겨준다.
+ * rsa_handle_init_pub()으로 만든 핸들은 공개키 연산만 할 수 있고, 개인키 연산에는 PKCS_NOT_PRIVATE를 넘겨준다.
+ * rsa_handle_init_crt()로 만든 핸들은 모든 연산을 할 수 있으며 rsa_crt_key와 같이 결과를 e로 다시 확인한다.
+ */
+#define RSA_MAXLIMBS (RSA_MAXKEYSIZE / GMP_NUMB_BITS)
+
+typedef struct {
+    int size;
+    mp_limb_t m[RSA_MAXLIMBS];
+    mp_limb_t minv;
+    mp_limb_t one[RSA_MAXLIMBS];
+    mp_limb_t rr[RSA_MAXLIMBS];
+} rsa_mont_ctx;
+
+typedef struct {
+    int bits;
+    int priv;
+    rsa_mont_ctx n, p, q;
+    mp_limb_t e[RSA_MAXLIMBS];
+    mp_limb_t dP[RSA_MAXLIMBS/2];
+    mp_limb_t dQ[RSA_MAXLIMBS/2];
+    mp_limb_t qInv[RSA_MAXLIMBS/2];
+    int ebits;
+} rsa_handle;
+
+int rsa_handle_init_pub(rsa_handle *h, const rsa_public_key *pub);
+int rsa_handle_init_crt(rsa_handle *h, const rsa_crt_key *key);
+int rsaes_oaep_encrypt_handle(const void *msg, size_t len, const void *label, const rsa_handle *h, void *c, int sha2_ndx);
+int rsaes_oaep_decrypt_handle(void *msg, size_t *len, const void *label, const rsa_handle *h, const void *c, int sha2_ndx);
+int rsassa_pss_sign_handle(const void *msg, size_t len, const rsa_handle *h, void *sig, int sha2_ndx);
+int rsassa_pss_verify_handle(const void *msg, size_t len, const rsa_handle *h, const void *sig, int sha2_ndx);
+int rsassa_pss_sign_digest_handle(const void *mHash, const rsa_handle *h, void *sig, int sha2_ndx);
+int rsassa_pss_verify_digest_handle(const void *mHash, const rsa_handle *h, const void *sig, int sha2_ndx);
+int rsassa_pss_sign_final_handle(rsassa_pss_ctx *ctx, const rsa_handle *h, void *sig);
+int rsassa_pss_verify_final_handle(rsassa_pss_ctx *ctx, const rsa_handle *h, const void *sig);
+
+
+/*
+ * RSASSA-PSS 일괄 검증
+ * items[i]의 메시지 msg를 sha2_ndx 해시함수로 해시해서 키 핸들 key로 서명 sig를 검증하고,
+ * rsassa_pss_verify_handle()이 돌려줄 값을 status[i]에 넣는다. 항목마다 다른 키를 써도 된다.
+ * 메시지는 다중 버퍼 해시로 묶어서 해시하고, 검증은 nthreads개의 스레드로 나눠서 한다.
+ * nthreads가 0 이하이면 온라인 CPU 수만큼 쓰고, RSA_BATCH_MAXTHREADS를 넘지 않는다.
+ * 반환값은 검증에 실패한 항목 수로, 0이면 모든 서명이 올바르다.
+ */
+#define RSA_BATCH_MAXTHREADS 64
+
+typedef struct {
+    const void *msg;
+    size_t len;
+    const rsa_handle *key;
+    const void *sig;
+} rsassa_pss_batch_item;
+
+size_t rsassa_pss_verify_batch(const rsassa_pss_batch_item *items, size_t count, int *status, int sha2_ndx, int nthreads);
+
 #endif
@@ -0,0 +1,203 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ * 2018037356 컴퓨터 학부 안동현 수정
+ */
+#include "hmac.h"
+#include <string.h>
+
+/*
+ * hmac_len() - 해시함수 색인의 HMAC 길이(= 해시 길이)를 돌려준다. 잘못된 색인이면 0
+ */
+int hmac_len(int sha2_ndx)
+{
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+
+	return hash != NULL ? hash->digest_size : 0;
+}
+
+/*
+ * hmac_key_init() - 키 k로 HMAC 키 객체를 만든다.
+ * 블록 길이보다 긴 키는 해시한 값을 키로 쓰고, 짧은 키는 뒤를 0으로 채운다.
+ */
+int hmac_key_init(hmac_key *key, int sha2_ndx, const void *k, size_t klen)
+{
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char pad[SHA512_BLOCK_SIZE];
+	int i, bl;
+
+	if (hash == NULL)
+		return HMAC_INVALID_HASH;
+	key->hash = hash;
+	bl = hash->block_size;
+
+	memset(pad, 0, sizeof(pad));
+	if (klen > (size_t)bl){
+		hash->init(&key->inner);
+		hash->update(&key->inner, k, klen);
+		hash->final(&key->inner, pad);
+	}
+	else if (klen > 0)
+		memcpy(pad, k, klen);
+
+	// 안쪽 해시: K ^ ipad 한 블록
+	for (i = 0; i < bl; i++)
+		pad[i] ^= 0x36;
+	hash->init(&key->inner);
+	hash->update(&key->inner, pad, bl);
+
+	// 바깥쪽 해시: K ^ opad 한 블록 (0x36 ^ 0x5c = 0x6a)
+	for (i = 0; i < bl; i++)
+		pad[i] ^= 0x6a;
+	hash->init(&key->outer);
+	hash->update(&key->outer, pad, bl);
+
+	memset(pad, 0, sizeof(pad));
+	return 0;
+}
+
+/*
+ * hmac_key_clear() - 키 객체에 남은 키 정보를 지운다.
+ */
+void hmac_key_clear(hmac_key *key)
+{
+	volatile unsigned char *p = (volatile unsigned char *)key;
+	size_t i;
+
+	for (i = 0; i < sizeof(*key); i++)
+		p[i] = 0;
+}
+
+/*
+ * hmac_init() - 키 객체 key로 메시지 하나의 HMAC 계산을 시작한다.
+ * 안쪽 해시는 K ^ ipad를 이미 압축한 상태에서 시작하므로 블록을 압축하지 않는다.
+ */
+void hmac_init(hmac_ctx *ctx, const hmac_key *key)
+{
+	ctx->key = key;
+	ctx->hash = key->inner;
+}
+
+void hmac_update(hmac_ctx *ctx, const void *msg, size_t len)
+{
+	if (len > 0)
+		ctx->key->hash->update(&ctx->hash, msg, len);
+}
+
+/*
+ * hmac_final() - HMAC 값을 mac에 저장한다. mac에는 hmac_len() 바이트가 필요하다.
+ */
+void hmac_final(hmac_ctx *ctx, unsigned char *mac)
+{
+	const hmac_key *key = ctx->key;
+	const sha2_desc *hash = key->hash;
+	unsigned char md[SHA512_DIGEST_SIZE];
+
+	hash->final(&ctx->hash, md);
+	ctx->hash = key->outer;
+	hash->update(&ctx->hash, md, hash->digest_size);
+	hash->final(&ctx->hash, mac);
+	memset(md, 0, sizeof(md));
+}
+
+/*
+ * hmac_mac() - 키 객체 key로 msg의 HMAC을 한 번에 계산한다.
+ */
+void hmac_mac(const hmac_key *key, const void *msg, size_t len, unsigned char *mac)
+{
+	hmac_ctx ctx;
+
+	hmac_init(&ctx, key);
+	hmac_update(&ctx, msg, len);
+	hmac_final(&ctx, mac);
+}
+
+/*
+ * hmac() - 키 k로 msg의 HMAC을 계산한다. 키 객체를 매번 만들므로 같은 키를 여러 번 쓸 때는
+ * hmac_key_init()과 hmac_mac()을 사용한다.
+ */
+int hmac(int sha2_ndx, const void *k, size_t klen, const void *msg, size_t len, unsigned char *mac)
+{
+	hmac_key key;
+	int ret;
+
+	if ((ret = hmac_key_init(&key, sha2_ndx, k, klen)) != 0)
+		return ret;
+	hmac_mac(&key, msg, len, mac);
+	hmac_key_clear(&key);
+	return 0;
+}
+
+/*
+ * hkdf_extract() - PRK = HMAC(salt, IKM)
+ */
+int hkdf_extract(int sha2_ndx, const void *salt, size_t salt_len, const void *ikm, size_t ikm_len,
+		unsigned char *prk)
+{
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char zero[SHA512_DIGEST_SIZE];
+
+	if (hash == NULL)
+		return HMAC_INVALID_HASH;
+	if (salt == NULL){
+		memset(zero, 0, sizeof(zero));
+		salt = zero;
+		salt_len = hash->digest_size;
+	}
+	return hmac(sha2_ndx, salt, salt_len, ikm, ikm_len, prk);
+}
+
+/*
+ * hkdf_expand() - OKM = T(1) || T(2) || ... 의 앞 okm_len 바이트
+ * T(i) = HMAC(PRK, T(i-1) || info || i), T(0)은 빈 문자열이다.
+ * PRK 키 객체는 한 번만 만들고 블록마다 재사용한다.
+ */
+int hkdf_expand(int sha2_ndx, const void *prk, size_t prk_len, const void *info, size_t info_len,
+		unsigned char *okm, size_t okm_len)
+{
+	unsigned char t[SHA512_DIGEST_SIZE];
+	unsigned char c;
+	hmac_key key;
+	hmac_ctx ctx;
+	size_t hlen, off, n;
+	int ret;
+
+	if ((ret = hmac_key_init(&key, sha2_ndx, prk, prk_len)) != 0)
+		return ret;
+	hlen = key.hash->digest_size;
+	if (okm_len > 255 * hlen){
+		hmac_key_clear(&key);
+		return HKDF_OKM_TOO_LONG;
+	}
+	for (off = 0, c = 1; off < okm_len; off += n, c++){
+		hmac_init(&ctx, &key);
+		if (c > 1)
+			hmac_update(&ctx, t, hlen);
+		hmac_update(&ctx, info, info_len);
+		hmac_update(&ctx, &c, 1);
+		hmac_final(&ctx, t);
+		n = okm_len - off < hlen ? okm_len - off : hlen;
+		memcpy(okm + off, t, n);
+	}
+	memset(t, 0, sizeof(t));
+	hmac_key_clear(&key);
+	return 0;
+}
+
+/*
+ * hkdf() - extract와 expand를 차례로 수행한다.
+ */
+int hkdf(int sha2_ndx, const void *salt, size_t salt_len, const void *ikm, size_t ikm_len,
+		const void *info, size_t info_len, unsigned char *okm, size_t okm_len)
+{
+	unsigned char prk[SHA512_DIGEST_SIZE];
+	int ret;
+
+	if ((ret = hkdf_extract(sha2_ndx, salt, salt_len, ikm, ikm_len, prk)) != 0)
+		return ret;
+	ret = hkdf_expand(sha2_ndx, prk, hmac_len(sha2_ndx), info, info_len, okm, okm_len);
+	memset(prk, 0, sizeof(prk));
+	return ret;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#ifndef _HMAC_H_
+#define _HMAC_H_
+
+#include <stddef.h>
+#include "sha2.h"
+
+/*
+ * SHA-2 계열의 해시함수를 구분하기 위한 색인 값이다. pkcs.h, ecdsa.h와 같은 값이다.
+ */
+#ifndef SHA224
+#define SHA224      0
+#define SHA256      1
+#define SHA384      2
+#define SHA512      3
+#define SHA512_224  4
+#define SHA512_256  5
+#endif
+
+/*
+ * 오류 코드
+ */
+#define HMAC_INVALID_HASH   1       /* 잘못된 해시함수 색인 */
+#define HKDF_OKM_TOO_LONG   2       /* 출력 길이가 255 * 해시 길이보다 김 */
+
+/*
+ * HMAC (FIPS 198-1, RFC 2104)
+ * hmac_key_init()은 키를 블록 길이에 맞춘 다음 K ^ ipad와 K ^ opad를 한 블록씩 압축한 해시 상태를
+ * 키 객체에 저장해 둔다. 같은 키로 여러 메시지를 인증할 때 hmac_init()은 저장된 상태를 복사만 하므로,
+ * 메시지마다 메시지 블록과 안쪽 해시의 마지막 블록, 바깥쪽 해시의 마지막 블록만 압축한다.
+ * 키 객체는 hmac_key_init() 이후에는 읽기만 하므로 여러 스레드가 공유할 수 있다.
+ */
+typedef struct {
+    const sha2_desc *hash;          /* 해시함수 기술자 */
+    sha2_ctx inner;                 /* K ^ ipad를 압축한 상태 */
+    sha2_ctx outer;                 /* K ^ opad를 압축한 상태 */
+} hmac_key;
+
+typedef struct {
+    const hmac_key *key;
+    sha2_ctx hash;                  /* 진행 중인 안쪽 해시 */
+} hmac_ctx;
+
+int hmac_key_init(hmac_key *key, int sha2_ndx, const void *k, size_t klen);
+void hmac_key_clear(hmac_key *key);
+void hmac_init(hmac_ctx *ctx, const hmac_key *key);
+void hmac_update(hmac_ctx *ctx, const void *msg, size_t len);
+void hmac_final(hmac_ctx *ctx, unsigned char *mac);
+void hmac_mac(const hmac_key *key, const void *msg, size_t len, unsigned char *mac);
+int hmac(int sha2_ndx, const void *k, size_t klen, const void *msg, size_t len, unsigned char *mac);
+int hmac_len(int sha2_ndx);
+
+/*
+ * HKDF (RFC 5869)
+ * hkdf_extract()는 salt로 ikm에서 해시 길이의 의사난수 키 prk를 뽑는다. salt가 NULL이면 0으로 채운
+ * 해시 길이의 salt를 사용한다. hkdf_expand()는 prk와 info로 okm_len 바이트를 만든다.
+ * okm_len은 255 * 해시 길이 이하여야 한다. hkdf()는 두 단계를 차례로 수행한다.
+ */
+int hkdf_extract(int sha2_ndx, const void *salt, size_t salt_len, const void *ikm, size_t ikm_len,
+                 unsigned char *prk);
+int hkdf_expand(int sha2_ndx, const void *prk, size_t prk_len, const void *info, size_t info_len,
+                unsigned char *okm, size_t okm_len);
+int hkdf(int sha2_ndx, const void *salt, size_t salt_len, const void *ikm, size_t ikm_len,
+         const void *info, size_t info_len, unsigned char *okm, size_t okm_len);
+
+#endif
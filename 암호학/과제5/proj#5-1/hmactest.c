@@ -0,0 +1,261 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "hmac.h"
+
+/*
+ * RFC 4231의 HMAC 시험 벡터 7개 (SHA-512/224, SHA-512/256 값은 같은 키와 메시지로 계산한 것)
+ * 시험 5는 RFC에서 앞 128비트만 비교하지만 여기서는 전체 값을 비교한다.
+ */
+static const char *hmac_key_hex[7] = {
+    "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b",
+    "4a656665",
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    "0102030405060708090a0b0c0d0e0f10111213141516171819",
+    "0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c",
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaa",
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"
+    "aaaaaa",
+};
+
+static const char *hmac_msg_hex[7] = {
+    "4869205468657265",
+    "7768617420646f2079612077616e7420666f72206e6f7468696e673f",
+    "dddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddddd"
+    "dddddddddddddddddddddddddddddddddddd",
+    "cdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcd"
+    "cdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcdcd",
+    "546573742057697468205472756e636174696f6e",
+    "54657374205573696e67204c6172676572205468616e20426c6f636b2d53697a"
+    "65204b6579202d2048617368204b6579204669727374",
+    "5468697320697320612074657374207573696e672061206c6172676572207468"
+    "616e20626c6f636b2d73697a65206b657920616e642061206c61726765722074"
+    "68616e20626c6f636b2d73697a6520646174612e20546865206b6579206e6565"
+    "647320746f20626520686173686564206265666f7265206265696e6720757365"
+    "642062792074686520484d414320616c676f726974686d2e",
+};
+
+static const char *hmac_mac_hex[7][6] = {
+    {
+        "896fb1128abbdf196832107cd49df33f47b4b1169912ba4f53684b22",
+        "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+        "afd03944d84895626b0825f4ab46907f15f9dadbe4101ec682aa034c7cebc59c"
+        "faea9ea9076ede7f4af152e8b2fa9cb6",
+        "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cde"
+        "daa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854",
+        "b244ba01307c0e7a8ccaad13b1067a4cf6b961fe0c6a20bda3d92039",
+        "9f9126c3d9c3c330d760425ca8a217e31feae31bfe70196ff81642b868402eab",
+    },
+    {
+        "a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44",
+        "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+        "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e"
+        "8e2240ca5e69e2c78b3239ecfab21649",
+        "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+        "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737",
+        "4a530b31a79ebcce36916546317c45f247d83241dfb818fd37254bde",
+        "6df7b24630d5ccb2ee335407081a87188c221489768fa2020513b2d593359456",
+    },
+    {
+        "7fb3cb3588c6c1f6ffa9694d7d6ad2649365b0c1f65d69d1ec8333ea",
+        "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+        "88062608d3e6ad8a0aa2ace014c8a86f0aa635d947ac9febe83ef4e55966144b"
+        "2a5ab39dc13814b94e3ab6e101a34f27",
+        "fa73b0089d56a284efb0f0756c890be9b1b5dbdd8ee81a3655f83e33b2279d39"
+        "bf3e848279a722c806b485a47e67c807b946a337bee8942674278859e13292fb",
+        "db34ea525c2c216ee5a6ccb6608bea870bbef12fd9b96a5109e2b6fc",
+        "229006391d66c8ecddf43ba5cf8f83530ef221a4e9401840d1bead5137c8a2ea",
+    },
+    {
+        "6c11506874013cac6a2abc1bb382627cec6a90d86efc012de7afec5a",
+        "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+        "3e8a69b7783c25851933ab6290af6ca77a9981480850009cc5577c6e1f573b4e"
+        "6801dd23c4a7d679ccf8a386c674cffb",
+        "b0ba465637458c6990e5a8c5f61d4af7e576d97ff94b872de76f8050361ee3db"
+        "a91ca5c11aa25eb4d679275cc5788063a5f19741120c4f2de2adebeb10a298dd",
+        "c2391863cda465c6828af06ac5d4b72d0b792109952da530e11a0d26",
+        "36d60c8aa1d0be856e10804cf836e821e8733cbafeae87630589fd0b9b0a2f4c",
+    },
+    {
+        "0e2aea68a90c8d37c988bcdb9fca6fa8099cd857c7ec4a1815cac54c",
+        "a3b6167473100ee06e0c796c2955552bfa6f7c0a6a8aef8b93f860aab0cd20c5",
+        "3abf34c3503b2a23a46efc619baef897f4c8e42c934ce55ccbae9740fcbc1af4"
+        "ca62269e2a37cd88ba926341efe4aeea",
+        "415fad6271580a531d4179bc891d87a650188707922a4fbb36663a1eb16da008"
+        "711c5b50ddd0fc235084eb9d3364a1454fb2ef67cd1d29fe6773068ea266e96b",
+        "1df8eae8baeedd4eddfb555ec0ba768f4b5ba29e9e3d55f08303120f",
+        "337f526924766971bf72b82ad19c2c825301791e3ae2d8bb4ec03817dd821f46",
+    },
+    {
+        "95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e",
+        "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+        "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c6"
+        "0c2ef6ab4030fe8296248df163f44952",
+        "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+        "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598",
+        "29bef8ce88b54d4226c3c7718ea9e32ace2429026f089e38cea9aeda",
+        "87123c45f7c537a404f8f47cdbedda1fc9bec60eeb971982ce7ef10e774e6539",
+    },
+    {
+        "3a854166ac5d9f023f54d517d0b39dbd946770db9c2b95c9f6f565d1",
+        "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2",
+        "6617178e941f020d351e2f254e8fd32c602420feb0b8fb9adccebb82461e99c5"
+        "a678cc31e799176d3860e6110c46523e",
+        "e37b6a775dc87dbaa4dfa9f96e5e3ffddebd71f8867289865df5a32d20cdc944"
+        "b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58",
+        "82a9619b47af0cea73a8b9741355ce902d807ad87ee9078522a246e1",
+        "6ea83f8e7315072c0bdaa33b93a26fc1659974637a9db8a887d06c05a7f35a66",
+    },
+};
+/*
+ * RFC 5869 부록 A의 HKDF-SHA-256 시험 벡터 (시험 1 ~ 3)
+ */
+typedef struct {
+    const char *salt, *ikm, *info, *prk, *okm;
+} hkdf_vector;
+
+static const hkdf_vector hkdf_vec[3] = {
+    {
+        "000102030405060708090a0b0c",
+        "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b",
+        "f0f1f2f3f4f5f6f7f8f9",
+        "077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5",
+        "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf"
+        "34007208d5b887185865",
+    },
+    {
+        "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+        "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+        "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf",
+        "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+        "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+        "404142434445464748494a4b4c4d4e4f",
+        "b0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+        "d0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+        "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+        "06a6b88c5853361a06104c9ceb35b45cef760014904671014a193f40c15fc244",
+        "b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c"
+        "59045a99cac7827271cb41c65e590e09da3275600c2f09b8367793a9aca3db71"
+        "cc30c58179ec3e87c14c01d5c1f3434f1d87",
+    },
+    {
+        "",
+        "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b",
+        "",
+        "19ef24a32c717b167f33a91d6f648bdf96596776afdb6377ac434c1c293ccb04",
+        "8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d"
+        "9d201395faa4b61a96c8",
+    },
+};
+
+static const char *hash_name[6] = {"SHA-224", "SHA-256", "SHA-384", "SHA-512", "SHA-512/224", "SHA-512/256"};
+
+/*
+ * unhex() - 16진수 문자열을 바이트 배열로 바꾸고 길이를 돌려준다.
+ */
+static size_t unhex(const char *hex, unsigned char *out)
+{
+    size_t i, n = strlen(hex) / 2;
+    unsigned int b;
+
+    for (i = 0; i < n; ++i) {
+        sscanf(hex + 2*i, "%2x", &b);
+        out[i] = (unsigned char)b;
+    }
+    return n;
+}
+
+int main(void)
+{
+    unsigned char key[256], msg[256], mac[SHA512_DIGEST_SIZE], ref[SHA512_DIGEST_SIZE];
+    unsigned char salt[128], ikm[128], info[128], prk[SHA512_DIGEST_SIZE], okm[256], out[256];
+    size_t klen, mlen, slen, ilen, nlen, okm_len, j;
+    hmac_key hk;
+    hmac_ctx hc;
+    int i, k;
+
+    /*
+     * HMAC 시험: 한 번에 계산한 값, 키 객체를 재사용한 값, 1바이트씩 나눠 넣은 값이 모두 같아야 한다.
+     */
+    printf("HMAC 시험");
+    for (i = 0; i < 7; ++i) {
+        klen = unhex(hmac_key_hex[i], key);
+        mlen = unhex(hmac_msg_hex[i], msg);
+        for (k = SHA224; k <= SHA512_256; ++k) {
+            unhex(hmac_mac_hex[i][k], ref);
+            if (hmac(k, key, klen, msg, mlen, mac) != 0 || memcmp(mac, ref, hmac_len(k))) {
+                printf(".....FAILED: 시험 %d %s 불일치\n", i + 1, hash_name[k]);
+                return 1;
+            }
+            hmac_key_init(&hk, k, key, klen);
+            hmac_mac(&hk, msg, mlen, mac);
+            hmac_mac(&hk, msg, mlen, mac);
+            if (memcmp(mac, ref, hmac_len(k))) {
+                printf(".....FAILED: 시험 %d %s 키 재사용 불일치\n", i + 1, hash_name[k]);
+                return 1;
+            }
+            hmac_init(&hc, &hk);
+            for (j = 0; j < mlen; ++j)
+                hmac_update(&hc, msg + j, 1);
+            hmac_final(&hc, mac);
+            if (memcmp(mac, ref, hmac_len(k))) {
+                printf(".....FAILED: 시험 %d %s 나눠 넣기 불일치\n", i + 1, hash_name[k]);
+                return 1;
+            }
+            hmac_key_clear(&hk);
+        }
+    }
+    if (hmac(6, key, klen, msg, mlen, mac) != HMAC_INVALID_HASH || hmac_len(-1) != 0) {
+        printf(".....FAILED: 잘못된 해시함수 색인\n");
+        return 1;
+    }
+    printf(".....PASSED\n");
+
+    /*
+     * HKDF 시험
+     */
+    printf("HKDF 시험");
+    for (i = 0; i < 3; ++i) {
+        slen = unhex(hkdf_vec[i].salt, salt);
+        ilen = unhex(hkdf_vec[i].ikm, ikm);
+        nlen = unhex(hkdf_vec[i].info, info);
+        unhex(hkdf_vec[i].prk, ref);
+        okm_len = unhex(hkdf_vec[i].okm, okm);
+        // 시험 3은 salt가 비어 있으므로 NULL(해시 길이의 0)로도 같은 값이 나와야 한다.
+        if (hkdf_extract(SHA256, slen ? salt : NULL, slen, ikm, ilen, prk) != 0 ||
+            memcmp(prk, ref, SHA256_DIGEST_SIZE)) {
+            printf(".....FAILED: 시험 %d PRK 불일치\n", i + 1);
+            return 1;
+        }
+        if (hkdf_expand(SHA256, prk, SHA256_DIGEST_SIZE, info, nlen, out, okm_len) != 0 ||
+            memcmp(out, okm, okm_len)) {
+            printf(".....FAILED: 시험 %d OKM 불일치\n", i + 1);
+            return 1;
+        }
+        memset(out, 0, sizeof(out));
+        if (hkdf(SHA256, salt, slen, ikm, ilen, info, nlen, out, okm_len) != 0 || memcmp(out, okm, okm_len)) {
+            printf(".....FAILED: 시험 %d hkdf() 불일치\n", i + 1);
+            return 1;
+        }
+    }
+    if (hkdf_expand(SHA256, prk, SHA256_DIGEST_SIZE, NULL, 0, out, 255 * SHA256_DIGEST_SIZE + 1) !=
+        HKDF_OKM_TOO_LONG) {
+        printf(".....FAILED: 너무 긴 출력\n");
+        return 1;
+    }
+    printf(".....PASSED\n");
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pkcs.h"
+
+/*
+ * 키 길이마다 키 생성은 KEYGEN_ROUNDS번, 나머지 연산은 OP_ROUNDS번 반복해서 평균을 낸다.
+ * 키 생성은 소수를 찾을 때까지 걸리는 시간이 들쭉날쭉하므로 평균도 크게 흔들린다.
+ * 키 길이마다 키 객체 함수(key)와 키 핸들 함수(handle)를 같은 키로 측정한다.
+ * handle 줄의 첫 열은 키 생성 대신 rsa_handle_init_crt()와 rsa_handle_init_pub()에 걸린 시간이다.
+ * 핸들의 복호화와 서명은 CPU가 둘 이상일 때만 CRT의 두 거듭제곱을 나눠서 하므로 CPU 수도 함께 찍는다.
+ * 두 스레드의 시간이 겹치므로 CPU 시간이 아니라 경과 시간을 잰다.
+ */
+#define KEYGEN_ROUNDS 4
+#define OP_ROUNDS 200
+
+static const int key_bits[] = {2048, 3072, 4096};
+
+/*
+ * 일괄 검증은 BATCH_ITEMS개의 2048비트 서명을 하나씩 검증할 때와 스레드 수를 1, 2, 4, ...로
+ * 늘려 가며 rsassa_pss_verify_batch()로 검증할 때의 처리량(검증/초)을 비교한다.
+ */
+#define BATCH_ITEMS 4000
+
+static rsassa_pss_batch_item items[BATCH_ITEMS];
+static unsigned char sigs[BATCH_ITEMS][RSA_MAXKEYSIZE/8];
+static unsigned char msgs[BATCH_ITEMS][64];
+static int status[BATCH_ITEMS];
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    static rsa_crt_key key;
+    static rsa_handle hpub, hcrt;
+    static unsigned char m[RSA_MAXKEYSIZE/8], c[RSA_MAXKEYSIZE/8], s[RSA_MAXKEYSIZE/8];
+    static const char msg[] = "It always seems impossible until it is done.";
+    double t, t_gen, t_init, t_enc, t_dec, t_sign, t_ver;
+    size_t len;
+    int b, i, val;
+
+    printf("%6s %-6s %12s %12s %12s %12s %12s   (ms/op, %ld CPUs)\n", "bits", "api", "keygen/init", "encrypt", "decrypt", "sign",
+           "verify", sysconf(_SC_NPROCESSORS_ONLN));
+    for (b = 0; b < (int)(sizeof(key_bits) / sizeof(key_bits[0])); ++b) {
+        t = seconds();
+        for (i = 0; i < KEYGEN_ROUNDS; ++i)
+            rsa_generate_crt_key(&key, key_bits[b], 0);
+        t_gen = (seconds() - t) / KEYGEN_ROUNDS;
+        /*
+         * 마지막으로 만든 키로 OAEP 암복호화와 PSS 서명, 검증을 측정한다.
+         * 복호화와 서명은 CRT 개인키를 쓴다.
+         */
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            rsaes_oaep_encrypt_pub(msg, sizeof(msg), "", &key.pub, c, SHA256);
+        t_enc = (seconds() - t) / OP_ROUNDS;
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            val = rsaes_oaep_decrypt_crt(m, &len, "", &key, c, SHA256);
+        t_dec = (seconds() - t) / OP_ROUNDS;
+        if (val != 0 || len != sizeof(msg) || memcmp(m, msg, len) != 0) {
+            printf("%d-bit 복호화 오류: %d .....FAILED\n", key_bits[b], val);
+            return 1;
+        }
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            rsassa_pss_sign_crt(msg, sizeof(msg), &key, s, SHA256);
+        t_sign = (seconds() - t) / OP_ROUNDS;
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            val = rsassa_pss_verify_pub(msg, sizeof(msg), &key.pub, s, SHA256);
+        t_ver = (seconds() - t) / OP_ROUNDS;
+        if (val != 0) {
+            printf("%d-bit 검증 오류: %d .....FAILED\n", key_bits[b], val);
+            return 1;
+        }
+        printf("%6d %-6s %12.2f %12.3f %12.3f %12.3f %12.3f\n", key_bits[b], "key", t_gen * 1e3, t_enc * 1e3, t_dec * 1e3,
+               t_sign * 1e3, t_ver * 1e3);
+        /*
+         * 같은 키를 핸들로 읽어서 같은 연산을 측정한다.
+         */
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i) {
+            rsa_handle_init_crt(&hcrt, &key);
+            rsa_handle_init_pub(&hpub, &key.pub);
+        }
+        t_init = (seconds() - t) / OP_ROUNDS;
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            rsaes_oaep_encrypt_handle(msg, sizeof(msg), "", &hpub, c, SHA256);
+        t_enc = (seconds() - t) / OP_ROUNDS;
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            val = rsaes_oaep_decrypt_handle(m, &len, "", &hcrt, c, SHA256);
+        t_dec = (seconds() - t) / OP_ROUNDS;
+        if (val != 0 || len != sizeof(msg) || memcmp(m, msg, len) != 0) {
+            printf("%d-bit 핸들 복호화 오류: %d .....FAILED\n", key_bits[b], val);
+            return 1;
+        }
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            rsassa_pss_sign_handle(msg, sizeof(msg), &hcrt, s, SHA256);
+        t_sign = (seconds() - t) / OP_ROUNDS;
+        t = seconds();
+        for (i = 0; i < OP_ROUNDS; ++i)
+            val = rsassa_pss_verify_handle(msg, sizeof(msg), &hpub, s, SHA256);
+        t_ver = (seconds() - t) / OP_ROUNDS;
+        if (val != 0) {
+            printf("%d-bit 핸들 검증 오류: %d .....FAILED\n", key_bits[b], val);
+            return 1;
+        }
+        printf("%6d %-6s %12.2f %12.3f %12.3f %12.3f %12.3f\n", key_bits[b], "handle", t_init * 1e3, t_enc * 1e3, t_dec * 1e3,
+               t_sign * 1e3, t_ver * 1e3);
+    }
+    /*
+     * 2048비트 키 하나로 서명한 BATCH_ITEMS개의 매니페스트 항목을 검증한다.
+     */
+    rsa_generate_crt_key(&key, 2048, 0);
+    rsa_handle_init_crt(&hcrt, &key);
+    rsa_handle_init_pub(&hpub, &key.pub);
+    for (i = 0; i < BATCH_ITEMS; ++i) {
+        len = snprintf((char *)msgs[i], sizeof(msgs[i]), "pkg-%05d sha256=%032x", i, i * 2654435761u);
+        items[i].msg = msgs[i];
+        items[i].len = len;
+        items[i].key = &hpub;
+        items[i].sig = sigs[i];
+        rsassa_pss_sign_handle(msgs[i], len, &hcrt, sigs[i], SHA256);
+    }
+    t = seconds();
+    for (i = 0; i < BATCH_ITEMS; ++i)
+        if ((val = rsassa_pss_verify_pub(msgs[i], items[i].len, &key.pub, sigs[i], SHA256)) != 0) {
+            printf("검증 오류: %d .....FAILED\n", val);
+            return 1;
+        }
+    t = seconds() - t;
+    printf("\n%d signatures, 2048-bit, %ld CPUs\n", BATCH_ITEMS, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-16s %10.0f verify/s\n", "serial _pub", BATCH_ITEMS / t);
+    for (b = 1; b <= 2 * sysconf(_SC_NPROCESSORS_ONLN) && b <= RSA_BATCH_MAXTHREADS; b *= 2) {
+        t = seconds();
+        val = rsassa_pss_verify_batch(items, BATCH_ITEMS, status, SHA256, b);
+        t = seconds() - t;
+        if (val != 0) {
+            printf("일괄 검증 오류: %d개 .....FAILED\n", val);
+            return 1;
+        }
+        printf("batch %2d thread%s %10.0f verify/s\n", b, b > 1 ? "s" : " ", BATCH_ITEMS / t);
+    }
+    return 0;
+}
@@ -0,0 +1,806 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdint.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "sha2.h"
+#include "sha2tree.h"
+
+/*
+ * SHA-2 시험 벡터와 성능 측정
+ * 결과는 모두 JSON으로 표준 출력에 쓰므로 버전마다 저장해 두고 비교할 수 있다.
+ * SHA-2의 성능 측정은 이 프로그램 하나에서만 한다. 엔진과 길이별 바이트당 사이클(bench)과
+ * MGF1 크기의 짧은 메시지를 다중 버퍼로 해시할 때의 메시지당 사이클(mb_bench)을 기록한다.
+ * 인자로 -k를 주면 시험 벡터만 확인하고 성능 측정은 건너뛴다.
+ * -c 디렉터리를 주면 그 디렉터리의 NIST CAVP 응답 파일(SHA256ShortMsg.rsp, SHA256LongMsg.rsp,
+ * SHA256Monte.rsp 등)을 읽어 들어 있는 벡터를 모두 확인한다. 없는 파일은 건너뛴다.
+ * sha256_tree(), sha512_tree()의 트리 해시도 여러 스레드 수로 확인한다.
+ * 시험 벡터가 하나라도 틀리거나 -c 디렉터리에 응답 파일이 하나도 없으면 종료 코드 1을 돌려준다.
+ */
+
+/*
+ * 시험 벡터의 종류
+ * 0~3은 FIPS 180-4 예제 메시지(빈 메시지, "abc", 448비트, 896비트),
+ * 4는 'a' 백만 개로 된 긴 메시지이다.
+ * 5는 CAVP ShortMsg처럼 0바이트부터 블록 두 개 + 1바이트까지 길이를 하나씩 늘린 메시지들을
+ * 해시하고, 그 해시값들을 이어 붙인 것을 다시 해시한 값이다.
+ * 6은 CAVP Monte Carlo 시험으로, seed는 0x00, 0x01, ... 로 채운 해시 크기의 바이트열이고
+ * 100번째 checkpoint 값을 비교한다.
+ * 기대값은 별도의 구현(Python hashlib)으로 계산한 것이다. CAVP 파일은 저장소에 넣지 않았으므로
+ * NIST에서 받은 shabytetestvectors를 -c로 넘겨 따로 확인한다.
+ */
+#define KAT_NCASE   7
+#define KAT_SWEEP   5
+#define KAT_MONTE   6
+
+static const char *kat_name[KAT_NCASE] = {
+    "empty", "abc", "448-bit", "896-bit", "million-a", "short-sweep", "monte-carlo"
+};
+
+static const char *kat_md_hex[KAT_NCASE][SHA2_NDESC] = {
+    {
+        "d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f",
+        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855",
+        "38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da"
+        "274edebfe76f65fbd51ad2f14898b95b",
+        "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
+        "47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e",
+        "6ed0dd02806fa89e25de060c19d3ac86cabb87d6a0ddd05c333b84f4",
+        "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a",
+    },
+    {
+        "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7",
+        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad",
+        "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed"
+        "8086072ba1e7cc2358baeca134c825a7",
+        "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+        "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+        "4634270f707b6a54daae7530460842e20e37ed265ceee9a43e8924aa",
+        "53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23",
+    },
+    {
+        "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525",
+        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1",
+        "3391fdddfc8dc7393707a65b1b4709397cf8b1d162af05abfe8f450de5f36bc6"
+        "b0455a8520bc4e6f5fe95b1fe3c8452b",
+        "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+        "96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445",
+        "e5302d6d54bb242275d1e7622d68df6eb02dedd13f564c13dbda2174",
+        "bde8e1f9f19bb9fd3406c90ec6bc47bd36d8ada9f11880dbc8a22a7078b6a461",
+    },
+    {
+        "c97ca9a559850ce97a04a96def6d99a9e0e0e2ab14e6b8df265fc0b3",
+        "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1",
+        "09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712"
+        "fcc7c71a557e2db966c3e9fa91746039",
+        "8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018"
+        "501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909",
+        "23fec5bb94d60b23308192640b0c453335d664734fe40e7268674af9",
+        "3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a",
+    },
+    {
+        "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67",
+        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0",
+        "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b"
+        "07b8b3dc38ecc4ebae97ddd87f3d8985",
+        "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+        "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b",
+        "37ab331d76f0d36de422bd0edeb22a28accd487b7a8453ae965dd287",
+        "9a59a052930187a97038cae692f30708aa6491923ef5194394dc68d56c74fb21",
+    },
+    {
+        "98883001e0657ea1f7a38c5bd0ff9b4e0e0765c3975728b6992adb36",
+        "5f50189d1ce9c60f14573b256924cd6ce47b1dae2449be0424555dfb65171ecc",
+        "3f8cef22e7ab7e86f09066ca699b2a942249e20fc491f9f0509e2ae572861ca2"
+        "a3f748d156670a38e159126164d323f6",
+        "f1ed7fb216f7d9712e83539fd0415e683365cec14e8428d24297621876429a18"
+        "9a4af8b5385168326adf6710f0609462412f2b4d75163b87255b508da71c5284",
+        "8777fbddef60db3c09883460408368850fed679e14b4a3f0dd827ca9",
+        "d68367b52f71d08e339af8de876a11b385391687ede6429354715873d0cf29fb",
+    },
+    {
+        "ea26b2485efce7af3176205def46988ac5cc97bbcf8d38189f2d7225",
+        "7130007fcfcce9c242775219b64b0a7debe03c553bf165e0d7820187158cf17d",
+        "98fa01f3fbf3d3f13578fa7ca0d4fd47fc58b144c5497b532728a1002d03a393"
+        "55d09c12f14e608f7434827d6650f129",
+        "8f9dc356d661494f98b353226b6232c525382cfe6d249a92e9d256996afeb970"
+        "c9b682eeb6b99c59d146aa080181cb765f33169f9c6defdbde416d666e44e77b",
+        "bff5f8bf6e8cf40c739e0f0b356b43e32ac1ea7581ed22ad0853262a",
+        "9ca5984976d34b04aaf85886fbf41a9b33bdb9deadc6813db8437b5ee20a65c8",
+    },
+};
+
+/*
+ * 길이 경계 시험
+ * 문맥의 tot_len, tot_len_hi를 2^32, 2^61, 2^65바이트 바로 아래로 맞춰 놓고 sweep 메시지의
+ * 앞 len바이트를 해시한다. 앞부분은 실제로 압축하지 않았으므로 표준 해시값과는 다르고, 기대값은
+ * 같은 길이를 패딩에 넣는 별도의 구현(Python)으로 계산한 것이다.
+ * 2^32는 예전 32비트 tot_len이 넘치던 경계, 2^61은 비트 수가 64비트를 넘는 SHA-384/512의 경계이고,
+ * 마지막 둘은 final에서 tot_len + len이 2^64를 넘어 이미 비트 3이 켜진 상위 워드로 올림이 생기는 경우이다.
+ */
+#define LEN_MSGLEN 200
+
+typedef struct {
+    const char *name;
+    int k;
+    uint64 tot_len, tot_len_hi;
+    size_t len;
+    const char *md;
+} len_case_t;
+
+static const len_case_t len_case[] = {
+    {"length-2^32", 1, 0xffffffc0ULL, 0, LEN_MSGLEN,
+     "64dd9081097e19610d28f37f2b36a574d7e68bd6dd5e367158f671ca43853a52"},
+    {"length-2^32", 3, 0xffffff80ULL, 0, LEN_MSGLEN,
+     "650cd6161daf091c4e6a55e9e007e0da3b9aaf06bed058f8e9dee8113e303f06"
+     "6a4151545e8c3ecea6cba6f2c39f62527d1df35a0c786594cbf00f488b94379b"},
+    {"length-2^61", 2, 0x1fffffffffffff80ULL, 0, LEN_MSGLEN,
+     "ea64a93b2cb930ced80a2f7918ee31dfc7a79e8cee365e9537643cfd09130ac2"
+     "213cc69cde6ad8d10ffd26c62d6bde2a"},
+    {"length-2^61", 3, 0x1fffffffffffff80ULL, 0, LEN_MSGLEN,
+     "e00e13c1e728267b784014c3b100c2e0a240348b754fc5f8ec1a5046fdab7e31"
+     "3c353c531ecf800bd89bf8260ed0f23973c0d8de29834aae4b659136cca0736c"},
+    {"length-2^65", 2, 0xffffffffffffffc0ULL, 1, 100,
+     "cc02da952749d4cbaac3ac60be673f671a033a97ea8d7bf5718a252d64a4978e"
+     "72b463f2f305a661de1c71e306d7bacc"},
+    {"length-2^65", 3, 0xffffffffffffffc0ULL, 1, 100,
+     "c813d423593842b52f281244923da186fa9b43d6a17e0fc1881b8351bba1c9dc"
+     "e2cdb9de64e7a71755ecc17c93638094d8e62cca9af2808a169900bbbdb63ea1"},
+};
+
+#define NLENCASE (int)(sizeof(len_case) / sizeof(len_case[0]))
+
+/*
+ * 트리 해시 시험
+ * 빈 입력, 짧은 잎 하나, 잎 3개(마지막 잎이 짧음), 5개(마지막 잎이 1바이트), 6개인 입력의
+ * sha256_tree(), sha512_tree() 값이다. 잎 3, 5, 6개는 한 층의 노드 수가 홀수여서 마지막 노드를
+ * 그대로 올리는 경우를 거친다. i번째 바이트는 i*131 + 7 + (i / SHA2_TREE_LEAFLEN)*29의 하위 8비트이다.
+ * 기대값은 RFC 6962의 MTH 정의(가장 큰 2의 거듭제곱에서 나누는 재귀)를 그대로 옮긴 별도의 구현(Python)으로
+ * 계산한 것이다. 빈 입력은 빈 잎 하나로 된 목록의 MTH이다. 스레드 수 1, 3, 0(CPU 수)에서 모두 같아야 한다.
+ */
+#define TREE_MAXLEN (6 * SHA2_TREE_LEAFLEN)
+
+typedef struct {
+    size_t len;
+    const char *md256, *md512;
+} tree_case_t;
+
+static const tree_case_t tree_case[] = {
+    {0,
+     "6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d",
+     "b8244d028981d693af7b456af8efa4cad63d282e19ff14942c246e50d9351d22"
+     "704a802a71c3580b6370de4ceb293c324a8423342557d4e5c38438f0e36910ee"},
+    {100,
+     "1f9b04e15f643932b3c82efbb27739a0290922991595872de340cf947875bfa8",
+     "2347e198cabcb779ef2e8c36f62a62cab7f7fba1724e1995f9a32934ab0480ba"
+     "60484658b68c36a5877f8db26bce5f0d4b71266aacdb2909107f10d4aa17b61b"},
+    {2 * SHA2_TREE_LEAFLEN + 1000,
+     "7695f0d120adf7e591546e5361e7d83e710ecee1d0db3d79009a8ab0480803c6",
+     "bd87fe413dcabfaebe02c0eebe015467a7d2485a0a8e20f3f660dc5fc2694b6b"
+     "01e6b16dea8545b63503becf6caa1202b3663d1076c2a33493060c4b6d112644"},
+    {4 * SHA2_TREE_LEAFLEN + 1,
+     "6131e2f73c02f7e014218c5bbe70b75db7d5d6f4123229426c19937a80cbc9b3",
+     "70fa56f50ed1133d7b6d9b6f87b23458085f7149bb93db25c0fbf6e94da6c669"
+     "85a301d7b35f11cbe3ad8dabf248ab73f6d577c131e055a0d4c45de696bfbc21"},
+    {6 * SHA2_TREE_LEAFLEN,
+     "3eb7e4eb333e5bfa94c37cdef96e2ac310e15f10262fb96833674bb801587108",
+     "2ffae8402fdf4cf453c73cb606836c4c62ca610dce04eea05b5b34b34edb2fbc"
+     "66d3bad5cbaf29c4544fa66ca95b568bd7852c9c96f1032f1e1b5a7b6752d141"},
+};
+
+#define NTREECASE (int)(sizeof(tree_case) / sizeof(tree_case[0]))
+
+static const int tree_threads[] = {1, 3, 0};
+
+/*
+ * CAVP 응답 파일 이름은 해시 이름(색인 순서)과 종류를 이어 붙인 것이다.
+ */
+#define CAVP_NKIND 3
+#define CAVP_MONTE 2
+
+static const char *cavp_name[SHA2_NDESC] = {
+    "SHA224", "SHA256", "SHA384", "SHA512", "SHA512_224", "SHA512_256"
+};
+
+static const char *cavp_kind[CAVP_NKIND] = {"ShortMsg", "LongMsg", "Monte"};
+
+static const char *kat_msg[4] = {
+    "",
+    "abc",
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+};
+
+#define MILLION 1000000
+
+/*
+ * 성능 측정: 메시지 길이마다 약 BENCH_TOTAL 바이트를 해시해서 평균을 낸다.
+ */
+#define BENCH_TOTAL (16*1024*1024)
+#define BENCH_MAXLEN (1024*1024)
+
+static const size_t bench_len[] = {16, 64, 256, 1024, 8192, 65536, BENCH_MAXLEN};
+
+/*
+ * 다중 버퍼 측정: MGF1처럼 seed||counter 형태의 짧은 메시지를 MB_COUNT개씩 MB_ROUNDS번 해시한다.
+ * 36, 68바이트는 SHA-256, SHA-512 MGF1의 seed(해시 크기) + 4바이트 counter이다.
+ */
+#define MB_COUNT 64
+#define MB_ROUNDS 4096
+
+static const size_t mb_len[] = {36, 68};
+
+/*
+ * 압축 함수 엔진 목록
+ * family 0은 SHA-224/256(색인 0, 1), family 1은 SHA-384/512 계열(색인 2~5)이다.
+ * 루프 풀기(UNROLL_LOOPS)는 sha2.c의 컴파일 옵션이므로 Makefile의 sha2test-unroll이
+ * sha2.c와 이 파일을 -DUNROLL_LOOPS로 한 번 더 빌드하고, 그 portable 엔진은 portable-unroll로 기록한다.
+ */
+#ifdef UNROLL_LOOPS
+#define PORTABLE "portable-unroll"
+#else
+#define PORTABLE "portable"
+#endif
+
+typedef struct {
+    const char *name;
+    int family;
+    int engine;
+} backend_t;
+
+static const backend_t backend[] = {
+    {PORTABLE,   0, SHA256_ENGINE_C},
+    {"sha-ni",   0, SHA256_ENGINE_SHANI},
+    {PORTABLE,   1, SHA512_ENGINE_C},
+    {"avx2",     1, SHA512_ENGINE_AVX2},
+};
+
+#define NBACKEND (int)(sizeof(backend) / sizeof(backend[0]))
+
+static const char *mb_name[] = {"mb-scalar", "mb-sse2", "mb-avx2"};
+
+/*
+ * cycles() - x86에서는 TSC를 읽는다. 다른 CPU에서는 CLOCK_MONOTONIC의 나노초를 돌려주고,
+ * 그 경우 JSON의 "counter"가 "ns"이므로 cpb, cpm은 바이트당, 메시지당 나노초로 읽는다.
+ */
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * hex_eq() - 해시값 md와 16진수 문자열 hex가 같은지 확인한다.
+ */
+static int hex_eq(const unsigned char *md, int len, const char *hex)
+{
+    char buf[2*SHA512_DIGEST_SIZE+1];
+    int i;
+
+    for (i = 0; i < len; ++i)
+        sprintf(buf + 2*i, "%02x", md[i]);
+    return strlen(hex) == (size_t)(2*len) && memcmp(buf, hex, 2*len) == 0;
+}
+
+/*
+ * set_backend() - 엔진을 선택한다. 이 CPU에서 쓸 수 없으면 0이 아닌 값을 돌려준다.
+ */
+static int set_backend(const backend_t *b)
+{
+    return b->family == 0 ? sha256_set_engine(b->engine) : sha512_set_engine(b->engine);
+}
+
+/*
+ * update_pieces() - 메시지를 1, 2, 3, ... 바이트씩 늘려 가며 나눠서 update한다.
+ * 블록 경계에 걸치는 여러 가지 조각 크기를 한 번에 시험하기 위한 것이다.
+ */
+static void update_pieces(const sha2_desc *h, const unsigned char *msg, size_t len, unsigned char *md)
+{
+    sha2_ctx ctx;
+    size_t off, step;
+
+    h->init(&ctx);
+    for (off = 0, step = 1; off < len; off += step, ++step)
+        h->update(&ctx, msg + off, len - off < step ? len - off : step);
+    h->final(&ctx, md);
+}
+
+/*
+ * sweep_msg() - 길이 len인 sweep 메시지를 만든다.
+ */
+static void sweep_msg(unsigned char *msg, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; ++i)
+        msg[i] = (unsigned char)(len*7 + i*13 + 1);
+}
+
+/*
+ * kat_sweep() - sweep 시험값을 계산한다.
+ * mode가 0이면 digest, 1이면 update_pieces, 2이면 digest_mb로 각 메시지를 해시한다.
+ */
+static void kat_sweep(const sha2_desc *h, int mode, unsigned char *md)
+{
+    static unsigned char msg[2*SHA512_BLOCK_SIZE+2][2*SHA512_BLOCK_SIZE+1];
+    static unsigned char acc[(2*SHA512_BLOCK_SIZE+2)*SHA512_DIGEST_SIZE];
+    const unsigned char *in[2*SHA512_BLOCK_SIZE+2];
+    unsigned char *out[2*SHA512_BLOCK_SIZE+2];
+    size_t lens[2*SHA512_BLOCK_SIZE+2];
+    int n = 2*h->block_size + 2, i;
+
+    for (i = 0; i < n; ++i) {
+        sweep_msg(msg[i], i);
+        in[i] = msg[i];
+        lens[i] = i;
+        out[i] = acc + i*h->digest_size;
+        if (mode == 0)
+            h->digest(in[i], lens[i], out[i]);
+        else if (mode == 1)
+            update_pieces(h, in[i], lens[i], out[i]);
+    }
+    if (mode == 2)
+        h->digest_mb(in, lens, out, n);
+    h->digest(acc, (size_t)n*h->digest_size, md);
+}
+
+/*
+ * monte_step() - CAVP Monte Carlo 시험의 checkpoint 하나를 계산한다.
+ * MD0 = MD1 = MD2 = seed로 시작해서 MDi = H(MDi-3 || MDi-2 || MDi-1)을 1000번 구하고,
+ * 마지막 값을 md에 넣는다. md가 다음 checkpoint의 seed이다. seed와 md는 같은 버퍼여도 된다.
+ */
+static void monte_step(const sha2_desc *h, const unsigned char *seed, unsigned char *md)
+{
+    unsigned char m[3*SHA512_DIGEST_SIZE];
+    int ds = h->digest_size, i;
+
+    for (i = 0; i < 3; ++i)
+        memcpy(m + i*ds, seed, ds);
+    for (i = 0; i < 1000; ++i) {
+        h->digest(m, 3*ds, md);
+        memmove(m, m + ds, 2*ds);
+        memcpy(m + 2*ds, md, ds);
+    }
+}
+
+/*
+ * kat_monte() - seed를 0x00, 0x01, ... 로 채우고 Monte Carlo 시험의 100번째 checkpoint를 계산한다.
+ */
+static void kat_monte(const sha2_desc *h, unsigned char *md)
+{
+    int i;
+
+    for (i = 0; i < h->digest_size; ++i)
+        md[i] = (unsigned char)i;
+    for (i = 0; i < 100; ++i)
+        monte_step(h, md, md);
+}
+
+/*
+ * kat_case() - 색인 k인 해시로 시험 c를 수행하고 통과하면 1을 돌려준다.
+ * 고정 메시지는 digest와 update_pieces 두 가지로 해시해서 둘 다 맞아야 통과한다.
+ */
+static int kat_case(int k, int c)
+{
+    static unsigned char million[MILLION];
+    const sha2_desc *h = sha2_get_desc(k);
+    unsigned char md[SHA512_DIGEST_SIZE], md2[SHA512_DIGEST_SIZE];
+    const unsigned char *msg;
+    size_t len;
+
+    if (c == KAT_SWEEP) {
+        kat_sweep(h, 0, md);
+        kat_sweep(h, 1, md2);
+    }
+    else if (c == KAT_MONTE) {
+        kat_monte(h, md);
+        memcpy(md2, md, h->digest_size);
+    }
+    else {
+        if (c < 4) {
+            msg = (const unsigned char *)kat_msg[c];
+            len = strlen(kat_msg[c]);
+        }
+        else {
+            memset(million, 'a', MILLION);
+            msg = million;
+            len = MILLION;
+        }
+        h->digest(msg, len, md);
+        update_pieces(h, msg, len, md2);
+    }
+    return hex_eq(md, h->digest_size, kat_md_hex[c][k]) && hex_eq(md2, h->digest_size, kat_md_hex[c][k]);
+}
+
+/*
+ * len_check() - 길이 경계 시험 t를 수행하고 통과하면 1을 돌려준다.
+ */
+static int len_check(const len_case_t *t)
+{
+    const sha2_desc *h = sha2_get_desc(t->k);
+    unsigned char msg[LEN_MSGLEN], md[SHA512_DIGEST_SIZE];
+    sha2_ctx ctx;
+
+    sweep_msg(msg, LEN_MSGLEN);
+    h->init(&ctx);
+    if (t->k < 2)
+        ctx.s256.tot_len = t->tot_len;
+    else {
+        ctx.s512.tot_len = t->tot_len;
+        ctx.s512.tot_len_hi = t->tot_len_hi;
+    }
+    h->update(&ctx, msg, t->len);
+    h->final(&ctx, md);
+    return hex_eq(md, h->digest_size, t->md);
+}
+
+/*
+ * tree_check() - 트리 해시 시험 t를 스레드 수 nthreads로 수행하고 통과하면 1을 돌려준다.
+ * big이 1이면 sha512_tree(), 0이면 sha256_tree()를 시험한다.
+ */
+static int tree_check(const unsigned char *msg, const tree_case_t *t, int big, int nthreads)
+{
+    unsigned char md[SHA512_DIGEST_SIZE];
+
+    if (big)
+        return sha512_tree(msg, t->len, nthreads, md) == 0 && hex_eq(md, SHA512_DIGEST_SIZE, t->md512);
+    return sha256_tree(msg, t->len, nthreads, md) == 0 && hex_eq(md, SHA256_DIGEST_SIZE, t->md256);
+}
+
+/*
+ * hex_bytes() - 16진수 문자열 hex를 바이트열로 바꿔 out에 넣고 바이트 수를 돌려준다.
+ */
+static size_t hex_bytes(const char *hex, unsigned char *out)
+{
+    size_t i, n = strlen(hex) / 2;
+    unsigned int b;
+
+    for (i = 0; i < n; ++i) {
+        if (sscanf(hex + 2*i, "%2x", &b) != 1)
+            b = 0;
+        out[i] = (unsigned char)b;
+    }
+    return n;
+}
+
+/*
+ * cavp_file() - CAVP 응답 파일 dir/<해시><종류>.rsp를 읽어 색인 k인 해시로 확인한다.
+ * 확인한 벡터 수를 *count에 넣고 틀린 벡터 수를 돌려준다. 파일이 없으면 -1을 돌려준다.
+ * ShortMsg, LongMsg는 "Len = 비트 수", "Msg = ...", "MD = ..."가 벡터 하나이고, 바이트 단위가
+ * 아닌 길이는 건너뛴다 (Len = 0이면 Msg는 00이다). 메시지는 digest와 update_pieces 두 가지로 해시한다.
+ * Monte는 "Seed = ..." 다음의 "MD = ..."가 차례로 checkpoint 0, 1, ... 이다.
+ */
+static int cavp_file(const char *dir, int k, int kind, int *count)
+{
+    const sha2_desc *h = sha2_get_desc(k);
+    unsigned char md[SHA512_DIGEST_SIZE], md2[SHA512_DIGEST_SIZE], expect[SHA512_DIGEST_SIZE];
+    unsigned char *msg = NULL;
+    char path[4096], *line = NULL, *val;
+    size_t cap = 0, mlen = 0, ds = h->digest_size;
+    long bits = -1;
+    int fail = 0;
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "%s/%s%s.rsp", dir, cavp_name[k], cavp_kind[kind]);
+    if ((fp = fopen(path, "r")) == NULL)
+        return -1;
+    *count = 0;
+    while (getline(&line, &cap, fp) > 0) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if ((val = strstr(line, " = ")) == NULL)
+            continue;
+        *val = '\0';
+        val += 3;
+        if (strcmp(line, "Len") == 0)
+            bits = atol(val);
+        else if (strcmp(line, "Msg") == 0 || strcmp(line, "Seed") == 0) {
+            free(msg);
+            if ((msg = malloc(strlen(val) / 2 + 1)) == NULL) {
+                ++fail;
+                break;
+            }
+            mlen = hex_bytes(val, msg);
+        }
+        else if (strcmp(line, "MD") == 0) {
+            if (kind == CAVP_MONTE) {
+                if (msg == NULL || mlen != ds) {
+                    ++fail;
+                    break;
+                }
+                monte_step(h, msg, md);
+                memcpy(md2, md, ds);
+                memcpy(msg, md, ds);
+            }
+            else {
+                if (bits < 0 || bits % 8 != 0 || msg == NULL || (size_t)bits / 8 > mlen)
+                    continue;
+                h->digest(msg, bits / 8, md);
+                update_pieces(h, msg, bits / 8, md2);
+                bits = -1;
+            }
+            ++*count;
+            if (strlen(val) != 2*ds) {
+                ++fail;
+                continue;
+            }
+            hex_bytes(val, expect);
+            fail += memcmp(md, expect, ds) != 0 || memcmp(md2, expect, ds) != 0;
+        }
+    }
+    fclose(fp);
+    free(line);
+    free(msg);
+    return fail;
+}
+
+/*
+ * bench_hash() - 해시 h로 len 바이트를 BENCH_TOTAL 바이트 남짓 되풀이해서 해시하고
+ * 바이트당 사이클(*cpb)과 MB/s(*mbps)를 구한다. 처음 한 번은 캐시를 채우려고 시간에서 뺀다.
+ */
+static void bench_hash(const sha2_desc *h, const unsigned char *msg, size_t len, double *cpb, double *mbps)
+{
+    unsigned char digest[SHA512_DIGEST_SIZE];
+    size_t i, n = BENCH_TOTAL / len;
+    uint64_t c0, c1;
+    double t0, t1;
+
+    h->digest(msg, len, digest);
+    t0 = seconds();
+    c0 = cycles();
+    for (i = 0; i < n; ++i)
+        h->digest(msg, len, digest);
+    c1 = cycles();
+    t1 = seconds();
+    *cpb = (double)(c1 - c0) / ((double)len * n);
+    *mbps = (double)len * n / (t1 - t0) / 1e6;
+}
+
+/*
+ * bench_mb() - len 바이트 메시지 MB_COUNT개를 해시 h의 digest_mb로 MB_ROUNDS번 해시하고
+ * 메시지당 사이클을 돌려준다.
+ */
+static double bench_mb(const sha2_desc *h, const unsigned char *msg, size_t len)
+{
+    static unsigned char md[MB_COUNT][SHA512_DIGEST_SIZE];
+    const unsigned char *in[MB_COUNT];
+    unsigned char *out[MB_COUNT];
+    size_t lens[MB_COUNT];
+    uint64_t c0, c1;
+    int i;
+
+    for (i = 0; i < MB_COUNT; ++i) {
+        in[i] = msg + i*len;
+        lens[i] = len;
+        out[i] = md[i];
+    }
+    h->digest_mb(in, lens, out, MB_COUNT);
+    c0 = cycles();
+    for (i = 0; i < MB_ROUNDS; ++i)
+        h->digest_mb(in, lens, out, MB_COUNT);
+    c1 = cycles();
+    return (double)(c1 - c0) / ((double)MB_COUNT * MB_ROUNDS);
+}
+
+int main(int argc, char *argv[])
+{
+    static unsigned char msg[BENCH_MAXLEN];
+    unsigned char *tree_msg;
+    unsigned char md[SHA512_DIGEST_SIZE];
+    const sha2_desc *h;
+    double cpb, mbps, cpm;
+    const char *cavp_dir = NULL;
+    int b, c, k, i, e, n, pass, fail = 0, first = 1, bench = 1, nfiles = 0, cavp_fail = 0;
+    int engine256 = sha256_get_engine(), engine512 = sha512_get_engine(), engine_mb = sha2_mb_get_engine();
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-k") == 0)
+            bench = 0;
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc)
+            cavp_dir = argv[++i];
+        else {
+            fprintf(stderr, "사용법: sha2test [-k] [-c CAVP디렉터리]\n");
+            return 2;
+        }
+    }
+
+    printf("{\n");
+#if defined(__x86_64__) || defined(__i386__)
+    printf("  \"counter\": \"tsc\",\n");
+#else
+    printf("  \"counter\": \"ns\",\n");
+#endif
+    /*
+     * 이 CPU에서 쓸 수 있는 엔진 목록
+     */
+    printf("  \"backends\": {");
+    for (b = 0; b < NBACKEND; ++b) {
+        if (b == 0 || backend[b].family != backend[b-1].family) {
+            printf("%s\"%s\": [", b == 0 ? "" : "], ", backend[b].family ? "sha512" : "sha256");
+            first = 1;
+        }
+        if (set_backend(&backend[b]) == 0) {
+            printf("%s\"%s\"", first ? "" : ", ", backend[b].name);
+            first = 0;
+        }
+    }
+    printf("], \"mb\": [");
+    first = 1;
+    for (e = SHA2_MB_ENGINE_SCALAR; e <= SHA2_MB_ENGINE_AVX2; ++e) {
+        if (sha2_mb_set_engine(e) == 0) {
+            printf("%s\"%s\"", first ? "" : ", ", mb_name[e]);
+            first = 0;
+        }
+    }
+    printf("]},\n");
+    /*
+     * 시험 벡터: 엔진마다 모든 시험을 수행한다.
+     * 다중 버퍼 엔진은 digest_mb를 쓰는 sweep 시험만 수행한다.
+     */
+    printf("  \"kat\": [\n");
+    first = 1;
+    for (b = 0; b < NBACKEND; ++b) {
+        if (set_backend(&backend[b]) != 0)
+            continue;
+        for (k = 0; k < SHA2_NDESC; ++k) {
+            if ((k >= 2) != backend[b].family)
+                continue;
+            h = sha2_get_desc(k);
+            for (c = 0; c < KAT_NCASE; ++c) {
+                pass = kat_case(k, c);
+                fail += !pass;
+                printf("%s    {\"hash\": \"%s\", \"backend\": \"%s\", \"case\": \"%s\", \"pass\": %s}",
+                       first ? "" : ",\n", h->name, backend[b].name, kat_name[c], pass ? "true" : "false");
+                first = 0;
+            }
+            for (c = 0; c < NLENCASE; ++c) {
+                if (len_case[c].k != k)
+                    continue;
+                pass = len_check(&len_case[c]);
+                fail += !pass;
+                printf(",\n    {\"hash\": \"%s\", \"backend\": \"%s\", \"case\": \"%s\", \"pass\": %s}",
+                       h->name, backend[b].name, len_case[c].name, pass ? "true" : "false");
+            }
+        }
+    }
+    sha256_set_engine(engine256);
+    sha512_set_engine(engine512);
+    for (e = SHA2_MB_ENGINE_SCALAR; e <= SHA2_MB_ENGINE_AVX2; ++e) {
+        if (sha2_mb_set_engine(e) != 0)
+            continue;
+        for (k = 0; k < SHA2_NDESC; ++k) {
+            h = sha2_get_desc(k);
+            kat_sweep(h, 2, md);
+            pass = hex_eq(md, h->digest_size, kat_md_hex[KAT_SWEEP][k]);
+            fail += !pass;
+            printf(",\n    {\"hash\": \"%s\", \"backend\": \"%s\", \"case\": \"%s\", \"pass\": %s}",
+                   h->name, mb_name[e], kat_name[KAT_SWEEP], pass ? "true" : "false");
+        }
+    }
+    sha2_mb_set_engine(engine_mb);
+    pass = sha2_get_desc(-1) == NULL && sha2_get_desc(SHA2_NDESC) == NULL;
+    fail += !pass;
+    printf(",\n    {\"hash\": \"-\", \"backend\": \"-\", \"case\": \"bad-index\", \"pass\": %s}",
+           pass ? "true" : "false");
+    printf("\n  ],\n");
+    printf("  \"kat_failures\": %d", fail);
+    /*
+     * 트리 해시: 기본 엔진으로 시험마다 스레드 수를 바꿔 가며 확인한다.
+     */
+    if ((tree_msg = malloc(TREE_MAXLEN)) == NULL) {
+        fprintf(stderr, "메모리 부족\n");
+        return 1;
+    }
+    for (i = 0; i < TREE_MAXLEN; ++i)
+        tree_msg[i] = (unsigned char)(i*131 + 7 + i / SHA2_TREE_LEAFLEN * 29);
+    printf(",\n  \"tree\": [\n");
+    first = 1;
+    for (c = 0; c < NTREECASE; ++c)
+        for (k = 0; k < 2; ++k)
+            for (e = 0; e < (int)(sizeof(tree_threads) / sizeof(tree_threads[0])); ++e) {
+                pass = tree_check(tree_msg, &tree_case[c], k, tree_threads[e]);
+                fail += !pass;
+                printf("%s    {\"hash\": \"SHA-%d\", \"len\": %zu, \"threads\": %d, \"pass\": %s}",
+                       first ? "" : ",\n", k ? 512 : 256, tree_case[c].len, tree_threads[e], pass ? "true" : "false");
+                first = 0;
+            }
+    free(tree_msg);
+    printf("\n  ]");
+    /*
+     * CAVP 응답 파일: 엔진마다 있는 파일을 모두 확인한다.
+     */
+    if (cavp_dir != NULL) {
+        printf(",\n  \"cavp\": [\n");
+        first = 1;
+        for (b = 0; b < NBACKEND; ++b) {
+            if (set_backend(&backend[b]) != 0)
+                continue;
+            for (k = 0; k < SHA2_NDESC; ++k) {
+                if ((k >= 2) != backend[b].family)
+                    continue;
+                for (c = 0; c < CAVP_NKIND; ++c) {
+                    if ((e = cavp_file(cavp_dir, k, c, &n)) < 0)
+                        continue;
+                    ++nfiles;
+                    cavp_fail += e;
+                    printf("%s    {\"hash\": \"%s\", \"backend\": \"%s\", \"file\": \"%s%s.rsp\", \"vectors\": %d, \"failures\": %d}",
+                           first ? "" : ",\n", sha2_get_desc(k)->name, backend[b].name, cavp_name[k], cavp_kind[c], n, e);
+                    first = 0;
+                }
+            }
+        }
+        sha256_set_engine(engine256);
+        sha512_set_engine(engine512);
+        printf("\n  ],\n  \"cavp_files\": %d,\n  \"cavp_failures\": %d", nfiles, cavp_fail);
+        fail += cavp_fail + (nfiles == 0);
+    }
+    /*
+     * 성능 측정: 엔진과 메시지 길이마다 바이트당 사이클과 MB/s를 기록한다.
+     */
+    if (bench) {
+        for (i = 0; i < BENCH_MAXLEN; ++i)
+            msg[i] = (unsigned char)(i*131 + 7);
+        printf(",\n  \"bench\": [\n");
+        first = 1;
+        for (b = 0; b < NBACKEND; ++b) {
+            if (set_backend(&backend[b]) != 0)
+                continue;
+            for (k = 0; k < SHA2_NDESC; ++k) {
+                if ((k >= 2) != backend[b].family)
+                    continue;
+                h = sha2_get_desc(k);
+                for (i = 0; i < (int)(sizeof(bench_len) / sizeof(bench_len[0])); ++i) {
+                    bench_hash(h, msg, bench_len[i], &cpb, &mbps);
+                    printf("%s    {\"hash\": \"%s\", \"backend\": \"%s\", \"len\": %zu, \"cpb\": %.2f, \"mbps\": %.1f}",
+                           first ? "" : ",\n", h->name, backend[b].name, bench_len[i], cpb, mbps);
+                    first = 0;
+                }
+            }
+        }
+        sha256_set_engine(engine256);
+        sha512_set_engine(engine512);
+        /*
+         * 다중 버퍼 엔진마다 SHA-256, SHA-512의 MGF1 크기 메시지당 사이클을 기록한다.
+         * mb-scalar는 digest를 차례로 부르는 것이므로 기본 압축 엔진을 쓴다.
+         */
+        printf("\n  ],\n  \"mb_bench\": [\n");
+        first = 1;
+        for (e = SHA2_MB_ENGINE_SCALAR; e <= SHA2_MB_ENGINE_AVX2; ++e) {
+            if (sha2_mb_set_engine(e) != 0)
+                continue;
+            for (k = 1; k <= 3; k += 2) {
+                h = sha2_get_desc(k);
+                for (i = 0; i < (int)(sizeof(mb_len) / sizeof(mb_len[0])); ++i) {
+                    cpm = bench_mb(h, msg, mb_len[i]);
+                    printf("%s    {\"hash\": \"%s\", \"backend\": \"%s\", \"len\": %zu, \"cpm\": %.1f}",
+                           first ? "" : ",\n", h->name, mb_name[e], mb_len[i], cpm);
+                    first = 0;
+                }
+            }
+        }
+        sha2_mb_set_engine(engine_mb);
+        printf("\n  ]");
+    }
+    printf("\n}\n");
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include "sha2tree.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*
+ * node_hash() - 트리의 노드 하나를 해시한다. prefix는 잎이면 0x00, 부모면 0x01이고,
+ * 부모는 b에 오른쪽 자식을 넘긴다. sha256_update()는 버퍼에 남은 1바이트를 채운 다음부터는
+ * a를 그대로 압축하므로 잎을 복사하지 않는다.
+ */
+static void node_hash(int big, unsigned char prefix, const unsigned char *a, size_t alen,
+                      const unsigned char *b, size_t blen, unsigned char *md)
+{
+    if (big) {
+        sha512_ctx ctx;
+        sha512_init(&ctx);
+        sha512_update(&ctx, &prefix, 1);
+        if (alen > 0)
+            sha512_update(&ctx, a, alen);
+        if (blen > 0)
+            sha512_update(&ctx, b, blen);
+        sha512_final(&ctx, md);
+    }
+    else {
+        sha256_ctx ctx;
+        sha256_init(&ctx);
+        sha256_update(&ctx, &prefix, 1);
+        if (alen > 0)
+            sha256_update(&ctx, a, alen);
+        if (blen > 0)
+            sha256_update(&ctx, b, blen);
+        sha256_final(&ctx, md);
+    }
+}
+
+/*
+ * 스레드 하나가 맡는 잎 구간
+ */
+typedef struct {
+    int big;                        /* SHA-512이면 1 */
+    const unsigned char *message;
+    size_t len;                     /* 전체 입력 길이 */
+    size_t first, count;            /* 맡은 잎의 번호와 개수 */
+    unsigned char *md;              /* 잎 해시 배열 (잎 번호 순서) */
+} tree_job;
+
+static void *leaf_worker(void *arg)
+{
+    tree_job *job = (tree_job *)arg;
+    size_t mdlen = job->big ? SHA512_DIGEST_SIZE : SHA256_DIGEST_SIZE;
+    size_t i, off, n;
+
+    for (i = job->first; i < job->first + job->count; ++i) {
+        off = i * SHA2_TREE_LEAFLEN;
+        n = job->len - off < SHA2_TREE_LEAFLEN ? job->len - off : SHA2_TREE_LEAFLEN;
+        node_hash(job->big, 0x00, job->message + off, n, NULL, 0, job->md + i * mdlen);
+    }
+    return NULL;
+}
+
+/*
+ * tree_hash() - 잎을 스레드 수만큼 연속된 구간으로 나누어 해시한 다음, 호출한 스레드가 위층을 만든다.
+ * 위층의 노드 수는 잎의 절반 이하이고 노드마다 한두 블록만 해시하므로 전체 시간에서 차지하는 몫은 작다.
+ * 부모 j는 자식 2j, 2j+1을 읽은 다음에 쓰므로 같은 배열 안에서 층을 줄여 나간다.
+ * 마지막 구간은 호출한 스레드가 맡고, 스레드를 만들지 못한 구간도 호출한 스레드가 직접 처리한다.
+ *
+ * 스레드는 호출할 때마다 만들고 기다린다. 스레드 수를 잎 수 이하로 줄이므로 스레드마다 적어도
+ * 잎 하나(1MiB, SHA-256으로 수 밀리초)를 해시하고, 스레드를 만들고 기다리는 수십 마이크로초는
+ * 그 1% 안팎이다. 잎이 하나뿐인 1MiB 이하의 입력은 스레드를 만들지 않는다. 그래서 스레드 풀과
+ * 그것을 멈추는 인터페이스를 따로 두지 않는다.
+ */
+static int tree_hash(int big, const unsigned char *message, size_t len, int nthreads, unsigned char *digest)
+{
+    pthread_t tid[SHA2_TREE_MAXTHREADS];
+    tree_job job[SHA2_TREE_MAXTHREADS];
+    int started[SHA2_TREE_MAXTHREADS];
+    size_t mdlen = big ? SHA512_DIGEST_SIZE : SHA256_DIGEST_SIZE;
+    size_t nleaves, per, off = 0, count, j;
+    unsigned char *md;
+    int t;
+
+    nleaves = len == 0 ? 1 : (len - 1) / SHA2_TREE_LEAFLEN + 1;
+    if ((md = malloc(nleaves * mdlen)) == NULL)
+        return SHA2_TREE_NOMEM;
+
+    if (nthreads <= 0)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > SHA2_TREE_MAXTHREADS)
+        nthreads = SHA2_TREE_MAXTHREADS;
+    if ((size_t)nthreads > nleaves)
+        nthreads = (int)nleaves;
+    if (nthreads < 1)
+        nthreads = 1;
+
+    per = (nleaves + nthreads - 1) / nthreads;
+    for (t = 0; t < nthreads; ++t) {
+        job[t].big = big;
+        job[t].message = message;
+        job[t].len = len;
+        job[t].first = off;
+        job[t].count = nleaves - off < per ? nleaves - off : per;
+        job[t].md = md;
+        off += job[t].count;
+        started[t] = t < nthreads - 1 && pthread_create(&tid[t], NULL, leaf_worker, &job[t]) == 0;
+        if (t < nthreads - 1 && !started[t])
+            leaf_worker(&job[t]);
+    }
+    leaf_worker(&job[nthreads - 1]);
+    for (t = 0; t < nthreads - 1; ++t)
+        if (started[t])
+            pthread_join(tid[t], NULL);
+
+    /*
+     * 한 층씩 위로 올라간다. 짝이 없는 마지막 노드는 그대로 올린다.
+     */
+    for (count = nleaves; count > 1; count = (count + 1) / 2) {
+        for (j = 0; j < count / 2; ++j)
+            node_hash(big, 0x01, md + 2*j*mdlen, mdlen, md + (2*j + 1)*mdlen, mdlen, md + j*mdlen);
+        if (count & 1)
+            memmove(md + (count / 2)*mdlen, md + (count - 1)*mdlen, mdlen);
+    }
+    memcpy(digest, md, mdlen);
+    free(md);
+    return 0;
+}
+
+/*
+ * sha256_tree() - message의 SHA-256 트리 해시를 digest에 저장한다. 성공하면 0을 돌려준다.
+ */
+int sha256_tree(const unsigned char *message, size_t len, int nthreads, unsigned char *digest)
+{
+    return tree_hash(0, message, len, nthreads, digest);
+}
+
+/*
+ * sha512_tree() - message의 SHA-512 트리 해시를 digest에 저장한다. 성공하면 0을 돌려준다.
+ */
+int sha512_tree(const unsigned char *message, size_t len, int nthreads, unsigned char *digest)
+{
+    return tree_hash(1, message, len, nthreads, digest);
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#ifndef _SHA2TREE_H_
+#define _SHA2TREE_H_
+
+#include <stddef.h>
+#include "sha2.h"
+
+/*
+ * SHA-2 트리 해시
+ * 입력을 SHA2_TREE_LEAFLEN 바이트씩 잎으로 나눈다. 마지막 잎은 더 짧을 수 있고,
+ * 빈 입력은 길이 0인 잎 하나로 본다. H가 SHA-256(또는 SHA-512)일 때
+ *
+ *   잎 노드   = H(0x00 || 잎)
+ *   부모 노드 = H(0x01 || 왼쪽 자식 || 오른쪽 자식)
+ *
+ * 이고, 잎 노드부터 한 층씩 왼쪽부터 두 개씩 묶어 부모를 만든다. 한 층의 노드 수가 홀수이면
+ * 마지막 노드는 바꾸지 않고 위층으로 올린다. 노드가 하나 남으면 그것이 트리 해시이다.
+ * 이 트리는 RFC 6962의 Merkle Tree Hash와 같다. 잎 길이가 고정이므로 스레드 수와 관계없이
+ * 같은 입력은 항상 같은 값이 되지만, 같은 입력의 sha256() 값과는 다르다.
+ * 잎은 nthreads개의 스레드가 연속된 구간으로 나누어 해시한다. nthreads <= 0이면 CPU 수를 쓰고,
+ * 스레드는 호출마다 만들되 잎 수보다 많이 만들지 않는다 (잎이 하나이면 호출한 스레드만 쓴다).
+ */
+#define SHA2_TREE_LEAFLEN (1 << 20)
+#define SHA2_TREE_MAXTHREADS 64
+
+/*
+ * 오류 코드
+ */
+#define SHA2_TREE_NOMEM -1          /* 잎 해시를 담을 메모리 부족 */
+
+int sha256_tree(const unsigned char *message, size_t len, int nthreads, unsigned char *digest);
+int sha512_tree(const unsigned char *message, size_t len, int nthreads, unsigned char *digest);
+
+#endif
@@ -25,6 +25,11 @@ static char poet_c[256] = {0x93,0xba,0xc2,0xfd,0x87,0xf4,0x29,0x46,0xac,0x1b,0x0
 static char poem_s[256] = {0x8c,0xc4,0xf1,0x86,0xe7,0x2c,0x16,0x01,0xd5,0x81,0x6a,0x21,0xc9,0x5b,0xcb,0xcc,0xc9,0x28,0x87,0x4a,0x3d,0xc3,0x75,0xa7,0xf8,0xcd,0x9f,0xf2,0x9b,0x84,0xe1,0xf9,0x55,0x3c,0xcc,0x52,0xb7,0x45,0x50,0x7c,0x29,0xe7,0x2f,0x93,0xbc,0xff,0x51,0x42,0xb6,0x9e,0x4a,0x01,0x38,0x2f,0xc7,0xd8,0x20,0xe6,0x3a,0xba,0xe5,0xf2,0x4d,0x07,0xd1,0xde,0x41,0xc6,0xb1,0xd6,0xfa,0xd8,0xb6,0xd5,0x94,0x25,0x57,0x05,0x83,0x3b,0x06,0xfe,0xc7,0x6c,0x28,0xe2,0x66,0x4b,0x45,0xd8,0xba,0x31,0x9a,0x87,0xea,0xcf,0x72,0x28,0x16,0x79,0x1f,0xe3,0x0d,0x18,0xbf,0xc7,0xaa,0xb7,0xf1,0x2d,0x10,0x49,0xef,0xdd,0x26,0x2f,0x68,0x46,0x93,0x86,0xaa,0xcc,0xd5,0xf8,0xcb,0xea,0x6e,0x6b,0xde,0x56,0xeb,0xb5,0x8c,0x1c,0x77,0x17,0x52,0xce,0x30,0x8e,0x4f,0x61,0x11,0x2b,0x46,0x98,0xf5,0xcb,0xfd,0xf8,0x4a,0x32,0xb7,0x25,0xf4,0xb4,0x16,0x8c,0x15,0x6b,0x3f,0xf6,0xe2,0x9a,0x08,0x63,0x80,0x8a,0x24,0x50,0x2f,0x7f,0x32,0x72,0x15,0x26,0xb9,0x4d,0xec,0x3e,0x47,0x0c,0x78,0x53,0x45,0x21,0xbd,0x51,0x2e,0xc2,0xa2,0x4e,0x32,0x11,0xaf,0x23,0x7a,0x3a,0x0b,0xfc,0xb0,0xaa,0xc1,0x60,0x5c,0xfe,0x5f,0x0d,0x3a,0xee,0x11,0xec,0xd0,0x05,0x12,0x99,0xec,0x1d,0x93,0xf9,0x93,0xfb,0x59,0x1a,0xa5,0x62,0xe1,0x26,0xbc,0x86,0x35,0x7a,0x87,0x42,0xad,0xb7,0xaf,0x9c,0xe4,0xb0,0xf7,0x63,0x9e,0x6e,0x62,0xc4,0xd2,0xfc,0xda,0x77,0x66,0x08,0xbc,0x52,0xe7,0x72};
 static char hidden[256] = {0x9e,0x30,0xaf,0xde,0xb6,0x28,0x3a,0x34,0xe1,0xde,0x6c,0x4a,0xf0,0x7f,0x0b,0x71,0x95,0xc8,0x72,0x1c,0xed,0xcc,0xd4,0x74,0x62,0xed,0xfb,0x06,0xb1,0xc2,0x86,0x19,0xdd,0x03,0xf2,0xc6,0x86,0x62,0x4a,0x65,0x8a,0xd9,0x08,0xa9,0x6c,0xf8,0xf8,0x31,0x03,0xd9,0x7b,0x6d,0x44,0xa5,0xce,0x36,0xd4,0xd0,0x35,0x51,0x4f,0x00,0xab,0x41,0x26,0x46,0x7c,0xc1,0x54,0x38,0x0b,0x46,0x53,0x1a,0x9a,0x74,0x91,0xfd,0x62,0xe5,0x32,0xfa,0x06,0xf5,0xd9,0xbe,0x97,0xb2,0x49,0x51,0x1c,0xdf,0x6e,0xdb,0xde,0x31,0xf3,0x2d,0x47,0x96,0x12,0x23,0x63,0xbd,0x27,0x2f,0xb0,0x73,0x9b,0xe6,0xd6,0x9c,0x8b,0x0e,0xd8,0x1b,0xce,0x49,0xc6,0x03,0xab,0x97,0x85,0xbb,0x54,0x95,0x4a,0x79,0x6f,0x86,0xfb,0x09,0xb7,0x24,0x23,0x8e,0x34,0x14,0xd4,0x99,0x97,0x1e,0xa6,0x76,0xd0,0x47,0xe0,0x2b,0xf1,0x04,0x5a,0x03,0x4e,0xe5,0xa8,0xef,0xb0,0xf6,0x25,0x74,0x87,0x25,0xfd,0x2d,0xa2,0xb5,0x9b,0xdb,0xcb,0xe8,0x16,0xb9,0xad,0x53,0x82,0xfe,0x1f,0xe9,0xed,0xb2,0x3b,0x32,0x79,0x91,0xcd,0x00,0xbe,0x8d,0xf6,0xcb,0x5d,0xb7,0x8e,0xa2,0x7e,0x98,0x65,0xa8,0x94,0x31,0x00,0x2d,0xa7,0xd9,0x3d,0x51,0xc7,0x86,0x70,0x38,0x5c,0x6a,0xa9,0x5c,0x11,0x13,0x71,0xb9,0xa2,0x46,0x4d,0x88,0x43,0xdf,0x02,0x5a,0x44,0xb9,0xed,0xc2,0x25,0x12,0xac,0x78,0xc8,0xdb,0x8d,0xc7,0xb5,0xf9,0x8e,0xd4,0x72,0x4b,0x8e,0x05,0x43,0x48,0xbd,0x3f,0x5a,0x9b,0x70,0xcd,0xa8,0xe4};
 
+/*
+ * 일괄 검증 시험에 쓰는 항목 수
+ */
+#define BATCH_ITEMS 96
+
 int main(void)
 {
     char e[RSAKEYSIZE/8], d[RSAKEYSIZE/8], n[RSAKEYSIZE/8];
@@ -32,8 +37,21 @@ int main(void)
     long x, y;
     int i, val, count;
     size_t len;
-    clock_t start, end;
-    double cpu_time;
+    unsigned char mHash[SHA512_DIGEST_SIZE];
+    rsassa_pss_ctx ctx;
+    static rsa_crt_key key, bad, big[2];
+    static char big_m[RSA_MAXKEYSIZE/8], big_c[RSA_MAXKEYSIZE/8], big_s[RSA_MAXKEYSIZE/8];
+    static const int big_bits[2] = {3072, 4096};
+    static rsa_public_key poet_pub;
+    static rsa_handle hpub, hcrt, hb[3];
+    static rsassa_pss_batch_item items[BATCH_ITEMS];
+    static unsigned char sigs[BATCH_ITEMS][RSA_MAXKEYSIZE/8];
+    static int status[BATCH_ITEMS];
+    static const int nthreads[3] = {1, 3, 0};
+    size_t nbad;
+    int j;
+    clock_t start, end, t0;
+    double cpu_time, t_d, t_crt, t_h;
 
     start = clock();
     /*
@@ -228,6 +246,365 @@ int main(void)
     }
     printf("Valid Signature! -- PASSED\n---\n");
     
+    /*
+     * <나눠서 넣은 메시지의 서명과 검증>
+     * 시를 몇 바이트씩 나눠 넣어서 서명하고 한 번에 검증한다. 반대로 한 번에 서명한 것을
+     * 나눠 넣어서 검증하고, 미리 구한 해시값으로 서명한 것을 메시지로 검증한다.
+     */
+    len = strlen(poem);
+    rsassa_pss_init(&ctx, SHA512);
+    for (i = 0; i < (int)len; i += 7)
+        rsassa_pss_update(&ctx, poem + i, len - i < 7 ? len - i : 7);
+    if ((val = rsassa_pss_sign_final(&ctx, d, n, s)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_verify(poem, len, e, n, s, SHA512)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_sign(poem, len, d, n, s, SHA384)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    rsassa_pss_init(&ctx, SHA384);
+    rsassa_pss_update(&ctx, poem, 100);
+    rsassa_pss_update(&ctx, poem + 100, 0);
+    rsassa_pss_update(&ctx, poem + 100, len - 100);
+    if ((val = rsassa_pss_verify_final(&ctx, e, n, s)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    sha512_256((const unsigned char *)poem, len, mHash);
+    if ((val = rsassa_pss_sign_digest(mHash, d, n, s, SHA512_256)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_verify(poem, len, e, n, s, SHA512_256)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_verify_digest(mHash, e, n, s, SHA512_256)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    mHash[0] ^= 1;
+    if (rsassa_pss_verify_digest(mHash, e, n, s, SHA512_256) == 0) {
+        printf("Logic Error! -- FAILED\n");
+        return 1;
+    }
+    if (rsassa_pss_init(&ctx, 6) != PKCS_INVALID_HASH || rsassa_pss_sign(poem, len, d, n, s, -1) != PKCS_INVALID_HASH) {
+        printf("Invalid Hash Index -- FAILED\n");
+        return 1;
+    }
+    printf("Streaming and Prehashed Signature -- PASSED\n---\n");
+
+    /*
+     * <CRT 개인키 시험>
+     * CRT 성분을 보관한 키로 복호화와 서명을 하고 (d,n)을 쓴 결과와 비교한다.
+     * dP를 한 비트 바꾼 키로 서명하면 e로 확인하는 단계에서 걸러져야 한다.
+     */
+    rsa_generate_crt_key(&key, RSAKEYSIZE, 0);
+    if ((val = rsaes_oaep_encrypt(poem, 100, "", key.pub.e, key.pub.n, c, SHA256)) != 0) {
+        printf("Encryption Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    memset(m, 0, sizeof(m));
+    if ((val = rsaes_oaep_decrypt_crt(m, &len, "", &key, c, SHA256)) != 0 || len != 100 || memcmp(m, poem, 100) != 0) {
+        printf("Decryption Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    memset(m, 0, sizeof(m));
+    if ((val = rsaes_oaep_decrypt(m, &len, "", key.d, key.pub.n, c, SHA256)) != 0 || len != 100 || memcmp(m, poem, 100) != 0) {
+        printf("Decryption Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_sign_crt(poem, strlen(poem), &key, s, SHA384)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_verify(poem, strlen(poem), key.pub.e, key.pub.n, s, SHA384)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    rsassa_pss_init(&ctx, SHA224);
+    rsassa_pss_update(&ctx, poem, strlen(poem));
+    if ((val = rsassa_pss_sign_final_crt(&ctx, &key, s)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_verify(poem, strlen(poem), key.pub.e, key.pub.n, s, SHA224)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    sha256((const unsigned char *)poem, strlen(poem), mHash);
+    if ((val = rsassa_pss_sign_digest_crt(mHash, &key, s, SHA256)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if ((val = rsassa_pss_verify(poem, strlen(poem), key.pub.e, key.pub.n, s, SHA256)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if (rsaes_oaep_decrypt_crt(m, &len, "", &key, key.pub.n, SHA256) != PKCS_MSG_OUT_OF_RANGE) {
+        printf("Range Error -- FAILED\n");
+        return 1;
+    }
+    bad = key;
+    bad.dP[RSAKEYSIZE/16-1] ^= 0x02;
+    memset(s, 0, sizeof(s));
+    if ((val = rsassa_pss_sign_crt(poem, strlen(poem), &bad, s, SHA256)) != PKCS_CRT_FAULT) {
+        printf("Fault Check Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    for (i = 0; i < RSAKEYSIZE/8; ++i)
+        if (s[i] != 0) {
+            printf("Faulty Signature Released -- FAILED\n");
+            return 1;
+        }
+    t0 = clock();
+    for (i = 0; i < 100; ++i)
+        rsaes_oaep_decrypt(m, &len, "", key.d, key.pub.n, c, SHA256);
+    t_d = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    t0 = clock();
+    for (i = 0; i < 100; ++i)
+        rsaes_oaep_decrypt_crt(m, &len, "", &key, c, SHA256);
+    t_crt = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    printf("Decryption x100: (d,n) %.3f초, CRT %.3f초 (%.2fx)\n", t_d, t_crt, t_d / t_crt);
+    printf("CRT Private Key -- PASSED\n---\n");
+
+    /*
+     * <가변 키 길이 시험>
+     * 3072비트와 4096비트 키를 함께 만들어 암복호화와 서명, 검증을 하고,
+     * 한 키로 만든 서명을 다른 키로 검증하면 실패하는지 확인한다.
+     */
+    for (i = 0; i < 2; ++i) {
+        if ((val = rsa_generate_crt_key(&big[i], big_bits[i], 0)) != 0) {
+            printf("Key Generation Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsaes_oaep_encrypt_pub(poem, strlen(poem), "", &big[i].pub, big_c, SHA256)) != 0) {
+            printf("Encryption Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        memset(big_m, 0, sizeof(big_m));
+        if ((val = rsaes_oaep_decrypt_crt(big_m, &len, "", &big[i], big_c, SHA256)) != 0 || len != strlen(poem) || memcmp(big_m, poem, len) != 0) {
+            printf("Decryption Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsassa_pss_sign_crt(poem, strlen(poem), &big[i], big_s, SHA512)) != 0) {
+            printf("Signature Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsassa_pss_verify_pub(poem, strlen(poem), &big[i].pub, big_s, SHA512)) != 0) {
+            printf("Verification Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        printf("%d-bit key -- PASSED\n", big_bits[i]);
+    }
+    if (rsassa_pss_verify_pub(poem, strlen(poem), &big[0].pub, big_s, SHA512) == 0) {
+        printf("Logic Error! -- FAILED\n");
+        return 1;
+    }
+    if (rsa_generate_crt_key(&bad, 1000, 0) != PKCS_INVALID_KEYSIZE || rsa_generate_crt_key(&bad, 3000, 0) != PKCS_INVALID_KEYSIZE) {
+        printf("Invalid Key Size -- FAILED\n");
+        return 1;
+    }
+    bad = big[1];
+    bad.pub.bits = 8192;
+    if (rsaes_oaep_encrypt_pub("sample", 6, "", &bad.pub, big_c, SHA256) != PKCS_INVALID_KEYSIZE ||
+        rsassa_pss_sign_crt("sample", 6, &bad, big_s, SHA256) != PKCS_INVALID_KEYSIZE) {
+        printf("Invalid Key Size -- FAILED\n");
+        return 1;
+    }
+    printf("Variable Key Size -- PASSED\n---\n");
+
+    /*
+     * <키 핸들 시험>
+     * 키 핸들로 한 연산을 옥텟 문자열 키와 키 객체 함수로 다시 확인하고, 반대 방향도 확인한다.
+     * 공개키 핸들로 알려진 서명을 검증하고, 공개키 핸들로 개인키 연산을 하면 실패하는지 확인한다.
+     */
+    poet_pub.bits = RSAKEYSIZE;
+    memcpy(poet_pub.n, poet_n, RSAKEYSIZE/8);
+    memcpy(poet_pub.e, poet_e, RSAKEYSIZE/8);
+    if ((val = rsa_handle_init_pub(&hpub, &poet_pub)) != 0 || (val = rsassa_pss_verify_handle(poem, strlen(poem), &hpub, poem_s, SHA256)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    if (rsassa_pss_sign_handle(poem, strlen(poem), &hpub, s, SHA256) != PKCS_NOT_PRIVATE ||
+        rsaes_oaep_decrypt_handle(m, &len, "korean poet", &hpub, poet_c, SHA224) != PKCS_NOT_PRIVATE) {
+        printf("Public Handle Error -- FAILED\n");
+        return 1;
+    }
+    for (i = 0; i < 3; ++i) {
+        const rsa_crt_key *kp = i == 0 ? &key : &big[i-1];
+        if ((val = rsa_handle_init_crt(&hcrt, kp)) != 0 || (val = rsa_handle_init_pub(&hpub, &kp->pub)) != 0) {
+            printf("Handle Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsaes_oaep_encrypt_handle(poem, 100, "label", &hpub, big_c, SHA256)) != 0) {
+            printf("Encryption Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        memset(big_m, 0, sizeof(big_m));
+        if ((val = rsaes_oaep_decrypt_crt(big_m, &len, "label", kp, big_c, SHA256)) != 0 || len != 100 || memcmp(big_m, poem, len) != 0) {
+            printf("Decryption Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsaes_oaep_encrypt_pub(poem, 100, "label", &kp->pub, big_c, SHA256)) != 0) {
+            printf("Encryption Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        memset(big_m, 0, sizeof(big_m));
+        if ((val = rsaes_oaep_decrypt_handle(big_m, &len, "label", &hcrt, big_c, SHA256)) != 0 || len != 100 || memcmp(big_m, poem, len) != 0) {
+            printf("Decryption Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsassa_pss_sign_handle(poem, strlen(poem), &hcrt, big_s, SHA384)) != 0) {
+            printf("Signature Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsassa_pss_verify_pub(poem, strlen(poem), &kp->pub, big_s, SHA384)) != 0) {
+            printf("Verification Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        sha512((const unsigned char *)poem, strlen(poem), mHash);
+        if ((val = rsassa_pss_sign_digest_crt(mHash, kp, big_s, SHA512)) != 0) {
+            printf("Signature Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if ((val = rsassa_pss_verify_digest_handle(mHash, &hpub, big_s, SHA512)) != 0 ||
+            (val = rsassa_pss_verify_digest_handle(mHash, &hcrt, big_s, SHA512)) != 0) {
+            printf("Verification Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        big_s[kp->pub.bits/16] ^= 0x01;
+        if (rsassa_pss_verify_digest_handle(mHash, &hpub, big_s, SHA512) == 0) {
+            printf("Logic Error! -- FAILED\n");
+            return 1;
+        }
+        if (rsaes_oaep_decrypt_handle(big_m, &len, "label", &hcrt, kp->pub.n, SHA256) != PKCS_MSG_OUT_OF_RANGE) {
+            printf("Range Error -- FAILED\n");
+            return 1;
+        }
+    }
+    /*
+     * 스트리밍 인터페이스로 마지막 키의 핸들로 서명하고 검증한다.
+     */
+    rsassa_pss_init(&ctx, SHA256);
+    rsassa_pss_update(&ctx, poem, 100);
+    rsassa_pss_update(&ctx, poem + 100, strlen(poem) - 100);
+    if ((val = rsassa_pss_sign_final_handle(&ctx, &hcrt, big_s)) != 0) {
+        printf("Signature Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    rsassa_pss_init(&ctx, SHA256);
+    rsassa_pss_update(&ctx, poem, strlen(poem));
+    if ((val = rsassa_pss_verify_final_handle(&ctx, &hpub, big_s)) != 0 ||
+        (val = rsassa_pss_verify_handle(poem, strlen(poem), &hpub, big_s, SHA256)) != 0) {
+        printf("Verification Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    rsassa_pss_init(&ctx, SHA256);
+    rsassa_pss_update(&ctx, poem, strlen(poem) - 1);
+    if (rsassa_pss_verify_final_handle(&ctx, &hpub, big_s) == 0) {
+        printf("Logic Error! -- FAILED\n");
+        return 1;
+    }
+    /*
+     * 짝수이거나 길이가 맞지 않는 모듈러스, n과 맞지 않는 p는 핸들을 만들지 않는다.
+     */
+    bad = key;
+    bad.pub.n[RSAKEYSIZE/8-1] ^= 0x01;
+    if (rsa_handle_init_pub(&hpub, &bad.pub) != PKCS_INVALID_KEY || rsa_handle_init_crt(&hcrt, &bad) != PKCS_INVALID_KEY) {
+        printf("Even Modulus -- FAILED\n");
+        return 1;
+    }
+    bad = key;
+    bad.pub.n[0] = 0;
+    if (rsa_handle_init_pub(&hpub, &bad.pub) != PKCS_INVALID_KEY) {
+        printf("Short Modulus -- FAILED\n");
+        return 1;
+    }
+    bad = key;
+    bad.p[RSAKEYSIZE/32] ^= 0x01;
+    if (rsa_handle_init_crt(&hcrt, &bad) != PKCS_INVALID_KEY) {
+        printf("Mismatched Prime -- FAILED\n");
+        return 1;
+    }
+    bad = key;
+    bad.dQ[RSAKEYSIZE/16-1] ^= 0x02;
+    rsa_handle_init_crt(&hcrt, &bad);
+    if ((val = rsassa_pss_sign_handle(poem, strlen(poem), &hcrt, s, SHA256)) != PKCS_CRT_FAULT) {
+        printf("Fault Check Error: %d -- FAILED\n", val);
+        return 1;
+    }
+    bad.pub.bits = 1024;
+    if (rsa_handle_init_crt(&hcrt, &bad) != PKCS_INVALID_KEYSIZE) {
+        printf("Invalid Key Size -- FAILED\n");
+        return 1;
+    }
+    rsa_handle_init_crt(&hcrt, &key);
+    rsaes_oaep_encrypt_pub(poem, 100, "", &key.pub, c, SHA256);
+    t0 = clock();
+    for (i = 0; i < 100; ++i)
+        rsaes_oaep_decrypt_crt(m, &len, "", &key, c, SHA256);
+    t_crt = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    t0 = clock();
+    for (i = 0; i < 100; ++i)
+        rsaes_oaep_decrypt_handle(m, &len, "", &hcrt, c, SHA256);
+    t_h = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    printf("Decryption x100: CRT %.3f초, 핸들 %.3f초 (%.2fx)\n", t_crt, t_h, t_crt / t_h);
+    printf("Key Handle -- PASSED\n---\n");
+
+    /*
+     * <일괄 검증 시험>
+     * 길이가 다른 메시지를 세 키로 번갈아 서명하고 일부 서명, 메시지, 키를 망가뜨린 다음,
+     * 스레드 수를 바꿔 가며 일괄 검증한 결과가 하나씩 검증한 결과와 같은지 확인한다.
+     */
+    for (i = 0; i < 3; ++i)
+        rsa_handle_init_crt(&hb[i], i == 0 ? &key : &big[i-1]);
+    for (i = 0; i < BATCH_ITEMS; ++i) {
+        items[i].msg = poem + (i % 7);
+        items[i].len = (i * 13) % (strlen(poem) - 7);
+        items[i].key = &hb[i % 3];
+        items[i].sig = sigs[i];
+        if ((val = rsassa_pss_sign_handle(items[i].msg, items[i].len, items[i].key, sigs[i], SHA256)) != 0) {
+            printf("Signature Error: %d -- FAILED\n", val);
+            return 1;
+        }
+        if (i % 5 == 1)
+            sigs[i][20] ^= 0x80;
+        else if (i % 11 == 2)
+            items[i].len += 1;
+        else if (i % 13 == 3)
+            items[i].key = &hb[(i + 1) % 3];
+    }
+    for (j = 0; j < 3; ++j) {
+        memset(status, 0xff, sizeof(status));
+        nbad = rsassa_pss_verify_batch(items, BATCH_ITEMS, status, SHA256, nthreads[j]);
+        count = 0;
+        for (i = 0; i < BATCH_ITEMS; ++i) {
+            val = rsassa_pss_verify_handle(items[i].msg, items[i].len, items[i].key, items[i].sig, SHA256);
+            if (status[i] != val || (val == 0) != (i % 5 != 1 && i % 11 != 2 && i % 13 != 3)) {
+                printf("Batch Status Error: item %d, %d != %d -- FAILED\n", i, status[i], val);
+                return 1;
+            }
+            count += val != 0;
+        }
+        if (nbad != (size_t)count) {
+            printf("Batch Count Error: %zu != %d -- FAILED\n", nbad, count);
+            return 1;
+        }
+    }
+    if (rsassa_pss_verify_batch(items, 0, status, SHA256, 0) != 0 ||
+        rsassa_pss_verify_batch(items, 3, status, 7, 0) != 3 || status[0] != PKCS_INVALID_HASH) {
+        printf("Batch Error -- FAILED\n");
+        return 1;
+    }
+    printf("%d items, %d invalid\n", BATCH_ITEMS, count);
+    printf("Batch Verification -- PASSED\n---\n");
+
     /*
      * <해시함수 입력 길이 검사>
      * 해시함수가 허용하는 메시지의 최대 길이를 초과한 경우를 시험한다.
@@ -0,0 +1,123 @@
+/*
+ * Copyright(c) 2020-2023 All rights reserved by Heekuck Oh.
+ * 이 프로그램은 한양대학교 ERICA 컴퓨터학부 학생을 위한 교육용으로 제작되었다.
+ * 한양대학교 ERICA 학생이 아닌 자는 이 프로그램을 수정하거나 배포할 수 없다.
+ * 프로그램을 수정할 경우 날짜, 학과, 학번, 이름, 수정 내용을 기록한다.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sha2.h"
+#include "sha2tree.h"
+
+/*
+ * 큰 파일의 트리 해시 도구
+ *
+ *   treehash [-t 스레드수] [-a 256|512] 파일
+ *
+ * 파일을 mmap으로 읽어 sha256_tree()(또는 sha512_tree())로 트리 해시를 구해 출력하고,
+ * 같은 매핑을 sha256()(또는 sha512())으로 한 번 더 해시해서 두 방법의 처리 속도를 GB/s로 비교한다.
+ * 트리 해시를 먼저 계산하므로 파일이 페이지 캐시에 없으면 디스크에서 읽는 시간은 트리 해시 쪽에 들어간다.
+ */
+
+static double seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "사용법: treehash [-t 스레드수] [-a 256|512] 파일\n");
+}
+
+static void print_hex(const unsigned char *md, int len)
+{
+    int i;
+
+    for (i = 0; i < len; ++i)
+        printf("%02x", md[i]);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned char tree_md[SHA512_DIGEST_SIZE], flat_md[SHA512_DIGEST_SIZE];
+    const unsigned char *in = (const unsigned char *)"", *map = NULL;
+    struct stat st;
+    size_t len;
+    double t0, t1, t2;
+    int argi = 1, nthreads = 0, bits = 256, mdlen, fd, ret;
+
+    while (argi + 1 < argc && argv[argi][0] == '-') {
+        if (strcmp(argv[argi], "-t") == 0)
+            nthreads = atoi(argv[argi + 1]);
+        else if (strcmp(argv[argi], "-a") == 0)
+            bits = atoi(argv[argi + 1]);
+        else {
+            usage();
+            return 1;
+        }
+        argi += 2;
+    }
+    if (argc != argi + 1 || (bits != 256 && bits != 512)) {
+        usage();
+        return 1;
+    }
+    if (nthreads <= 0)
+        nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    mdlen = bits == 256 ? SHA256_DIGEST_SIZE : SHA512_DIGEST_SIZE;
+
+    if ((fd = open(argv[argi], O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+        perror(argv[argi]);
+        return 1;
+    }
+    len = (size_t)st.st_size;
+    if (len > 0) {
+        map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            perror("mmap");
+            close(fd);
+            return 1;
+        }
+        madvise((void *)map, len, MADV_WILLNEED);
+        in = map;
+    }
+
+    t0 = seconds();
+    if (bits == 256)
+        ret = sha256_tree(in, len, nthreads, tree_md);
+    else
+        ret = sha512_tree(in, len, nthreads, tree_md);
+    t1 = seconds();
+    if (ret != 0) {
+        fprintf(stderr, "메모리 부족\n");
+        goto out;
+    }
+    if (bits == 256)
+        sha256(in, len, flat_md);
+    else
+        sha512(in, len, flat_md);
+    t2 = seconds();
+
+    print_hex(tree_md, mdlen);
+    printf("  %s\n", argv[argi]);
+    printf("트리 SHA-%d (%d 스레드): %.3f 초, %.2f GB/s\n", bits, nthreads, t1 - t0,
+           t1 > t0 ? (double)len / (t1 - t0) / 1e9 : 0.0);
+    printf("sha%d() (1 스레드):      %.3f 초, %.2f GB/s\n", bits, t2 - t1,
+           t2 > t1 ? (double)len / (t2 - t1) / 1e9 : 0.0);
+    printf("sha%d() = ", bits);
+    print_hex(flat_md, mdlen);
+    printf("\n");
+
+out:
+    if (map != NULL)
+        munmap((void *)map, len);
+    close(fd);
+    return ret != 0;
+}
@@ -19,37 +19,6 @@
 mpz_t p, n, Gx, Gy;
 
 
-// 원하는 해시 함수 버전으로 해쉬값을 생성해준다.
-static void sha_gen(int sha2_ndx, const unsigned char *message, unsigned int len, unsigned char *digest)
-{
-
-    // 함수 포인터 배열 -> 해시 함수들
-    void (*f[6])(const unsigned char *, unsigned int, unsigned char *) = { 
-        sha224, sha256, sha384, sha512, sha512_224, sha512_256
-    };  
-
-    // 정당한 값이 들어왔다면 해당 해시 함수로 해시
-    if (sha2_ndx >= 0 && sha2_ndx <= 5)
-        f[sha2_ndx](message, len, digest);
-
-}
-
-//  원하는 해시 값의 길이를 리턴한다.
-static int sha_len(int sha2_ndx)
-{
-    // 미리 정의된 해시 길이의 배열
-    int shalen_index[6] = { 
-        SHA224_DIGEST_SIZE, SHA256_DIGEST_SIZE, SHA384_DIGEST_SIZE,
-        SHA512_DIGEST_SIZE, SHA224_DIGEST_SIZE, SHA256_DIGEST_SIZE
-        };
-        
-    // 정당하지 못한 값이라면 리턴
-    if (sha2_ndx > 5 || sha2_ndx < 0)
-        return 1;
-    // 해시 길이 리턴
-    return (shalen_index[sha2_ndx]);
-}
-
 // num이 몇비트로 이루어져 있는지 확인
 int countBits(size_t num) {
     int count = 0;
@@ -253,14 +222,11 @@ void ecdsa_p256_key(void *d, ecdsa_p256_t *Q)
  */
 int ecdsa_p256_sign(const void *msg, size_t len, const void *d, void *_r, void *_s, int sha2_ndx)
 {
-	// 변수 설정
-	int hLen = sha_len(sha2_ndx);
-    mpz_t dd, ee, r, s, k, x1, y1, k_inv;
-    gmp_randstate_t state;
- 
-	// 해시 변수
-	unsigned char e[hLen];
-	unsigned char cutE[ECDSA_P256/8];
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char e[SHA512_DIGEST_SIZE];
+
+	// 해시함수 색인이 잘못되었으면 에러
+	if (hash == NULL) return ECDSA_INVALID_HASH;
 
 	// 해시 못할 크기면 에러
 	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
@@ -270,15 +236,38 @@ int ecdsa_p256_sign(const void *msg, size_t len, const void *d, void *_r, void *
 		if (countBits(len) > 125) return ECDSA_MSG_TOO_LONG;
 	}
 
+	// 해시 -> e
+	hash->digest(msg, len, e);
+	return ecdsa_p256_sign_digest(e, d, _r, _s, sha2_ndx);
+}
+
+/*
+ * ecdsa_p256_sign_digest(e, d, r, s) - 메시지 대신 해시값 e로 서명한다.
+ * e는 sha2_ndx 해시함수로 구한 메시지의 해시값이다. 메시지를 해시하는 곳과 서명하는 곳이
+ * 다를 때 사용한다. 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
+ */
+int ecdsa_p256_sign_digest(const void *_e, const void *d, void *_r, void *_s, int sha2_ndx)
+{
+	// 변수 설정
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	const unsigned char *e = _e;
+	int hLen;
+    mpz_t dd, ee, r, s, k, x1, y1, k_inv;
+    gmp_randstate_t state;
+ 
+	// 해시 변수
+	unsigned char cutE[ECDSA_P256/8];
+
+	// 해시함수 색인이 잘못되었으면 에러
+	if (hash == NULL) return ECDSA_INVALID_HASH;
+	hLen = hash->digest_size;
+
 	// 초기화
 	mpz_inits(dd, ee, r, s, k, x1, y1, k_inv, NULL);
 	gmp_randinit_default(state);
     gmp_randseed_ui(state, arc4random());
 	mpz_import(dd, ECDSA_P256/8, 1, 1, 1, 0, d);
 
-	// 해시 -> e
-	sha_gen(sha2_ndx, msg, len, e);
-
 	// e의 길이가 n의 길이(256비트) 보다 길면 뒷부분은 자른다.
 	if (hLen * 8 > ECDSA_P256){
 		memcpy(cutE, e, sizeof(unsigned char)*(ECDSA_P256/8));
@@ -342,14 +331,11 @@ int ecdsa_p256_sign(const void *msg, size_t len, const void *d, void *_r, void *
  */
 int ecdsa_p256_verify(const void *msg, size_t len, const ecdsa_p256_t *_Q, const void *_r, const void *_s, int sha2_ndx)
 {
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	unsigned char e[SHA512_DIGEST_SIZE];
 
-	// 변수 설정
-	int hLen = sha_len(sha2_ndx);
-	mpz_t r, s, ee, u, a1, b1, a2, b2, Qx, Qy;
-
-	// 해시 변수
-	unsigned char e[hLen];
-	unsigned char cutE[ECDSA_P256/8];
+	// 해시함수 색인이 잘못되었으면 에러
+	if (hash == NULL) return ECDSA_INVALID_HASH;
 
 	// 해시 못할 크기면 리턴
 	if (sha2_ndx == SHA224 || sha2_ndx == SHA256){
@@ -359,6 +345,31 @@ int ecdsa_p256_verify(const void *msg, size_t len, const ecdsa_p256_t *_Q, const
 		if (countBits(len) > 125) return ECDSA_MSG_TOO_LONG;
 	}
 
+	// 해시 -> e를 구한다.
+	hash->digest(msg, len, e);
+	return ecdsa_p256_verify_digest(e, _Q, _r, _s, sha2_ndx);
+}
+
+/*
+ * ecdsa_p256_verify_digest(e, Q, r, s) - 메시지 대신 해시값 e에 대한 서명 (r,s)를 공개키 Q로 검증한다.
+ * 성공하면 0, 그렇지 않으면 오류 코드를 넘겨준다.
+ */
+int ecdsa_p256_verify_digest(const void *_e, const ecdsa_p256_t *_Q, const void *_r, const void *_s, int sha2_ndx)
+{
+
+	// 변수 설정
+	const sha2_desc *hash = sha2_get_desc(sha2_ndx);
+	const unsigned char *e = _e;
+	int hLen;
+	mpz_t r, s, ee, u, a1, b1, a2, b2, Qx, Qy;
+
+	// 해시 변수
+	unsigned char cutE[ECDSA_P256/8];
+
+	// 해시함수 색인이 잘못되었으면 에러
+	if (hash == NULL) return ECDSA_INVALID_HASH;
+	hLen = hash->digest_size;
+
 	// 초기화
     mpz_inits(r, s, ee, u, a1, b1, a2, b2, Qx, Qy, NULL);
     mpz_import(r, ECDSA_P256/8, 1, 1, 1, 0, _r);
@@ -374,9 +385,6 @@ int ecdsa_p256_verify(const void *msg, size_t len, const ecdsa_p256_t *_Q, const
 		return ECDSA_SIG_INVALID;
 	}
 
-	// 해시 -> e를 구한다.
-    sha_gen(sha2_ndx, msg, len, e);
-
     // e의 길이가 n의 길이(256비트) 보다 길면 뒷부분은 자른다.
     if (hLen * 8 > ECDSA_P256){
         memcpy(cutE, e, sizeof(unsigned char)*(ECDSA_P256/8));
@@ -431,10 +439,45 @@ int ecdsa_p256_verify(const void *msg, size_t len, const ecdsa_p256_t *_Q, const
 
 }
 
+/*
+ * ecdsa_p256_hash_init(h, sha2_ndx) - 메시지를 나눠서 서명하거나 검증하기 위해 h를 준비한다.
+ * ecdsa_p256_hash_update()로 메시지를 도착하는 대로 넣은 다음 ecdsa_p256_sign_final()이나
+ * ecdsa_p256_verify_final()로 끝낸다. 메시지 전체를 메모리에 올릴 필요가 없다.
+ * 성공하면 0, 해시함수 색인이 잘못되었으면 ECDSA_INVALID_HASH를 넘겨준다.
+ */
+int ecdsa_p256_hash_init(ecdsa_p256_hash_t *h, int sha2_ndx)
+{
+	if ((h->hash = sha2_get_desc(sha2_ndx)) == NULL)
+		return ECDSA_INVALID_HASH;
+	h->sha2_ndx = sha2_ndx;
+	h->hash->init(&h->ctx);
+	return 0;
+}
 
+void ecdsa_p256_hash_update(ecdsa_p256_hash_t *h, const void *msg, size_t len)
+{
+	if (len > 0)
+		h->hash->update(&h->ctx, msg, len);
+}
 
+/*
+ * ecdsa_p256_sign_final(h, d, r, s) - 지금까지 넣은 메시지를 개인키 d로 서명한 결과를 r, s에 저장한다.
+ */
+int ecdsa_p256_sign_final(ecdsa_p256_hash_t *h, const void *d, void *r, void *s)
+{
+	unsigned char e[SHA512_DIGEST_SIZE];
 
+	h->hash->final(&h->ctx, e);
+	return ecdsa_p256_sign_digest(e, d, r, s, h->sha2_ndx);
+}
 
+/*
+ * ecdsa_p256_verify_final(h, Q, r, s) - 지금까지 넣은 메시지에 대한 서명 (r,s)를 공개키 Q로 검증한다.
+ */
+int ecdsa_p256_verify_final(ecdsa_p256_hash_t *h, const ecdsa_p256_t *Q, const void *r, const void *s)
+{
+	unsigned char e[SHA512_DIGEST_SIZE];
 
-
-
+	h->hash->final(&h->ctx, e);
+	return ecdsa_p256_verify_digest(e, Q, r, s, h->sha2_ndx);
+}
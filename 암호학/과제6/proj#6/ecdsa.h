@@ -7,6 +7,9 @@
 #ifndef _ECDSA_H_
 #define _ECDSA_H_
 
+#include <stddef.h>
+#include "sha2.h"
+
 /*
  * 타원곡선 P-256의 그룹 소수와 차수의 비트 크기로 값을 임의로 변경해서는 안된다.
  */
@@ -29,6 +32,7 @@
 #define ECDSA_MSG_TOO_LONG  1
 #define ECDSA_SIG_INVALID   2
 #define ECDSA_SIG_MISMATCH  3
+#define ECDSA_INVALID_HASH  4
 
 /*
  * 타원곡선 P-256 상의 점을 나타내기 위한 구조체이다.
@@ -44,4 +48,23 @@ void ecdsa_p256_key(void *d, ecdsa_p256_t *Q);
 int ecdsa_p256_sign(const void *msg, size_t len, const void *d, void *r, void *s, int sha2_ndx);
 int ecdsa_p256_verify(const void *msg, size_t len, const ecdsa_p256_t *Q, const void *r, const void *s, int sha2_ndx);
 
+/*
+ * 메시지를 나눠서 해시하는 서명과 검증
+ * ecdsa_p256_hash_init()으로 시작하고 ecdsa_p256_hash_update()로 메시지를 넣은 다음,
+ * ecdsa_p256_sign_final()이나 ecdsa_p256_verify_final()로 끝낸다.
+ * *_digest()는 메시지 대신 sha2_ndx 해시함수로 미리 구한 해시값 e를 받는다.
+ */
+typedef struct {
+    int sha2_ndx;
+    const sha2_desc *hash;
+    sha2_ctx ctx;
+} ecdsa_p256_hash_t;
+
+int ecdsa_p256_hash_init(ecdsa_p256_hash_t *h, int sha2_ndx);
+void ecdsa_p256_hash_update(ecdsa_p256_hash_t *h, const void *msg, size_t len);
+int ecdsa_p256_sign_final(ecdsa_p256_hash_t *h, const void *d, void *r, void *s);
+int ecdsa_p256_verify_final(ecdsa_p256_hash_t *h, const ecdsa_p256_t *Q, const void *r, const void *s);
+int ecdsa_p256_sign_digest(const void *e, const void *d, void *r, void *s, int sha2_ndx);
+int ecdsa_p256_verify_digest(const void *e, const ecdsa_p256_t *Q, const void *r, const void *s, int sha2_ndx);
+
 #endif
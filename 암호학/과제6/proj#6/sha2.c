@@ -31,6 +31,12 @@
  * SUCH DAMAGE.
  * ---
  * 2022 SHA-512/224, SHA-512/256 are added by Heekuck Oh
+ * 2023 SHA-NI compression for SHA-224/256 with run-time dispatch
+ *      is added by 2018037356 안동현
+ * 2023 multi-buffer SHA-2 (SSE2/AVX2 lanes) is added by 2018037356 안동현
+ * 2023 64/128-bit length counters and size_t lengths by 2018037356 안동현
+ * 2023 hash descriptor table is added by 2018037356 안동현
+ * 2023 AVX2 message schedule for SHA-384/512 is added by 2018037356 안동현
  */
 
 #if 0
@@ -41,6 +47,12 @@
 
 #include "sha2.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA2_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #define SHFR(x, n)    (x >> n)
 #define ROTR(x, n)   ((x >> n) | (x << ((sizeof(x) << 3) - n)))
 #define ROTL(x, n)   ((x << n) | (x >> ((sizeof(x) << 3) - n)))
@@ -129,6 +141,15 @@
     wv[h] = t1 + t2;                                        \
 }
 
+/* Adds n bytes to the 128-bit byte count of a SHA-384/512 context */
+#define SHA512_ADD_LEN(ctx, n)                \
+{                                             \
+    (ctx)->tot_len += (n);                    \
+    if ((ctx)->tot_len < (uint64) (n)) {      \
+        (ctx)->tot_len_hi++;                  \
+    }                                         \
+}
+
 uint32 sha224_h0[8] =
             {0xc1059ed8, 0x367cd507, 0x3070dd17, 0xf70e5939,
              0xffc00b31, 0x68581511, 0x64f98fa7, 0xbefa4fa4};
@@ -223,20 +244,20 @@ uint64 sha512_k[80] =
 
 /* SHA-256 functions */
 
-void sha256_transf(sha256_ctx *ctx, const unsigned char *message,
-                   unsigned int block_nb)
+static void sha256_transf_c(sha256_ctx *ctx, const unsigned char *message,
+                            size_t block_nb)
 {
     uint32 w[64];
     uint32 wv[8];
     uint32 t1, t2;
     const unsigned char *sub_block;
-    int i;
+    size_t i;
 
 #ifndef UNROLL_LOOPS
     int j;
 #endif
 
-    for (i = 0; i < (int) block_nb; i++) {
+    for (i = 0; i < block_nb; i++) {
         sub_block = message + (i << 6);
 
 #ifndef UNROLL_LOOPS
@@ -338,7 +359,170 @@ void sha256_transf(sha256_ctx *ctx, const unsigned char *message,
     }
 }
 
-void sha256(const unsigned char *message, unsigned int len, unsigned char *digest)
+#ifdef SHA2_X86
+/*
+ * Four rounds of SHA-256 with the SHA extensions. wg holds w[4g..4g+3];
+ * wp and wn are the previous and next message groups. While g is in
+ * [3, 14] the next group is completed with sha256msg2, and while g is in
+ * [1, 12] sha256msg1 starts the group four steps ahead. g is a constant
+ * at every use, so the conditions fold away.
+ */
+#define SHANI_QROUND(g, wg, wp, wn)                                       \
+{                                                                         \
+    msg = _mm_add_epi32(wg,                                               \
+              _mm_loadu_si128((const __m128i *) &sha256_k[4 * (g)]));     \
+    cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);                        \
+    if ((g) >= 3 && (g) <= 14) {                                          \
+        wn = _mm_add_epi32(wn, _mm_alignr_epi8(wg, wp, 4));               \
+        wn = _mm_sha256msg2_epu32(wn, wg);                                \
+    }                                                                     \
+    msg = _mm_shuffle_epi32(msg, 0x0e);                                   \
+    abef = _mm_sha256rnds2_epu32(abef, cdgh, msg);                        \
+    if ((g) >= 1 && (g) <= 12) {                                          \
+        wp = _mm_sha256msg1_epu32(wp, wg);                                \
+    }                                                                     \
+}
+
+/*
+ * sha256rnds2 keeps the state as the two vectors ABEF and CDGH, so the
+ * state is repacked on entry and exit and stays in registers across
+ * all blocks in between.
+ */
+__attribute__((target("sha,sse4.1")))
+static void sha256_transf_shani(sha256_ctx *ctx, const unsigned char *message,
+                                size_t block_nb)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL,
+                                         0x0405060700010203ULL);
+    __m128i abef, cdgh, abef_save, cdgh_save, tmp, msg;
+    __m128i w0, w1, w2, w3;
+
+    tmp  = _mm_loadu_si128((const __m128i *) &ctx->h[0]);   /* DCBA */
+    cdgh = _mm_loadu_si128((const __m128i *) &ctx->h[4]);   /* HGFE */
+    tmp  = _mm_shuffle_epi32(tmp, 0xb1);                    /* CDAB */
+    cdgh = _mm_shuffle_epi32(cdgh, 0x1b);                   /* EFGH */
+    abef = _mm_alignr_epi8(tmp, cdgh, 8);                   /* ABEF */
+    cdgh = _mm_blend_epi16(cdgh, tmp, 0xf0);                /* CDGH */
+
+    while (block_nb--) {
+        abef_save = abef;
+        cdgh_save = cdgh;
+
+        w0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) message),
+                              bswap);
+        w1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+                                              (message + 16)), bswap);
+        w2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+                                              (message + 32)), bswap);
+        w3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)
+                                              (message + 48)), bswap);
+
+        SHANI_QROUND( 0, w0, w3, w1); SHANI_QROUND( 1, w1, w0, w2);
+        SHANI_QROUND( 2, w2, w1, w3); SHANI_QROUND( 3, w3, w2, w0);
+        SHANI_QROUND( 4, w0, w3, w1); SHANI_QROUND( 5, w1, w0, w2);
+        SHANI_QROUND( 6, w2, w1, w3); SHANI_QROUND( 7, w3, w2, w0);
+        SHANI_QROUND( 8, w0, w3, w1); SHANI_QROUND( 9, w1, w0, w2);
+        SHANI_QROUND(10, w2, w1, w3); SHANI_QROUND(11, w3, w2, w0);
+        SHANI_QROUND(12, w0, w3, w1); SHANI_QROUND(13, w1, w0, w2);
+        SHANI_QROUND(14, w2, w1, w3); SHANI_QROUND(15, w3, w2, w0);
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+        message += SHA256_BLOCK_SIZE;
+    }
+
+    tmp  = _mm_shuffle_epi32(abef, 0x1b);                   /* FEBA */
+    cdgh = _mm_shuffle_epi32(cdgh, 0xb1);                   /* DCHG */
+    abef = _mm_blend_epi16(tmp, cdgh, 0xf0);                /* DCBA */
+    cdgh = _mm_alignr_epi8(cdgh, tmp, 8);                   /* HGFE */
+    _mm_storeu_si128((__m128i *) &ctx->h[0], abef);
+    _mm_storeu_si128((__m128i *) &ctx->h[4], cdgh);
+}
+
+static int cpu_has_shani(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    if (!(ecx & bit_SSE4_1) || !(ecx & bit_SSSE3))
+        return 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (ebx >> 29) & 1;     /* CPUID.(EAX=7,ECX=0):EBX.SHA */
+}
+
+static int cpu_has_avx2(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return 0;
+    /* the OS must save the YMM registers on context switch */
+    __asm__ ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+    if ((eax & 6) != 6)
+        return 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (ebx & bit_AVX2) != 0;
+}
+#endif /* SHA2_X86 */
+
+/*
+ * The compression used by SHA-224/256 is chosen once, when the program
+ * starts, and can be changed later with sha256_set_engine().
+ */
+static void (*sha256_transf_fn)(sha256_ctx *, const unsigned char *,
+                                size_t) = sha256_transf_c;
+static int sha256_engine = SHA256_ENGINE_C;
+
+int sha256_set_engine(int engine)
+{
+    if (engine == SHA256_ENGINE_AUTO) {
+#ifdef SHA2_X86
+        engine = cpu_has_shani() ? SHA256_ENGINE_SHANI : SHA256_ENGINE_C;
+#else
+        engine = SHA256_ENGINE_C;
+#endif
+    }
+    switch (engine) {
+    case SHA256_ENGINE_C:
+        sha256_transf_fn = sha256_transf_c;
+        break;
+#ifdef SHA2_X86
+    case SHA256_ENGINE_SHANI:
+        if (!cpu_has_shani())
+            return -1;
+        sha256_transf_fn = sha256_transf_shani;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    sha256_engine = engine;
+    return 0;
+}
+
+int sha256_get_engine(void)
+{
+    return sha256_engine;
+}
+
+__attribute__((constructor))
+static void sha256_engine_init(void)
+{
+    sha256_set_engine(SHA256_DEFAULT_ENGINE);
+}
+
+void sha256_transf(sha256_ctx *ctx, const unsigned char *message,
+                   size_t block_nb)
+{
+    sha256_transf_fn(ctx, message, block_nb);
+}
+
+void sha256(const unsigned char *message, size_t len, unsigned char *digest)
 {
     sha256_ctx ctx;
 
@@ -366,12 +550,25 @@ void sha256_init(sha256_ctx *ctx)
 }
 
 void sha256_update(sha256_ctx *ctx, const unsigned char *message,
-                   unsigned int len)
+                   size_t len)
 {
-    unsigned int block_nb;
-    unsigned int new_len, rem_len, tmp_len;
+    size_t block_nb;
+    size_t new_len, rem_len, tmp_len;
     const unsigned char *shifted_message;
 
+    if (ctx->len == 0) {
+        /* nothing is buffered: compress whole blocks in place */
+        block_nb = len / SHA256_BLOCK_SIZE;
+        sha256_transf(ctx, message, block_nb);
+
+        rem_len = len % SHA256_BLOCK_SIZE;
+        memcpy(ctx->block, &message[block_nb << 6], rem_len);
+
+        ctx->len = rem_len;
+        ctx->tot_len += (uint64) block_nb << 6;
+        return;
+    }
+
     tmp_len = SHA256_BLOCK_SIZE - ctx->len;
     rem_len = len < tmp_len ? len : tmp_len;
 
@@ -396,14 +593,14 @@ void sha256_update(sha256_ctx *ctx, const unsigned char *message,
            rem_len);
 
     ctx->len = rem_len;
-    ctx->tot_len += (block_nb + 1) << 6;
+    ctx->tot_len += (uint64) (block_nb + 1) << 6;
 }
 
 void sha256_final(sha256_ctx *ctx, unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b;
 
 #ifndef UNROLL_LOOPS
     int i;
@@ -417,7 +614,7 @@ void sha256_final(sha256_ctx *ctx, unsigned char *digest)
 
     memset(ctx->block + ctx->len, 0, pm_len - ctx->len);
     ctx->block[ctx->len] = 0x80;
-    UNPACK32(len_b, ctx->block + pm_len - 4);
+    UNPACK64(len_b, ctx->block + pm_len - 8);
 
     sha256_transf(ctx, ctx->block, block_nb);
 
@@ -439,16 +636,17 @@ void sha256_final(sha256_ctx *ctx, unsigned char *digest)
 
 /* SHA-512 functions */
 
-void sha512_transf(sha512_ctx *ctx, const unsigned char *message,
-                   unsigned int block_nb)
+static void sha512_transf_c(sha512_ctx *ctx, const unsigned char *message,
+                            size_t block_nb)
 {
     uint64 w[80];
     uint64 wv[8];
     uint64 t1, t2;
     const unsigned char *sub_block;
-    int i, j;
+    size_t i;
+    int j;
 
-    for (i = 0; i < (int) block_nb; i++) {
+    for (i = 0; i < block_nb; i++) {
         sub_block = message + (i << 7);
 
 #ifndef UNROLL_LOOPS
@@ -534,7 +732,161 @@ void sha512_transf(sha512_ctx *ctx, const unsigned char *message,
     }
 }
 
-void sha512(const unsigned char *message, unsigned int len,
+#ifdef SHA2_X86
+/*
+ * SHA-512 with the message schedule in AVX2 registers. Each vector holds
+ * four consecutive schedule words W[t..t+3]. W[t+2] and W[t+3] depend on
+ * W[t] and W[t+1] through SHA512_F4, so the sigma1 term is added in two
+ * halves. The schedule plus the round constants is stored in wk[]; the
+ * rounds stay scalar since each one depends on the one before.
+ */
+#define AVX2_ROTR64(x, n) \
+    _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - (n)))
+
+#define SHA512_AVX2_F4(x)                                                 \
+    _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR64(x, 19),                 \
+                                      AVX2_ROTR64(x, 61)),                \
+                     _mm256_srli_epi64(x, 6))
+
+/* {lo[1], lo[2], lo[3], hi[0]}, the words one position after lo */
+#define AVX2_NEXT64(hi, lo) \
+    _mm256_alignr_epi8(_mm256_permute2x128_si256(lo, hi, 0x21), lo, 8)
+
+#define SHA512_AVX2_SCHED(g)                                              \
+{                                                                         \
+    x = AVX2_NEXT64(w[(g) - 3], w[(g) - 4]);            /* W[t-15..] */   \
+    s = _mm256_xor_si256(_mm256_xor_si256(AVX2_ROTR64(x, 1),              \
+                                          AVX2_ROTR64(x, 8)),             \
+                         _mm256_srli_epi64(x, 7));                        \
+    s = _mm256_add_epi64(s, w[(g) - 4]);                /* W[t-16..] */   \
+    s = _mm256_add_epi64(s, AVX2_NEXT64(w[(g) - 1], w[(g) - 2]));         \
+    x = _mm256_permute4x64_epi64(w[(g) - 1], 0xee);     /* W[t-2..t-1] */ \
+    lo = _mm256_add_epi64(s, SHA512_AVX2_F4(x));                          \
+    x = _mm256_permute4x64_epi64(lo, 0x44);             /* W[t..t+1] */   \
+    hi = _mm256_add_epi64(s, SHA512_AVX2_F4(x));                          \
+    w[g] = _mm256_blend_epi32(lo, hi, 0xf0);                              \
+}
+
+#define SHA512_EXPK(a, b, c, d, e, f, g ,h, j)                            \
+{                                                                         \
+    t1 = wv[h] + SHA512_F2(wv[e]) + CH(wv[e], wv[f], wv[g]) + wk[j];      \
+    t2 = SHA512_F1(wv[a]) + MAJ(wv[a], wv[b], wv[c]);                     \
+    wv[d] += t1;                                                          \
+    wv[h] = t1 + t2;                                                      \
+}
+
+__attribute__((target("avx2")))
+static void sha512_transf_avx2(sha512_ctx *ctx, const unsigned char *message,
+                               size_t block_nb)
+{
+    const __m256i bswap = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL,
+                                            0x0001020304050607ULL,
+                                            0x08090a0b0c0d0e0fULL,
+                                            0x0001020304050607ULL);
+    __m256i w[20], x, s, lo, hi;
+    uint64 wk[80] __attribute__((aligned(32)));
+    uint64 wv[8];
+    uint64 t1, t2;
+    int j;
+
+    while (block_nb--) {
+        for (j = 0; j < 4; j++) {
+            w[j] = _mm256_shuffle_epi8(
+                       _mm256_loadu_si256((const __m256i *) (message + 32 * j)),
+                       bswap);
+        }
+        SHA512_AVX2_SCHED( 4); SHA512_AVX2_SCHED( 5);
+        SHA512_AVX2_SCHED( 6); SHA512_AVX2_SCHED( 7);
+        SHA512_AVX2_SCHED( 8); SHA512_AVX2_SCHED( 9);
+        SHA512_AVX2_SCHED(10); SHA512_AVX2_SCHED(11);
+        SHA512_AVX2_SCHED(12); SHA512_AVX2_SCHED(13);
+        SHA512_AVX2_SCHED(14); SHA512_AVX2_SCHED(15);
+        SHA512_AVX2_SCHED(16); SHA512_AVX2_SCHED(17);
+        SHA512_AVX2_SCHED(18); SHA512_AVX2_SCHED(19);
+        for (j = 0; j < 20; j++) {
+            _mm256_store_si256((__m256i *) &wk[4 * j],
+                _mm256_add_epi64(w[j],
+                    _mm256_loadu_si256((const __m256i *) &sha512_k[4 * j])));
+        }
+
+        for (j = 0; j < 8; j++) {
+            wv[j] = ctx->h[j];
+        }
+
+        j = 0;
+
+        do {
+            SHA512_EXPK(0,1,2,3,4,5,6,7,j); j++;
+            SHA512_EXPK(7,0,1,2,3,4,5,6,j); j++;
+            SHA512_EXPK(6,7,0,1,2,3,4,5,j); j++;
+            SHA512_EXPK(5,6,7,0,1,2,3,4,j); j++;
+            SHA512_EXPK(4,5,6,7,0,1,2,3,j); j++;
+            SHA512_EXPK(3,4,5,6,7,0,1,2,j); j++;
+            SHA512_EXPK(2,3,4,5,6,7,0,1,j); j++;
+            SHA512_EXPK(1,2,3,4,5,6,7,0,j); j++;
+        } while (j < 80);
+
+        for (j = 0; j < 8; j++) {
+            ctx->h[j] += wv[j];
+        }
+        message += SHA512_BLOCK_SIZE;
+    }
+}
+#endif /* SHA2_X86 */
+
+/*
+ * The compression used by SHA-384/512, SHA-512/224 and SHA-512/256 is
+ * chosen the same way as the SHA-256 one.
+ */
+static void (*sha512_transf_fn)(sha512_ctx *, const unsigned char *,
+                                size_t) = sha512_transf_c;
+static int sha512_engine = SHA512_ENGINE_C;
+
+int sha512_set_engine(int engine)
+{
+    if (engine == SHA512_ENGINE_AUTO) {
+#ifdef SHA2_X86
+        engine = cpu_has_avx2() ? SHA512_ENGINE_AVX2 : SHA512_ENGINE_C;
+#else
+        engine = SHA512_ENGINE_C;
+#endif
+    }
+    switch (engine) {
+    case SHA512_ENGINE_C:
+        sha512_transf_fn = sha512_transf_c;
+        break;
+#ifdef SHA2_X86
+    case SHA512_ENGINE_AVX2:
+        if (!cpu_has_avx2())
+            return -1;
+        sha512_transf_fn = sha512_transf_avx2;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    sha512_engine = engine;
+    return 0;
+}
+
+int sha512_get_engine(void)
+{
+    return sha512_engine;
+}
+
+__attribute__((constructor))
+static void sha512_engine_init(void)
+{
+    sha512_set_engine(SHA512_DEFAULT_ENGINE);
+}
+
+void sha512_transf(sha512_ctx *ctx, const unsigned char *message,
+                   size_t block_nb)
+{
+    sha512_transf_fn(ctx, message, block_nb);
+}
+
+void sha512(const unsigned char *message, size_t len,
             unsigned char *digest)
 {
     sha512_ctx ctx;
@@ -544,7 +896,7 @@ void sha512(const unsigned char *message, unsigned int len,
     sha512_final(&ctx, digest);
 }
 
-void sha512_224(const unsigned char *message, unsigned int len,
+void sha512_224(const unsigned char *message, size_t len,
             unsigned char *digest)
 {
     sha512_ctx ctx;
@@ -554,7 +906,7 @@ void sha512_224(const unsigned char *message, unsigned int len,
     sha512_224_final(&ctx, digest);
 }
 
-void sha512_256(const unsigned char *message, unsigned int len,
+void sha512_256(const unsigned char *message, size_t len,
             unsigned char *digest)
 {
     sha512_ctx ctx;
@@ -580,6 +932,7 @@ void sha512_init(sha512_ctx *ctx)
 
     ctx->len = 0;
     ctx->tot_len = 0;
+    ctx->tot_len_hi = 0;
 }
 
 void sha512_224_init(sha512_ctx *ctx)
@@ -598,6 +951,7 @@ void sha512_224_init(sha512_ctx *ctx)
 
     ctx->len = 0;
     ctx->tot_len = 0;
+    ctx->tot_len_hi = 0;
 }
 
 void sha512_256_init(sha512_ctx *ctx)
@@ -616,15 +970,29 @@ void sha512_256_init(sha512_ctx *ctx)
 
     ctx->len = 0;
     ctx->tot_len = 0;
+    ctx->tot_len_hi = 0;
 }
 
 void sha512_update(sha512_ctx *ctx, const unsigned char *message,
-                   unsigned int len)
+                   size_t len)
 {
-    unsigned int block_nb;
-    unsigned int new_len, rem_len, tmp_len;
+    size_t block_nb;
+    size_t new_len, rem_len, tmp_len;
     const unsigned char *shifted_message;
 
+    if (ctx->len == 0) {
+        /* nothing is buffered: compress whole blocks in place */
+        block_nb = len / SHA512_BLOCK_SIZE;
+        sha512_transf(ctx, message, block_nb);
+
+        rem_len = len % SHA512_BLOCK_SIZE;
+        memcpy(ctx->block, &message[block_nb << 7], rem_len);
+
+        ctx->len = rem_len;
+        SHA512_ADD_LEN(ctx, (uint64) block_nb << 7);
+        return;
+    }
+
     tmp_len = SHA512_BLOCK_SIZE - ctx->len;
     rem_len = len < tmp_len ? len : tmp_len;
 
@@ -649,14 +1017,14 @@ void sha512_update(sha512_ctx *ctx, const unsigned char *message,
            rem_len);
 
     ctx->len = rem_len;
-    ctx->tot_len += (block_nb + 1) << 7;
+    SHA512_ADD_LEN(ctx, (uint64) (block_nb + 1) << 7);
 }
 
 void sha512_final(sha512_ctx *ctx, unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b, len_b_hi;
 
 #ifndef UNROLL_LOOPS
     int i;
@@ -665,12 +1033,16 @@ void sha512_final(sha512_ctx *ctx, unsigned char *digest)
     block_nb = 1 + ((SHA512_BLOCK_SIZE - 17)
                      < (ctx->len % SHA512_BLOCK_SIZE));
 
-    len_b = (ctx->tot_len + ctx->len) << 3;
+    len_b = ctx->tot_len + ctx->len;
+    len_b_hi = ((ctx->tot_len_hi << 3) | (len_b >> 61))
+               + ((uint64) (len_b < ctx->tot_len) << 3);
+    len_b <<= 3;
     pm_len = block_nb << 7;
 
     memset(ctx->block + ctx->len, 0, pm_len - ctx->len);
     ctx->block[ctx->len] = 0x80;
-    UNPACK32(len_b, ctx->block + pm_len - 4);
+    UNPACK64(len_b_hi, ctx->block + pm_len - 16);
+    UNPACK64(len_b, ctx->block + pm_len - 8);
 
     sha512_transf(ctx, ctx->block, block_nb);
 
@@ -694,7 +1066,7 @@ void sha512_224_final(sha512_ctx *ctx, unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b, len_b_hi;
 
 #ifndef UNROLL_LOOPS
     int i;
@@ -703,12 +1075,16 @@ void sha512_224_final(sha512_ctx *ctx, unsigned char *digest)
     block_nb = 1 + ((SHA512_BLOCK_SIZE - 17)
                      < (ctx->len % SHA512_BLOCK_SIZE));
 
-    len_b = (ctx->tot_len + ctx->len) << 3;
+    len_b = ctx->tot_len + ctx->len;
+    len_b_hi = ((ctx->tot_len_hi << 3) | (len_b >> 61))
+               + ((uint64) (len_b < ctx->tot_len) << 3);
+    len_b <<= 3;
     pm_len = block_nb << 7;
 
     memset(ctx->block + ctx->len, 0, pm_len - ctx->len);
     ctx->block[ctx->len] = 0x80;
-    UNPACK32(len_b, ctx->block + pm_len - 4);
+    UNPACK64(len_b_hi, ctx->block + pm_len - 16);
+    UNPACK64(len_b, ctx->block + pm_len - 8);
 
     sha512_transf(ctx, ctx->block, block_nb);
 
@@ -733,7 +1109,7 @@ void sha512_256_final(sha512_ctx *ctx, unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b, len_b_hi;
 
 #ifndef UNROLL_LOOPS
     int i;
@@ -742,12 +1118,16 @@ void sha512_256_final(sha512_ctx *ctx, unsigned char *digest)
     block_nb = 1 + ((SHA512_BLOCK_SIZE - 17)
                      < (ctx->len % SHA512_BLOCK_SIZE));
 
-    len_b = (ctx->tot_len + ctx->len) << 3;
+    len_b = ctx->tot_len + ctx->len;
+    len_b_hi = ((ctx->tot_len_hi << 3) | (len_b >> 61))
+               + ((uint64) (len_b < ctx->tot_len) << 3);
+    len_b <<= 3;
     pm_len = block_nb << 7;
 
     memset(ctx->block + ctx->len, 0, pm_len - ctx->len);
     ctx->block[ctx->len] = 0x80;
-    UNPACK32(len_b, ctx->block + pm_len - 4);
+    UNPACK64(len_b_hi, ctx->block + pm_len - 16);
+    UNPACK64(len_b, ctx->block + pm_len - 8);
 
     sha512_transf(ctx, ctx->block, block_nb);
 
@@ -765,7 +1145,7 @@ void sha512_256_final(sha512_ctx *ctx, unsigned char *digest)
 
 /* SHA-384 functions */
 
-void sha384(const unsigned char *message, unsigned int len,
+void sha384(const unsigned char *message, size_t len,
             unsigned char *digest)
 {
     sha384_ctx ctx;
@@ -791,15 +1171,29 @@ void sha384_init(sha384_ctx *ctx)
 
     ctx->len = 0;
     ctx->tot_len = 0;
+    ctx->tot_len_hi = 0;
 }
 
 void sha384_update(sha384_ctx *ctx, const unsigned char *message,
-                   unsigned int len)
+                   size_t len)
 {
-    unsigned int block_nb;
-    unsigned int new_len, rem_len, tmp_len;
+    size_t block_nb;
+    size_t new_len, rem_len, tmp_len;
     const unsigned char *shifted_message;
 
+    if (ctx->len == 0) {
+        /* nothing is buffered: compress whole blocks in place */
+        block_nb = len / SHA384_BLOCK_SIZE;
+        sha512_transf(ctx, message, block_nb);
+
+        rem_len = len % SHA384_BLOCK_SIZE;
+        memcpy(ctx->block, &message[block_nb << 7], rem_len);
+
+        ctx->len = rem_len;
+        SHA512_ADD_LEN(ctx, (uint64) block_nb << 7);
+        return;
+    }
+
     tmp_len = SHA384_BLOCK_SIZE - ctx->len;
     rem_len = len < tmp_len ? len : tmp_len;
 
@@ -824,14 +1218,14 @@ void sha384_update(sha384_ctx *ctx, const unsigned char *message,
            rem_len);
 
     ctx->len = rem_len;
-    ctx->tot_len += (block_nb + 1) << 7;
+    SHA512_ADD_LEN(ctx, (uint64) (block_nb + 1) << 7);
 }
 
 void sha384_final(sha384_ctx *ctx, unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b, len_b_hi;
 
 #ifndef UNROLL_LOOPS
     int i;
@@ -840,12 +1234,16 @@ void sha384_final(sha384_ctx *ctx, unsigned char *digest)
     block_nb = (1 + ((SHA384_BLOCK_SIZE - 17)
                      < (ctx->len % SHA384_BLOCK_SIZE)));
 
-    len_b = (ctx->tot_len + ctx->len) << 3;
+    len_b = ctx->tot_len + ctx->len;
+    len_b_hi = ((ctx->tot_len_hi << 3) | (len_b >> 61))
+               + ((uint64) (len_b < ctx->tot_len) << 3);
+    len_b <<= 3;
     pm_len = block_nb << 7;
 
     memset(ctx->block + ctx->len, 0, pm_len - ctx->len);
     ctx->block[ctx->len] = 0x80;
-    UNPACK32(len_b, ctx->block + pm_len - 4);
+    UNPACK64(len_b_hi, ctx->block + pm_len - 16);
+    UNPACK64(len_b, ctx->block + pm_len - 8);
 
     sha512_transf(ctx, ctx->block, block_nb);
 
@@ -865,7 +1263,7 @@ void sha384_final(sha384_ctx *ctx, unsigned char *digest)
 
 /* SHA-224 functions */
 
-void sha224(const unsigned char *message, unsigned int len,
+void sha224(const unsigned char *message, size_t len,
             unsigned char *digest)
 {
     sha224_ctx ctx;
@@ -894,12 +1292,25 @@ void sha224_init(sha224_ctx *ctx)
 }
 
 void sha224_update(sha224_ctx *ctx, const unsigned char *message,
-                   unsigned int len)
+                   size_t len)
 {
-    unsigned int block_nb;
-    unsigned int new_len, rem_len, tmp_len;
+    size_t block_nb;
+    size_t new_len, rem_len, tmp_len;
     const unsigned char *shifted_message;
 
+    if (ctx->len == 0) {
+        /* nothing is buffered: compress whole blocks in place */
+        block_nb = len / SHA224_BLOCK_SIZE;
+        sha256_transf(ctx, message, block_nb);
+
+        rem_len = len % SHA224_BLOCK_SIZE;
+        memcpy(ctx->block, &message[block_nb << 6], rem_len);
+
+        ctx->len = rem_len;
+        ctx->tot_len += (uint64) block_nb << 6;
+        return;
+    }
+
     tmp_len = SHA224_BLOCK_SIZE - ctx->len;
     rem_len = len < tmp_len ? len : tmp_len;
 
@@ -924,14 +1335,14 @@ void sha224_update(sha224_ctx *ctx, const unsigned char *message,
            rem_len);
 
     ctx->len = rem_len;
-    ctx->tot_len += (block_nb + 1) << 6;
+    ctx->tot_len += (uint64) (block_nb + 1) << 6;
 }
 
 void sha224_final(sha224_ctx *ctx, unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b;
 
 #ifndef UNROLL_LOOPS
     int i;
@@ -945,7 +1356,7 @@ void sha224_final(sha224_ctx *ctx, unsigned char *digest)
 
     memset(ctx->block + ctx->len, 0, pm_len - ctx->len);
     ctx->block[ctx->len] = 0x80;
-    UNPACK32(len_b, ctx->block + pm_len - 4);
+    UNPACK64(len_b, ctx->block + pm_len - 8);
 
     sha256_transf(ctx, ctx->block, block_nb);
 
@@ -963,3 +1374,535 @@ void sha224_final(sha224_ctx *ctx, unsigned char *digest)
    UNPACK32(ctx->h[6], &digest[24]);
 #endif /* !UNROLL_LOOPS */
 }
+
+/* Multi-buffer functions */
+
+/*
+ * The messages handed to sha*_mb() are hashed SHA2_MB_MAXLANES at a time
+ * at most, one message per SIMD lane. The state is kept transposed,
+ * st[i][l] being word i of lane l, so one vector holds the same word of
+ * every lane. Each lane reads its own block pointer; a lane whose message
+ * is already finished reads a dummy block and is masked out of the final
+ * addition, so its state does not change.
+ */
+
+static int sha2_mb_engine = SHA2_MB_ENGINE_SCALAR;
+static int sha2_mb_auto = 0;
+
+#ifdef SHA2_X86
+
+#define MB_ROTR32(P, B, x, n) \
+    P##_or_si##B(P##_srli_epi32(x, n), P##_slli_epi32(x, 32 - (n)))
+#define MB_ROTR64(P, B, x, n) \
+    P##_or_si##B(P##_srli_epi64(x, n), P##_slli_epi64(x, 64 - (n)))
+#define MB_XOR3(P, B, x, y, z) \
+    P##_xor_si##B(P##_xor_si##B(x, y), z)
+#define MB_CH(P, B, x, y, z) \
+    P##_xor_si##B(P##_and_si##B(x, y), P##_andnot_si##B(x, z))
+#define MB_MAJ(P, B, x, y, z) \
+    P##_xor_si##B(P##_and_si##B(x, y), P##_and_si##B(P##_xor_si##B(x, y), z))
+
+#define MB256_F1(P, B, x) MB_XOR3(P, B, MB_ROTR32(P, B, x,  2), \
+                                  MB_ROTR32(P, B, x, 13), MB_ROTR32(P, B, x, 22))
+#define MB256_F2(P, B, x) MB_XOR3(P, B, MB_ROTR32(P, B, x,  6), \
+                                  MB_ROTR32(P, B, x, 11), MB_ROTR32(P, B, x, 25))
+#define MB256_F3(P, B, x) MB_XOR3(P, B, MB_ROTR32(P, B, x,  7), \
+                                  MB_ROTR32(P, B, x, 18), P##_srli_epi32(x,  3))
+#define MB256_F4(P, B, x) MB_XOR3(P, B, MB_ROTR32(P, B, x, 17), \
+                                  MB_ROTR32(P, B, x, 19), P##_srli_epi32(x, 10))
+
+#define MB512_F1(P, B, x) MB_XOR3(P, B, MB_ROTR64(P, B, x, 28), \
+                                  MB_ROTR64(P, B, x, 34), MB_ROTR64(P, B, x, 39))
+#define MB512_F2(P, B, x) MB_XOR3(P, B, MB_ROTR64(P, B, x, 14), \
+                                  MB_ROTR64(P, B, x, 18), MB_ROTR64(P, B, x, 41))
+#define MB512_F3(P, B, x) MB_XOR3(P, B, MB_ROTR64(P, B, x,  1), \
+                                  MB_ROTR64(P, B, x,  8), P##_srli_epi64(x,  7))
+#define MB512_F4(P, B, x) MB_XOR3(P, B, MB_ROTR64(P, B, x, 19), \
+                                  MB_ROTR64(P, B, x, 61), P##_srli_epi64(x,  6))
+
+#define MB256_EXP(P, B, a, b, c, d, e, f, g, h, j)                           \
+{                                                                           \
+    t1 = P##_add_epi32(P##_add_epi32(wv[h], MB256_F2(P, B, wv[e])),         \
+                       MB_CH(P, B, wv[e], wv[f], wv[g]));                   \
+    t1 = P##_add_epi32(t1, P##_add_epi32(P##_set1_epi32(sha256_k[j]),       \
+                                         w[j]));                            \
+    t2 = P##_add_epi32(MB256_F1(P, B, wv[a]),                               \
+                       MB_MAJ(P, B, wv[a], wv[b], wv[c]));                  \
+    wv[d] = P##_add_epi32(wv[d], t1);                                       \
+    wv[h] = P##_add_epi32(t1, t2);                                          \
+}
+
+#define MB512_EXP(P, B, a, b, c, d, e, f, g, h, j)                           \
+{                                                                           \
+    t1 = P##_add_epi64(P##_add_epi64(wv[h], MB512_F2(P, B, wv[e])),         \
+                       MB_CH(P, B, wv[e], wv[f], wv[g]));                   \
+    t1 = P##_add_epi64(t1, P##_add_epi64(                                   \
+                               P##_set1_epi64x((long long) sha512_k[j]),    \
+                               w[j]));                                      \
+    t2 = P##_add_epi64(MB512_F1(P, B, wv[a]),                               \
+                       MB_MAJ(P, B, wv[a], wv[b], wv[c]));                  \
+    wv[d] = P##_add_epi64(wv[d], t1);                                       \
+    wv[h] = P##_add_epi64(t1, t2);                                          \
+}
+
+/*
+ * One compression per lane. isa is the target() string, vec the register
+ * type, P and B the intrinsic prefix and register width, so that
+ * P##_add_epi32 is _mm_add_epi32 or _mm256_add_epi32.
+ */
+#define SHA256_MB_TRANSF(name, isa, vec, P, B, lanes)                        \
+__attribute__((target(isa)))                                                \
+static void name(uint32 st[8][SHA2_MB_MAXLANES],                            \
+                 const unsigned char *const blk[], unsigned int mask)       \
+{                                                                           \
+    vec w[64], wv[8], t1, t2;                                               \
+    uint32 x[lanes];                                                        \
+    int i, j;                                                               \
+                                                                            \
+    for (j = 0; j < 16; j++) {                                              \
+        for (i = 0; i < lanes; i++) {                                       \
+            PACK32(&blk[i][j << 2], &x[i]);                                 \
+        }                                                                   \
+        w[j] = P##_loadu_si##B((const vec *) x);                            \
+    }                                                                       \
+    for (j = 16; j < 64; j++) {                                             \
+        w[j] = P##_add_epi32(P##_add_epi32(MB256_F4(P, B, w[j -  2]),       \
+                                           w[j -  7]),                      \
+                             P##_add_epi32(MB256_F3(P, B, w[j - 15]),       \
+                                           w[j - 16]));                     \
+    }                                                                       \
+    for (i = 0; i < 8; i++) {                                               \
+        wv[i] = P##_loadu_si##B((const vec *) st[i]);                       \
+    }                                                                       \
+                                                                            \
+    j = 0;                                                                  \
+    do {                                                                    \
+        MB256_EXP(P, B, 0,1,2,3,4,5,6,7,j); j++;                            \
+        MB256_EXP(P, B, 7,0,1,2,3,4,5,6,j); j++;                            \
+        MB256_EXP(P, B, 6,7,0,1,2,3,4,5,j); j++;                            \
+        MB256_EXP(P, B, 5,6,7,0,1,2,3,4,j); j++;                            \
+        MB256_EXP(P, B, 4,5,6,7,0,1,2,3,j); j++;                            \
+        MB256_EXP(P, B, 3,4,5,6,7,0,1,2,j); j++;                            \
+        MB256_EXP(P, B, 2,3,4,5,6,7,0,1,j); j++;                            \
+        MB256_EXP(P, B, 1,2,3,4,5,6,7,0,j); j++;                            \
+    } while (j < 64);                                                       \
+                                                                            \
+    for (i = 0; i < lanes; i++) {                                           \
+        x[i] = ((mask >> i) & 1) ? 0xffffffff : 0;                          \
+    }                                                                       \
+    t1 = P##_loadu_si##B((const vec *) x);                                  \
+    for (i = 0; i < 8; i++) {                                               \
+        t2 = P##_add_epi32(P##_loadu_si##B((const vec *) st[i]),            \
+                           P##_and_si##B(wv[i], t1));                       \
+        P##_storeu_si##B((vec *) st[i], t2);                                \
+    }                                                                       \
+}
+
+#define SHA512_MB_TRANSF(name, isa, vec, P, B, lanes)                        \
+__attribute__((target(isa)))                                                \
+static void name(uint64 st[8][SHA2_MB_MAXLANES],                            \
+                 const unsigned char *const blk[], unsigned int mask)       \
+{                                                                           \
+    vec w[80], wv[8], t1, t2;                                               \
+    uint64 x[lanes];                                                        \
+    int i, j;                                                               \
+                                                                            \
+    for (j = 0; j < 16; j++) {                                              \
+        for (i = 0; i < lanes; i++) {                                       \
+            PACK64(&blk[i][j << 3], &x[i]);                                 \
+        }                                                                   \
+        w[j] = P##_loadu_si##B((const vec *) x);                            \
+    }                                                                       \
+    for (j = 16; j < 80; j++) {                                             \
+        w[j] = P##_add_epi64(P##_add_epi64(MB512_F4(P, B, w[j -  2]),       \
+                                           w[j -  7]),                      \
+                             P##_add_epi64(MB512_F3(P, B, w[j - 15]),       \
+                                           w[j - 16]));                     \
+    }                                                                       \
+    for (i = 0; i < 8; i++) {                                               \
+        wv[i] = P##_loadu_si##B((const vec *) st[i]);                       \
+    }                                                                       \
+                                                                            \
+    j = 0;                                                                  \
+    do {                                                                    \
+        MB512_EXP(P, B, 0,1,2,3,4,5,6,7,j); j++;                            \
+        MB512_EXP(P, B, 7,0,1,2,3,4,5,6,j); j++;                            \
+        MB512_EXP(P, B, 6,7,0,1,2,3,4,5,j); j++;                            \
+        MB512_EXP(P, B, 5,6,7,0,1,2,3,4,j); j++;                            \
+        MB512_EXP(P, B, 4,5,6,7,0,1,2,3,j); j++;                            \
+        MB512_EXP(P, B, 3,4,5,6,7,0,1,2,j); j++;                            \
+        MB512_EXP(P, B, 2,3,4,5,6,7,0,1,j); j++;                            \
+        MB512_EXP(P, B, 1,2,3,4,5,6,7,0,j); j++;                            \
+    } while (j < 80);                                                       \
+                                                                            \
+    for (i = 0; i < lanes; i++) {                                           \
+        x[i] = ((mask >> i) & 1) ? 0xffffffffffffffffULL : 0;              \
+    }                                                                       \
+    t1 = P##_loadu_si##B((const vec *) x);                                  \
+    for (i = 0; i < 8; i++) {                                               \
+        t2 = P##_add_epi64(P##_loadu_si##B((const vec *) st[i]),            \
+                           P##_and_si##B(wv[i], t1));                       \
+        P##_storeu_si##B((vec *) st[i], t2);                                \
+    }                                                                       \
+}
+
+SHA256_MB_TRANSF(sha256_mb_sse2, "sse2", __m128i, _mm,    128, 4)
+SHA256_MB_TRANSF(sha256_mb_avx2, "avx2", __m256i, _mm256, 256, 8)
+SHA512_MB_TRANSF(sha512_mb_sse2, "sse2", __m128i, _mm,    128, 2)
+SHA512_MB_TRANSF(sha512_mb_avx2, "avx2", __m256i, _mm256, 256, 4)
+
+static int cpu_has_sse2(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return 0;
+    return (edx & bit_SSE2) != 0;
+}
+#endif /* SHA2_X86 */
+
+/*
+ * SHA2_MB_ENGINE_AUTO takes the widest lanes the CPU has. When the SHA-NI
+ * engine is also available, one message at a time through sha256rnds2 is
+ * faster than the lanes, so SHA-224/256 then hash the messages in turn.
+ */
+int sha2_mb_set_engine(int engine)
+{
+    int automatic = 0;
+
+    if (engine == SHA2_MB_ENGINE_AUTO) {
+        automatic = 1;
+        engine = SHA2_MB_ENGINE_SCALAR;
+#ifdef SHA2_X86
+        if (cpu_has_avx2())
+            engine = SHA2_MB_ENGINE_AVX2;
+        else if (cpu_has_sse2())
+            engine = SHA2_MB_ENGINE_SSE2;
+#endif
+    }
+    switch (engine) {
+    case SHA2_MB_ENGINE_SCALAR:
+        break;
+#ifdef SHA2_X86
+    case SHA2_MB_ENGINE_SSE2:
+        if (!cpu_has_sse2())
+            return -1;
+        break;
+    case SHA2_MB_ENGINE_AVX2:
+        if (!cpu_has_avx2())
+            return -1;
+        break;
+#endif
+    default:
+        return -1;
+    }
+    sha2_mb_engine = engine;
+    sha2_mb_auto = automatic;
+    return 0;
+}
+
+int sha2_mb_get_engine(void)
+{
+    return sha2_mb_engine;
+}
+
+__attribute__((constructor))
+static void sha2_mb_engine_init(void)
+{
+    sha2_mb_set_engine(SHA2_MB_DEFAULT_ENGINE);
+}
+
+static const unsigned char mb_idle_block[SHA512_BLOCK_SIZE];
+
+typedef void (*sha_fn)(const unsigned char *, size_t, unsigned char *);
+typedef void (*sha256_mb_fn)(uint32 [8][SHA2_MB_MAXLANES],
+                             const unsigned char *const [], unsigned int);
+typedef void (*sha512_mb_fn)(uint64 [8][SHA2_MB_MAXLANES],
+                             const unsigned char *const [], unsigned int);
+
+static void sha256_mb_lanes(const uint32 *h0, unsigned int digest_size,
+                            sha256_mb_fn transf, int lanes,
+                            const unsigned char *const message[],
+                            const size_t len[],
+                            unsigned char *const digest[], int n)
+{
+    uint32 st[8][SHA2_MB_MAXLANES];
+    unsigned char tail[SHA2_MB_MAXLANES][2 * SHA256_BLOCK_SIZE];
+    unsigned char out[SHA256_DIGEST_SIZE];
+    const unsigned char *blk[SHA2_MB_MAXLANES];
+    size_t full[SHA2_MB_MAXLANES], block_nb[SHA2_MB_MAXLANES];
+    size_t max_nb, b;
+    unsigned int rem, tail_nb, mask;
+    uint64 len_b;
+    int i, l, m;
+
+    for (; n > 0; n -= m, message += m, len += m, digest += m) {
+        m = n < lanes ? n : lanes;
+        max_nb = 0;
+        for (l = 0; l < lanes; l++) {
+            for (i = 0; i < 8; i++) {
+                st[i][l] = h0[i];
+            }
+            block_nb[l] = full[l] = 0;
+            if (l >= m)
+                continue;
+
+            /* the last partial block and the padding go through tail[l] */
+            full[l] = len[l] / SHA256_BLOCK_SIZE;
+            rem = len[l] % SHA256_BLOCK_SIZE;
+            tail_nb = 1 + ((SHA256_BLOCK_SIZE - 9) < rem);
+            memset(tail[l], 0, tail_nb << 6);
+            memcpy(tail[l], message[l] + (full[l] << 6), rem);
+            tail[l][rem] = 0x80;
+            len_b = (uint64) len[l] << 3;
+            UNPACK64(len_b, tail[l] + (tail_nb << 6) - 8);
+            block_nb[l] = full[l] + tail_nb;
+            if (block_nb[l] > max_nb)
+                max_nb = block_nb[l];
+        }
+
+        for (b = 0; b < max_nb; b++) {
+            mask = 0;
+            for (l = 0; l < lanes; l++) {
+                if (b < full[l]) {
+                    blk[l] = message[l] + (b << 6);
+                } else if (b < block_nb[l]) {
+                    blk[l] = tail[l] + ((b - full[l]) << 6);
+                } else {
+                    blk[l] = mb_idle_block;
+                    continue;
+                }
+                mask |= 1u << l;
+            }
+            transf(st, blk, mask);
+        }
+
+        for (l = 0; l < m; l++) {
+            for (i = 0; i < 8; i++) {
+                UNPACK32(st[i][l], &out[i << 2]);
+            }
+            memcpy(digest[l], out, digest_size);
+        }
+    }
+}
+
+static void sha512_mb_lanes(const uint64 *h0, unsigned int digest_size,
+                            sha512_mb_fn transf, int lanes,
+                            const unsigned char *const message[],
+                            const size_t len[],
+                            unsigned char *const digest[], int n)
+{
+    uint64 st[8][SHA2_MB_MAXLANES];
+    unsigned char tail[SHA2_MB_MAXLANES][2 * SHA512_BLOCK_SIZE];
+    unsigned char out[SHA512_DIGEST_SIZE];
+    const unsigned char *blk[SHA2_MB_MAXLANES];
+    size_t full[SHA2_MB_MAXLANES], block_nb[SHA2_MB_MAXLANES];
+    size_t max_nb, b;
+    unsigned int rem, tail_nb, mask;
+    uint64 len_b;
+    int i, l, m;
+
+    for (; n > 0; n -= m, message += m, len += m, digest += m) {
+        m = n < lanes ? n : lanes;
+        max_nb = 0;
+        for (l = 0; l < lanes; l++) {
+            for (i = 0; i < 8; i++) {
+                st[i][l] = h0[i];
+            }
+            block_nb[l] = full[l] = 0;
+            if (l >= m)
+                continue;
+
+            full[l] = len[l] / SHA512_BLOCK_SIZE;
+            rem = len[l] % SHA512_BLOCK_SIZE;
+            tail_nb = 1 + ((SHA512_BLOCK_SIZE - 17) < rem);
+            memset(tail[l], 0, tail_nb << 7);
+            memcpy(tail[l], message[l] + (full[l] << 7), rem);
+            tail[l][rem] = 0x80;
+            len_b = (uint64) len[l] << 3;
+            UNPACK64(len_b, tail[l] + (tail_nb << 7) - 8);
+            block_nb[l] = full[l] + tail_nb;
+            if (block_nb[l] > max_nb)
+                max_nb = block_nb[l];
+        }
+
+        for (b = 0; b < max_nb; b++) {
+            mask = 0;
+            for (l = 0; l < lanes; l++) {
+                if (b < full[l]) {
+                    blk[l] = message[l] + (b << 7);
+                } else if (b < block_nb[l]) {
+                    blk[l] = tail[l] + ((b - full[l]) << 7);
+                } else {
+                    blk[l] = mb_idle_block;
+                    continue;
+                }
+                mask |= 1u << l;
+            }
+            transf(st, blk, mask);
+        }
+
+        for (l = 0; l < m; l++) {
+            for (i = 0; i < 8; i++) {
+                UNPACK64(st[i][l], &out[i << 3]);
+            }
+            memcpy(digest[l], out, digest_size);
+        }
+    }
+}
+
+static void sha256_mb_run(const uint32 *h0, unsigned int digest_size,
+                          sha_fn single,
+                          const unsigned char *const message[],
+                          const size_t len[],
+                          unsigned char *const digest[], int n)
+{
+    int i;
+
+    if (sha2_mb_auto && sha256_engine == SHA256_ENGINE_SHANI)
+        goto scalar;
+    switch (sha2_mb_engine) {
+#ifdef SHA2_X86
+    case SHA2_MB_ENGINE_AVX2:
+        sha256_mb_lanes(h0, digest_size, sha256_mb_avx2, 8,
+                        message, len, digest, n);
+        return;
+    case SHA2_MB_ENGINE_SSE2:
+        sha256_mb_lanes(h0, digest_size, sha256_mb_sse2, 4,
+                        message, len, digest, n);
+        return;
+#endif
+    default:
+        break;
+    }
+scalar:
+    for (i = 0; i < n; i++) {
+        single(message[i], len[i], digest[i]);
+    }
+}
+
+static void sha512_mb_run(const uint64 *h0, unsigned int digest_size,
+                          sha_fn single,
+                          const unsigned char *const message[],
+                          const size_t len[],
+                          unsigned char *const digest[], int n)
+{
+    int i;
+
+    switch (sha2_mb_engine) {
+#ifdef SHA2_X86
+    case SHA2_MB_ENGINE_AVX2:
+        sha512_mb_lanes(h0, digest_size, sha512_mb_avx2, 4,
+                        message, len, digest, n);
+        return;
+    case SHA2_MB_ENGINE_SSE2:
+        sha512_mb_lanes(h0, digest_size, sha512_mb_sse2, 2,
+                        message, len, digest, n);
+        return;
+#endif
+    default:
+        break;
+    }
+    for (i = 0; i < n; i++) {
+        single(message[i], len[i], digest[i]);
+    }
+}
+
+void sha224_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n)
+{
+    sha256_mb_run(sha224_h0, SHA224_DIGEST_SIZE, sha224,
+                  message, len, digest, n);
+}
+
+void sha256_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n)
+{
+    sha256_mb_run(sha256_h0, SHA256_DIGEST_SIZE, sha256,
+                  message, len, digest, n);
+}
+
+void sha384_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n)
+{
+    sha512_mb_run(sha384_h0, SHA384_DIGEST_SIZE, sha384,
+                  message, len, digest, n);
+}
+
+void sha512_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n)
+{
+    sha512_mb_run(sha512_h0, SHA512_DIGEST_SIZE, sha512,
+                  message, len, digest, n);
+}
+
+void sha512_224_mb(const unsigned char *const message[],
+                   const size_t len[],
+                   unsigned char *const digest[], int n)
+{
+    sha512_mb_run(sha512_224_h0, SHA224_DIGEST_SIZE, sha512_224,
+                  message, len, digest, n);
+}
+
+void sha512_256_mb(const unsigned char *const message[],
+                   const size_t len[],
+                   unsigned char *const digest[], int n)
+{
+    sha512_mb_run(sha512_256_h0, SHA256_DIGEST_SIZE, sha512_256,
+                  message, len, digest, n);
+}
+
+/* Hash descriptors */
+
+#define SHA2_DESC(name, member, init_f, update_f, final_f)                 \
+static void name##_desc_init(sha2_ctx *ctx)                                \
+{                                                                          \
+    init_f(&ctx->member);                                                  \
+}                                                                          \
+                                                                           \
+static void name##_desc_update(sha2_ctx *ctx, const unsigned char *message,\
+                               size_t len)                                 \
+{                                                                          \
+    update_f(&ctx->member, message, len);                                  \
+}                                                                          \
+                                                                           \
+static void name##_desc_final(sha2_ctx *ctx, unsigned char *digest)        \
+{                                                                          \
+    final_f(&ctx->member, digest);                                         \
+}
+
+SHA2_DESC(sha224, s256, sha224_init, sha224_update, sha224_final)
+SHA2_DESC(sha256, s256, sha256_init, sha256_update, sha256_final)
+SHA2_DESC(sha384, s512, sha384_init, sha384_update, sha384_final)
+SHA2_DESC(sha512, s512, sha512_init, sha512_update, sha512_final)
+SHA2_DESC(sha512_224, s512, sha512_224_init, sha512_update, sha512_224_final)
+SHA2_DESC(sha512_256, s512, sha512_256_init, sha512_update, sha512_256_final)
+
+static const sha2_desc sha2_desc_table[SHA2_NDESC] = {
+    {"SHA-224", SHA224_DIGEST_SIZE, SHA224_BLOCK_SIZE,
+     sha224_desc_init, sha224_desc_update, sha224_desc_final,
+     sha224, sha224_mb},
+    {"SHA-256", SHA256_DIGEST_SIZE, SHA256_BLOCK_SIZE,
+     sha256_desc_init, sha256_desc_update, sha256_desc_final,
+     sha256, sha256_mb},
+    {"SHA-384", SHA384_DIGEST_SIZE, SHA384_BLOCK_SIZE,
+     sha384_desc_init, sha384_desc_update, sha384_desc_final,
+     sha384, sha384_mb},
+    {"SHA-512", SHA512_DIGEST_SIZE, SHA512_BLOCK_SIZE,
+     sha512_desc_init, sha512_desc_update, sha512_desc_final,
+     sha512, sha512_mb},
+    {"SHA-512/224", SHA224_DIGEST_SIZE, SHA512_BLOCK_SIZE,
+     sha512_224_desc_init, sha512_224_desc_update, sha512_224_desc_final,
+     sha512_224, sha512_224_mb},
+    {"SHA-512/256", SHA256_DIGEST_SIZE, SHA512_BLOCK_SIZE,
+     sha512_256_desc_init, sha512_256_desc_update, sha512_256_desc_final,
+     sha512_256, sha512_256_mb},
+};
+
+const sha2_desc *sha2_get_desc(int ndx)
+{
+    if (ndx < 0 || ndx >= SHA2_NDESC)
+        return NULL;
+
+    return &sha2_desc_table[ndx];
+}
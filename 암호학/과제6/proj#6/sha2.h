@@ -31,11 +31,19 @@
  * SUCH DAMAGE.
  * ---
  * 2022 SHA-512/224, SHA-512/256 are added by Heekuck Oh
+ * 2023 SHA-NI compression for SHA-224/256 with run-time dispatch
+ *      is added by 2018037356 안동현
+ * 2023 multi-buffer SHA-2 (SSE2/AVX2 lanes) is added by 2018037356 안동현
+ * 2023 64/128-bit length counters and size_t lengths by 2018037356 안동현
+ * 2023 hash descriptor table is added by 2018037356 안동현
+ * 2023 AVX2 message schedule for SHA-384/512 is added by 2018037356 안동현
  */
 
 #ifndef SHA2_H
 #define SHA2_H
 
+#include <stddef.h>
+
 #define SHA224_DIGEST_SIZE ( 224 / 8)
 #define SHA256_DIGEST_SIZE ( 256 / 8)
 #define SHA384_DIGEST_SIZE ( 384 / 8)
@@ -57,15 +65,22 @@ typedef unsigned long long uint64;
 extern "C" {
 #endif
 
+/*
+ * tot_len counts the bytes already compressed. SHA-224/256 encode the
+ * message length in 64 bits and SHA-384/512 in 128 bits, so the SHA-512
+ * contexts keep the upper half of the byte count in tot_len_hi.
+ * len is the number of bytes waiting in block.
+ */
 typedef struct {
-    unsigned int tot_len;
+    uint64 tot_len;
     unsigned int len;
     unsigned char block[2 * SHA256_BLOCK_SIZE];
     uint32 h[8];
 } sha256_ctx;
 
 typedef struct {
-    unsigned int tot_len;
+    uint64 tot_len;
+    uint64 tot_len_hi;
     unsigned int len;
     unsigned char block[2 * SHA512_BLOCK_SIZE];
     uint64 h[8];
@@ -74,42 +89,152 @@ typedef struct {
 typedef sha512_ctx sha384_ctx;
 typedef sha256_ctx sha224_ctx;
 
+/*
+ * SHA-224/256 compression engines. SHA256_ENGINE_C is the portable code,
+ * SHA256_ENGINE_SHANI uses the x86 SHA extensions (sha256rnds2,
+ * sha256msg1, sha256msg2). SHA256_ENGINE_AUTO picks SHA-NI when the CPU
+ * has it. The default can be changed at build time with
+ * -DSHA256_DEFAULT_ENGINE=SHA256_ENGINE_C and at run time with
+ * sha256_set_engine(), which returns -1 if the engine is not available.
+ */
+#define SHA256_ENGINE_AUTO  -1
+#define SHA256_ENGINE_C      0
+#define SHA256_ENGINE_SHANI  1
+
+#ifndef SHA256_DEFAULT_ENGINE
+#define SHA256_DEFAULT_ENGINE SHA256_ENGINE_AUTO
+#endif
+
+int sha256_set_engine(int engine);
+int sha256_get_engine(void);
+
+/*
+ * SHA-384/512 and SHA-512/t compression engines. SHA512_ENGINE_C is the
+ * portable code, SHA512_ENGINE_AVX2 computes the message schedule four
+ * words at a time in AVX2 registers and keeps the rounds scalar.
+ * SHA512_ENGINE_AUTO picks AVX2 when the CPU and OS support it. The build
+ * and run time controls work like the SHA-256 ones.
+ */
+#define SHA512_ENGINE_AUTO  -1
+#define SHA512_ENGINE_C      0
+#define SHA512_ENGINE_AVX2   1
+
+#ifndef SHA512_DEFAULT_ENGINE
+#define SHA512_DEFAULT_ENGINE SHA512_ENGINE_AUTO
+#endif
+
+int sha512_set_engine(int engine);
+int sha512_get_engine(void);
+
 void sha224_init(sha224_ctx *ctx);
 void sha224_update(sha224_ctx *ctx, const unsigned char *message,
-                   unsigned int len);
+                   size_t len);
 void sha224_final(sha224_ctx *ctx, unsigned char *digest);
-void sha224(const unsigned char *message, unsigned int len,
+void sha224(const unsigned char *message, size_t len,
             unsigned char *digest);
 
 void sha256_init(sha256_ctx * ctx);
 void sha256_update(sha256_ctx *ctx, const unsigned char *message,
-                   unsigned int len);
+                   size_t len);
 void sha256_final(sha256_ctx *ctx, unsigned char *digest);
-void sha256(const unsigned char *message, unsigned int len,
+void sha256(const unsigned char *message, size_t len,
             unsigned char *digest);
 
 void sha384_init(sha384_ctx *ctx);
 void sha384_update(sha384_ctx *ctx, const unsigned char *message,
-                   unsigned int len);
+                   size_t len);
 void sha384_final(sha384_ctx *ctx, unsigned char *digest);
-void sha384(const unsigned char *message, unsigned int len,
+void sha384(const unsigned char *message, size_t len,
             unsigned char *digest);
 
 void sha512_init(sha512_ctx *ctx);
 void sha512_224_init(sha512_ctx *ctx);
 void sha512_256_init(sha512_ctx *ctx);
 void sha512_update(sha512_ctx *ctx, const unsigned char *message,
-                   unsigned int len);
+                   size_t len);
 void sha512_final(sha512_ctx *ctx, unsigned char *digest);
 void sha512_224_final(sha512_ctx *ctx, unsigned char *digest);
 void sha512_256_final(sha512_ctx *ctx, unsigned char *digest);
-void sha512(const unsigned char *message, unsigned int len,
+void sha512(const unsigned char *message, size_t len,
             unsigned char *digest);
-void sha512_224(const unsigned char *message, unsigned int len,
+void sha512_224(const unsigned char *message, size_t len,
             unsigned char *digest);
-void sha512_256(const unsigned char *message, unsigned int len,
+void sha512_256(const unsigned char *message, size_t len,
             unsigned char *digest);
 
+/*
+ * Multi-buffer hashing. sha*_mb() hashes n independent messages, message[i]
+ * of len[i] bytes into digest[i], putting one message in each SIMD lane:
+ * 8 lanes with AVX2 and 4 with SSE2 for SHA-224/256, 4 and 2 for the
+ * SHA-512 family. Messages may have different lengths; a lane that
+ * finishes early idles until the longest message in its group is done,
+ * so the gain is largest for many short messages of similar length.
+ * SHA2_MB_ENGINE_SCALAR hashes the messages one after the other.
+ * SHA2_MB_ENGINE_AUTO picks the widest lanes the CPU has, but hashes
+ * SHA-224/256 one message at a time when the SHA-NI engine is in use.
+ */
+#define SHA2_MB_MAXLANES 8
+
+#define SHA2_MB_ENGINE_AUTO   -1
+#define SHA2_MB_ENGINE_SCALAR  0
+#define SHA2_MB_ENGINE_SSE2    1
+#define SHA2_MB_ENGINE_AVX2    2
+
+#ifndef SHA2_MB_DEFAULT_ENGINE
+#define SHA2_MB_DEFAULT_ENGINE SHA2_MB_ENGINE_AUTO
+#endif
+
+int sha2_mb_set_engine(int engine);
+int sha2_mb_get_engine(void);
+
+void sha224_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n);
+void sha256_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n);
+void sha384_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n);
+void sha512_mb(const unsigned char *const message[], const size_t len[],
+               unsigned char *const digest[], int n);
+void sha512_224_mb(const unsigned char *const message[],
+                   const size_t len[],
+                   unsigned char *const digest[], int n);
+void sha512_256_mb(const unsigned char *const message[],
+                   const size_t len[],
+                   unsigned char *const digest[], int n);
+
+/*
+ * Hash descriptors. sha2_get_desc(ndx) returns the descriptor of one
+ * SHA-2 variant, or NULL if ndx is out of range. The index order is
+ * 0 SHA-224, 1 SHA-256, 2 SHA-384, 3 SHA-512, 4 SHA-512/224,
+ * 5 SHA-512/256, the same as the sha2_ndx values of pkcs.h and ecdsa.h.
+ * A sha2_ctx holds the state of any variant, so a caller can look the
+ * descriptor up once and then hash a message in pieces with
+ * init/update/final, or in one call with digest and digest_mb.
+ */
+#define SHA2_NDESC 6
+
+typedef union {
+    sha256_ctx s256;
+    sha512_ctx s512;
+} sha2_ctx;
+
+typedef struct {
+    const char *name;
+    int digest_size;
+    int block_size;
+    void (*init)(sha2_ctx *ctx);
+    void (*update)(sha2_ctx *ctx, const unsigned char *message,
+                   size_t len);
+    void (*final)(sha2_ctx *ctx, unsigned char *digest);
+    void (*digest)(const unsigned char *message, size_t len,
+                   unsigned char *digest);
+    void (*digest_mb)(const unsigned char *const message[],
+                      const size_t len[],
+                      unsigned char *const digest[], int n);
+} sha2_desc;
+
+const sha2_desc *sha2_get_desc(int ndx);
+
 #ifdef __cplusplus
 }
 #endif
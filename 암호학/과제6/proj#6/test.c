@@ -32,6 +32,9 @@ int main(void)
     ecdsa_p256_t Q;
     unsigned char r[ECDSA_P256/8], s[ECDSA_P256/8];
     unsigned char r1[ECDSA_P256/8], s1[ECDSA_P256/8];
+    unsigned char e[SHA512_DIGEST_SIZE];
+    ecdsa_p256_hash_t h;
+    size_t len, off;
     clock_t start, end;
     double cpu_time;
 
@@ -148,6 +151,46 @@ int main(void)
         printf("Valid signature ...PASSED\n");
     printf("---\n");
     
+    /*
+     * 메시지를 나눠 넣어서 서명하고 검증한다. 표준 서명 값을 나눠 넣은 메시지로 검증하고,
+     * 미리 구한 해시값으로 서명한 것을 메시지로 검증한다.
+     */
+    len = strlen(poem);
+    ecdsa_p256_hash_init(&h, SHA224);
+    for (off = 0; off < len; off += 5)
+        ecdsa_p256_hash_update(&h, poem + off, len - off < 5 ? len - off : 5);
+    if ((val = ecdsa_p256_verify_final(&h, &poet_Q, poem_r1, poem_s1)) != 0) {
+        printf("Signature verification error = %d ...FAILED\n", val);
+        return 1;
+    }
+    ecdsa_p256_hash_init(&h, SHA512);
+    ecdsa_p256_hash_update(&h, poem, 64);
+    ecdsa_p256_hash_update(&h, poem + 64, len - 64);
+    if ((val = ecdsa_p256_sign_final(&h, d, r, s)) != 0) {
+        printf(" ...FAILED: signature generation error = %d\n", val);
+        return 1;
+    }
+    if ((val = ecdsa_p256_verify(poem, len, &Q, r, s, SHA512)) != 0) {
+        printf("Signature verification error = %d ...FAILED\n", val);
+        return 1;
+    }
+    sha256((const unsigned char *)poem, len, e);
+    if ((val = ecdsa_p256_sign_digest(e, d, r, s, SHA256)) != 0) {
+        printf(" ...FAILED: signature generation error = %d\n", val);
+        return 1;
+    }
+    if ((val = ecdsa_p256_verify(poem, len, &Q, r, s, SHA256)) != 0 ||
+        (val = ecdsa_p256_verify_digest(e, &Q, r, s, SHA256)) != 0) {
+        printf("Signature verification error = %d ...FAILED\n", val);
+        return 1;
+    }
+    if (ecdsa_p256_hash_init(&h, 6) != ECDSA_INVALID_HASH) {
+        printf("Invalid hash index ...FAILED\n");
+        return 1;
+    }
+    printf("Streaming and prehashed signature ...PASSED\n");
+    printf("---\n");
+
     /*
      * 키 생성, 서명, 검증을 해시함수를 변경해 가면서 반복적으로 수행한다.
      */